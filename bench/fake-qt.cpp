@@ -0,0 +1,288 @@
+// system includes
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <stdexcept>
+#include <sys/stat.h>
+
+// local includes
+#include "fake-qt.h"
+#include "stub-elf.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::plugin::qt::bench;
+
+namespace {
+    struct FakeLibrary {
+        // name between libQt5 and .so.5
+        const char* name;
+        std::vector<const char*> dependencies;
+    };
+
+    // a subset of Qt's modules, with simplified dependencies
+    // the dependencies must be listed before the modules depending on them
+    const std::vector<FakeLibrary> fakeLibraries = {
+        {"Core", {}},
+        {"DBus", {"Core"}},
+        {"Network", {"Core"}},
+        {"Gui", {"Core"}},
+        {"Widgets", {"Gui", "Core"}},
+        {"XcbQpa", {"Gui", "DBus", "Core"}},
+        {"OpenGL", {"Widgets", "Gui", "Core"}},
+        {"Svg", {"Widgets", "Gui", "Core"}},
+        {"Sql", {"Core"}},
+        {"Qml", {"Network", "Core"}},
+        {"Quick", {"Qml", "Network", "Gui", "Core"}},
+        {"Multimedia", {"Network", "Gui", "Core"}},
+        {"Positioning", {"Core"}},
+        {"Gamepad", {"Gui", "Core"}},
+        {"3DCore", {"Gui", "Network", "Core"}},
+        {"3DRender", {"3DCore", "Gui", "Core"}},
+        {"3DQuick", {"3DCore", "Quick", "Qml", "Gui", "Core"}},
+        {"3DQuickRender", {"3DQuick", "3DRender", "3DCore", "Quick", "Qml", "Gui", "Core"}},
+    };
+
+    // the modules the generated application links to, one for every deployer except the WebEngine one
+    const std::vector<const char*> applicationLibraries = {
+        "Core", "Gui", "Widgets", "Network", "Svg", "Sql", "Qml", "Quick", "Multimedia", "Positioning", "Gamepad",
+        "3DQuickRender",
+    };
+
+    struct PluginCategory {
+        const char* directory;
+        std::vector<const char*> dependencies;
+
+        // plugins which are deployed by name
+        std::vector<const char*> fixedPlugins;
+    };
+
+    const std::vector<PluginCategory> pluginCategories = {
+        {"platforms", {"XcbQpa", "Gui", "Core"}, {"libqxcb.so"}},
+        {"platforminputcontexts", {"Gui", "DBus", "Core"}, {}},
+        {"imageformats", {"Gui", "Core"}, {}},
+        {"iconengines", {"Svg", "Gui", "Core"}, {"libqsvgicon.so"}},
+        {"xcbglintegrations", {"XcbQpa", "Gui", "Core"}, {}},
+        {"platformthemes", {"Widgets", "DBus", "Gui", "Core"}, {}},
+        {"styles", {"Widgets", "Gui", "Core"}, {}},
+        {"sqldrivers", {"Sql", "Core"}, {}},
+        {"bearer", {"Network", "DBus", "Core"}, {}},
+        {"mediaservice", {"Multimedia", "Network", "Gui", "Core"}, {}},
+        {"audio", {"Multimedia", "Core"}, {}},
+        {"position", {"Positioning", "Core"}, {}},
+        {"gamepads", {"Gamepad", "Gui", "Core"}, {}},
+        {"geometryloaders", {"3DRender", "3DCore", "Core"}, {}},
+        {"sceneparsers", {"3DRender", "3DCore", "Core"}, {}},
+    };
+
+    // prefixes of the translation files, some of them belong to modules which are deployed, some don't
+    const std::vector<const char*> translationPrefixes = {
+        "qt", "qtbase", "qtdeclarative", "qtmultimedia", "qtserialport", "qtwebsockets", "qtxmlpatterns", "qtscript",
+        "qt_help", "qtlocation", "qtconnectivity", "designer", "linguist", "assistant",
+    };
+
+    std::string sonameOf(const std::string& name) {
+        return "libQt5" + name + ".so.5";
+    }
+
+    std::vector<std::string> sonamesOf(const std::vector<const char*>& names) {
+        std::vector<std::string> rv;
+
+        for (const auto* name : names)
+            rv.push_back(sonameOf(name));
+
+        return rv;
+    }
+
+    void writeFile(const bf::path& path, const std::string& contents, mode_t mode = 0644) {
+        std::ofstream ofs(path.string(), std::ios::binary | std::ios::trunc);
+        ofs << contents;
+        ofs.close();
+
+        if (!ofs || chmod(path.c_str(), mode) != 0)
+            throw std::runtime_error("Failed to write " + path.string());
+    }
+
+    // "aa" ... "zz" for the first 676 indices, then "aa_AA" style locale names
+    std::string languageCode(unsigned int index) {
+        auto letters = [](unsigned int i, char base) {
+            return std::string{static_cast<char>(base + (i / 26) % 26), static_cast<char>(base + i % 26)};
+        };
+
+        auto rv = letters(index % 676, 'a');
+
+        if (index >= 676)
+            rv += "_" + letters(index / 676, 'A');
+
+        return rv;
+    }
+
+    void generateTools(const bf::path& root, const bf::path& standInsDir) {
+        // the stand-ins derive the installation's paths from their own location
+        for (const auto* tool : {"qmake", "qmlimportscanner"})
+            bf::copy_file(standInsDir / tool, root / "bin" / tool);
+
+        // lets the plugin read the paths without running qmake, like a relocated Qt installation
+        writeFile(root / "bin/qt.conf", "[Paths]\nPrefix=..\n");
+    }
+
+    void generateLibraries(const bf::path& root, const FakeQtSize& size) {
+        bf::create_directories(root / "lib");
+
+        for (const auto& library : fakeLibraries) {
+            const auto soname = sonameOf(library.name);
+            writeStubElf(root / "lib" / soname, soname, sonamesOf(library.dependencies), size.libraryPadding);
+        }
+    }
+
+    void generatePlugins(const bf::path& root, const FakeQtSize& size) {
+        for (const auto& category : pluginCategories) {
+            const auto directory = root / "plugins" / category.directory;
+            bf::create_directories(directory);
+
+            std::vector<std::string> fileNames(category.fixedPlugins.begin(), category.fixedPlugins.end());
+
+            for (unsigned int i = 0; i < size.pluginsPerCategory; ++i)
+                fileNames.push_back(std::string("libqbench") + category.directory + std::to_string(i) + ".so");
+
+            for (const auto& fileName : fileNames)
+                writeStubElf(directory / fileName, "", sonamesOf(category.dependencies), size.libraryPadding);
+        }
+    }
+
+    // calls the callback with the name and path relative to qml/ of every generated QML module
+    void forEachQmlModule(const FakeQtSize& size,
+                          const std::function<void(const std::string&, const bf::path&, unsigned int)>& callback) {
+        for (unsigned int module = 0; module < size.qmlModules; ++module) {
+            std::string moduleName = "Bench.Module" + std::to_string(module);
+            bf::path relativePath = bf::path("Bench") / ("Module" + std::to_string(module));
+
+            for (unsigned int level = 0; level <= size.qmlDepth; ++level) {
+                if (level > 0) {
+                    moduleName += ".Level" + std::to_string(level);
+                    relativePath /= "Level" + std::to_string(level);
+                }
+
+                callback(moduleName, relativePath, level);
+            }
+        }
+    }
+
+    void generateQml(const bf::path& root, const FakeQtSize& size) {
+        // imported by all generated QML files
+        bf::create_directories(root / "qml/QtQuick.2");
+        writeStubElf(root / "qml/QtQuick.2/libqtquick2plugin.so", "", sonamesOf({"Quick", "Qml", "Gui", "Core"}),
+                     size.libraryPadding);
+        writeFile(root / "qml/QtQuick.2/qmldir", "module QtQuick\nplugin qtquick2plugin\n");
+
+        forEachQmlModule(size, [&root, &size](const std::string& moduleName, const bf::path& relativePath,
+                                              unsigned int level) {
+            const auto directory = root / "qml" / relativePath;
+            bf::create_directories(directory);
+
+            std::string qmldir = "module " + moduleName + "\n";
+
+            // only the top level modules come with a native plugin, like most real ones do
+            if (level == 0) {
+                const auto pluginName = "bench" + relativePath.filename().string() + "plugin";
+                writeStubElf(directory / ("lib" + pluginName + ".so"), "",
+                             sonamesOf({"Quick", "Qml", "Gui", "Core"}), size.libraryPadding);
+                qmldir += "plugin " + pluginName + "\n";
+            }
+
+            for (unsigned int file = 0; file < size.qmlFilesPerModule; ++file) {
+                const auto typeName = "Item" + std::to_string(file);
+
+                writeFile(directory / (typeName + ".qml"),
+                          "import QtQuick 2.0\n\nItem {\n    id: root\n    property string name: \"" + typeName +
+                          "\"\n    width: 100\n    height: 100\n}\n");
+                qmldir += typeName + " 1.0 " + typeName + ".qml\n";
+            }
+
+            writeFile(directory / "qmldir", qmldir);
+        });
+    }
+
+    void generateTranslations(const bf::path& root, const FakeQtSize& size) {
+        const auto directory = root / "translations";
+        bf::create_directories(directory);
+
+        // .qm magic number, followed by some filler
+        std::string contents("\x3c\xb8\x64\x18\xca\xef\x9c\x95\xcd\x21\x1c\xbf\x60\xa1\xbd\xdd", 16);
+        contents.resize(2048, 'q');
+
+        for (unsigned int i = 0; i < size.translations; ++i) {
+            const auto* prefix = translationPrefixes[i % translationPrefixes.size()];
+            const auto language = languageCode(static_cast<unsigned int>(i / translationPrefixes.size()));
+
+            writeFile(directory / (std::string(prefix) + "_" + language + ".qm"), contents);
+        }
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace bench {
+                const std::vector<FakeQtSize>& defaultFakeQtSizes() {
+                    static const std::vector<FakeQtSize> sizes = {
+                        {"small", 2, 4, 1, 4, 200, 16 * 1024},
+                        {"medium", 8, 16, 2, 8, 2000, 64 * 1024},
+                        {"large", 32, 48, 4, 16, 8000, 128 * 1024},
+                    };
+
+                    return sizes;
+                }
+
+                void generateFakeQt(const bf::path& root, const FakeQtSize& size, const bf::path& standInsDir) {
+                    if (bf::exists(root))
+                        throw std::runtime_error("Directory exists already: " + root.string());
+
+                    for (const auto& directory : {"bin", "libexec", "include", "doc"})
+                        bf::create_directories(root / directory);
+
+                    generateTools(root, standInsDir);
+                    generateLibraries(root, size);
+                    generatePlugins(root, size);
+                    generateQml(root, size);
+                    generateTranslations(root, size);
+                }
+
+                void generateAppDir(const bf::path& root, const bf::path& qtRoot, const FakeQtSize& size) {
+                    if (bf::exists(root))
+                        throw std::runtime_error("Directory exists already: " + root.string());
+
+                    bf::create_directories(root / "usr/bin");
+                    bf::create_directories(root / "usr/lib");
+
+                    writeStubElf(root / "usr/bin/bench-app", "", sonamesOf(applicationLibraries), size.libraryPadding);
+                    chmod((root / "usr/bin/bench-app").c_str(), 0755);
+
+                    // the QML file qmlimportscanner finds the imports of all QML modules in
+                    std::string mainQml = "import QtQuick 2.0\n";
+
+                    forEachQmlModule(size, [&mainQml](const std::string& moduleName, const bf::path&, unsigned int) {
+                        mainQml += "import " + moduleName + " 1.0\n";
+                    });
+
+                    bf::create_directories(root / "usr/share/bench-app");
+                    writeFile(root / "usr/share/bench-app/main.qml", mainQml + "\nItem {\n}\n");
+
+                    // linuxdeploy deploys the closure of the application's dependencies before calling the plugin
+                    std::set<std::string> closure(applicationLibraries.begin(), applicationLibraries.end());
+
+                    for (auto library = fakeLibraries.rbegin(); library != fakeLibraries.rend(); ++library) {
+                        if (closure.count(library->name) > 0)
+                            closure.insert(library->dependencies.begin(), library->dependencies.end());
+                    }
+
+                    for (const auto& name : closure) {
+                        const auto soname = sonameOf(name);
+                        bf::copy_file(qtRoot / "lib" / soname, root / "usr/lib" / soname);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// system includes
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace bench {
+                /**
+                 * Dimensions of a generated Qt installation.
+                 */
+                struct FakeQtSize {
+                    std::string name;
+
+                    // plugins per directory below plugins/, in addition to the ones the deployers ask for by name
+                    unsigned int pluginsPerCategory;
+
+                    // QML modules below qml/Bench/, each with nested submodules qmlDepth levels deep
+                    unsigned int qmlModules;
+                    unsigned int qmlDepth;
+                    unsigned int qmlFilesPerModule;
+
+                    // number of .qm files in translations/, spread over the prefixes of several Qt modules
+                    unsigned int translations;
+
+                    // bytes added to every library and plugin
+                    size_t libraryPadding;
+                };
+
+                /**
+                 * Sizes the benchmark runs by default, from a small application to one bundling a lot of Qt.
+                 */
+                const std::vector<FakeQtSize>& defaultFakeQtSizes();
+
+                /**
+                 * Generates a Qt installation in the default layout, using stub ELF files (see writeStubElf()).
+                 *
+                 * The installation contains:
+                 *  - bin/qmake and bin/qmlimportscanner, copies of the stand-ins in tests/data/fake_qt/bin, and a
+                 *    bin/qt.conf
+                 *  - lib/libQt5*.so.5 with DT_NEEDED entries mirroring the real module dependencies
+                 *  - plugins/<category>/ for every category the deployers look into, with plugins depending on the
+                 *    libraries
+                 *  - qml/Bench/ with qmldir files, .qml files and a plugin per module
+                 *  - translations/ with .qm files
+                 *
+                 * @param root directory to create the installation in, must not exist yet
+                 * @param standInsDir directory containing the qmake and qmlimportscanner stand-ins
+                 */
+                void generateFakeQt(const boost::filesystem::path& root, const FakeQtSize& size,
+                                    const boost::filesystem::path& standInsDir);
+
+                /**
+                 * Generates an AppDir the way linuxdeploy leaves it before calling the plugin: an executable in
+                 * usr/bin linking the Qt modules which have deployers, and the Qt libraries it depends on in usr/lib. A
+                 * QML file in usr/share imports all QML modules of the installation.
+                 *
+                 * @param root directory to create the AppDir in, must not exist yet
+                 * @param qtRoot installation generated by generateFakeQt()
+                 */
+                void generateAppDir(const boost::filesystem::path& root, const boost::filesystem::path& qtRoot,
+                                    const FakeQtSize& size);
+            }
+        }
+    }
+}
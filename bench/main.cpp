@@ -0,0 +1,232 @@
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// library includes
+#include <args.hxx>
+#include <boost/filesystem.hpp>
+
+// local includes
+#include "fake-qt.h"
+#include "process.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::plugin::qt::bench;
+
+namespace {
+    struct DirectoryTotals {
+        size_t files = 0;
+        uintmax_t bytes = 0;
+    };
+
+    // symlinks count as files, but don't add to the size
+    DirectoryTotals directoryTotals(const bf::path& path) {
+        DirectoryTotals totals;
+
+        for (bf::recursive_directory_iterator i(path); i != bf::recursive_directory_iterator(); ++i) {
+            const auto status = i->symlink_status();
+
+            if (status.type() == bf::regular_file) {
+                ++totals.files;
+                totals.bytes += bf::file_size(i->path());
+            } else if (status.type() == bf::symlink_file) {
+                ++totals.files;
+            }
+        }
+
+        return totals;
+    }
+
+    struct RunResult {
+        double wallSeconds = 0;
+        ProcessResources resources;
+        DirectoryTotals deployed;
+    };
+
+    // runs the plugin on a freshly generated AppDir, returns false if the plugin failed
+    bool runPlugin(const bf::path& pluginPath, const std::vector<std::string>& pluginArgs, const bf::path& qtRoot,
+                   const bf::path& appDirPath, const FakeQtSize& size, RunResult& result) {
+        generateAppDir(appDirPath, qtRoot, size);
+
+        const auto before = directoryTotals(appDirPath);
+
+        std::vector<std::string> command{pluginPath.string(), "--appdir", appDirPath.string()};
+        command.insert(command.end(), pluginArgs.begin(), pluginArgs.end());
+
+        // the log is only of interest if something goes wrong
+        std::string output;
+        auto collectOutput = [&output](const char* data, size_t size) {
+            output.append(data, size);
+        };
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto returnCode = runProcess(command, collectOutput, collectOutput, &result.resources);
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (returnCode != 0) {
+            std::cerr << output << std::endl
+                      << "Plugin exited with code " << returnCode << " on the " << size.name << " AppDir" << std::endl;
+            return false;
+        }
+
+        const auto after = directoryTotals(appDirPath);
+        result.deployed.files = after.files - before.files;
+        result.deployed.bytes = after.bytes - before.bytes;
+
+        return true;
+    }
+
+    void printHeader() {
+        std::cout << std::left << std::setw(10) << "size" << std::right
+                  << std::setw(10) << "wall [s]" << std::setw(10) << "user [s]" << std::setw(10) << "sys [s]"
+                  << std::setw(16) << "peak RSS [MiB]" << std::setw(10) << "files" << std::setw(14) << "bytes"
+                  << std::endl;
+    }
+
+    void printResult(const FakeQtSize& size, const RunResult& result) {
+        std::cout << std::left << std::setw(10) << size.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << result.wallSeconds
+                  << std::setw(10) << result.resources.userSeconds
+                  << std::setw(10) << result.resources.systemSeconds
+                  << std::setw(16) << std::setprecision(1) << result.resources.maxResidentSetKb / 1024.0
+                  << std::setw(10) << result.deployed.files
+                  << std::setw(14) << result.deployed.bytes
+                  << std::endl;
+    }
+}
+
+int main(const int argc, const char* const* const argv) {
+    args::ArgumentParser parser("linuxdeploy Qt plugin benchmark",
+                                "Generates fake Qt installations and AppDirs of several sizes, runs the plugin on "
+                                "them and reports wall time, files and bytes deployed and peak RSS.");
+
+    args::ValueFlag<std::string> pluginPath(parser, "path", "Plugin executable to benchmark", {"plugin"},
+                                            LINUXDEPLOY_PLUGIN_QT_PATH);
+    args::ValueFlagList<std::string> sizeNames(parser, "size",
+                                               "Size to benchmark (small, medium or large, default: all)", {"size"});
+    args::ValueFlag<unsigned int> runs(parser, "runs", "Runs per size, the fastest one is reported (default: 1)",
+                                       {'r', "runs"}, 1);
+    args::ValueFlagList<std::string> pluginArgs(parser, "arg", "Additional argument to pass to the plugin",
+                                                {"plugin-arg"});
+    args::ValueFlag<std::string> workDir(parser, "path",
+                                         "Directory to generate the files in, must not exist (default: temporary)",
+                                         {"work-dir"});
+    args::Flag keep(parser, "", "Keep the generated files", {"keep"});
+    args::ValueFlag<double> standInLatency(parser, "seconds",
+                                           "Time the qmake and qmlimportscanner stand-ins take to answer (default: 0)",
+                                           {"stand-in-latency"}, 0);
+    args::ValueFlag<unsigned int> importListPadding(parser, "count",
+                                                    "Number of imports of missing modules the qmlimportscanner "
+                                                    "stand-in adds to its output (default: 0)",
+                                                    {"import-list-padding"}, 0);
+    args::Flag cached(parser, "", "Leave the plugin's persistent cache enabled, by default all runs are cold",
+                      {"cached"});
+
+    try {
+        parser.ParseCLI(argc, argv);
+    } catch (const args::ParseError&) {
+        std::cerr << parser;
+        return 1;
+    }
+
+    std::vector<FakeQtSize> sizes;
+
+    for (const auto& size : defaultFakeQtSizes()) {
+        const auto& names = sizeNames.Get();
+
+        if (names.empty() || std::find(names.begin(), names.end(), size.name) != names.end())
+            sizes.push_back(size);
+    }
+
+    if (sizes.empty()) {
+        std::cerr << "No such size, available sizes: small, medium, large" << std::endl;
+        return 1;
+    }
+
+    bf::path rootDir;
+
+    if (workDir) {
+        rootDir = workDir.Get();
+
+        if (bf::exists(rootDir)) {
+            std::cerr << "Directory exists already: " << rootDir.string() << std::endl;
+            return 1;
+        }
+
+        bf::create_directories(rootDir);
+    } else {
+        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-bench-XXXXXX";
+
+        if (mkdtemp(tmpl) == nullptr) {
+            std::cerr << "Failed to create temporary directory" << std::endl;
+            return 1;
+        }
+
+        rootDir = tmpl;
+    }
+
+    if (!cached)
+        setenv("DISABLE_QT_PLUGIN_CACHE", "1", true);
+
+    setenv("FAKE_QMAKE_LATENCY", std::to_string(standInLatency.Get()).c_str(), true);
+    setenv("FAKE_QMLIMPORTSCANNER_LATENCY", std::to_string(standInLatency.Get()).c_str(), true);
+    setenv("FAKE_QMLIMPORTSCANNER_PADDING", std::to_string(importListPadding.Get()).c_str(), true);
+
+    const std::string originalPath = getenv("PATH") != nullptr ? getenv("PATH") : "";
+
+    bool success = true;
+
+    printHeader();
+
+    for (const auto& size : sizes) {
+        const auto qtRoot = rootDir / size.name / "qt";
+        generateFakeQt(qtRoot, size, FAKE_QT_BIN_DIR);
+
+        // the generated qmake and qmlimportscanner stand-ins must be used, not whatever Qt is installed
+        setenv("QMAKE", (qtRoot / "bin/qmake").c_str(), true);
+        setenv("PATH", ((qtRoot / "bin").string() + ":" + originalPath).c_str(), true);
+
+        RunResult best;
+
+        for (unsigned int run = 0; run < std::max(runs.Get(), 1u); ++run) {
+            const auto appDirPath = rootDir / size.name / ("AppDir-" + std::to_string(run));
+
+            RunResult result;
+
+            try {
+                if (!runPlugin(pluginPath.Get(), pluginArgs.Get(), qtRoot, appDirPath, size, result)) {
+                    success = false;
+                    break;
+                }
+            } catch (const ProcessError& e) {
+                std::cerr << e.what() << std::endl;
+                success = false;
+                break;
+            }
+
+            if (run == 0 || result.wallSeconds < best.wallSeconds)
+                best = result;
+
+            if (!keep)
+                bf::remove_all(appDirPath);
+        }
+
+        if (!success)
+            break;
+
+        printResult(size, best);
+    }
+
+    if (keep)
+        std::cout << "Generated files kept in " << rootDir.string() << std::endl;
+    else
+        bf::remove_all(rootDir);
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// system includes
+#include <set>
+#include <string>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+
+// local includes
+#include "qml.h"
+#include "qt-module-matcher.h"
+#include "util.h"
+
+namespace bf = boost::filesystem;
+
+// each benchmark runs with a realistic size first, followed by a worst case size
+
+namespace {
+    // looks like the output of qmlimportscanner for a project importing the given number of modules
+    std::string makeQmlImportScannerOutput(size_t imports) {
+        std::string output = "[\n";
+
+        for (size_t i = 0; i < imports; ++i) {
+            const auto name = "org.example.Module" + std::to_string(i);
+            const auto relativePath = "org/example/Module" + std::to_string(i);
+
+            output += std::string(i > 0 ? ",\n" : "") +
+                      "    {\n"
+                      "        \"classname\": \"Module" + std::to_string(i) + "Plugin\",\n"
+                      "        \"name\": \"" + name + "\",\n"
+                      "        \"path\": \"/usr/lib/x86_64-linux-gnu/qt5/qml/" + relativePath + "\",\n"
+                      "        \"plugin\": \"module" + std::to_string(i) + "plugin\",\n"
+                      "        \"relativePath\": \"" + relativePath + "\",\n"
+                      "        \"type\": \"module\",\n"
+                      "        \"version\": \"2.15\"\n"
+                      "    }";
+        }
+
+        return output + "\n]\n";
+    }
+
+    void BM_parseQmlImportScannerOutput(benchmark::State& state) {
+        const auto output = makeQmlImportScannerOutput(static_cast<size_t>(state.range(0)));
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(parseQmlImportScannerOutput(output));
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * output.size()));
+    }
+    BENCHMARK(BM_parseQmlImportScannerOutput)->Arg(50)->Arg(20000)->Unit(benchmark::kMicrosecond);
+
+    void BM_parseQmakeQueryOutput(benchmark::State& state) {
+        // a real qmake prints about 30 properties
+        std::string output;
+
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            output += "QT_INSTALL_PROPERTY_" + std::to_string(i) + ":/opt/Qt/5.15.2/gcc_64/" +
+                      std::string(static_cast<size_t>(state.range(1)), 'x') + "\n";
+        }
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(parseQmakeQueryOutput(output));
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * output.size()));
+    }
+    BENCHMARK(BM_parseQmakeQueryOutput)->Args({30, 16})->Args({10000, 1024})->Unit(benchmark::kMicrosecond);
+
+    void BM_getQmlModuleRelativePath(benchmark::State& state) {
+        std::vector<bf::path> importPaths;
+
+        for (int64_t i = 0; i < state.range(0); ++i)
+            importPaths.emplace_back("/opt/project/imports/path" + std::to_string(i) + "/qml");
+
+        // the worst case: the module is found in the last import path
+        const auto modulePath = importPaths.back() / "org/kde/plasma/components";
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(getQmlModuleRelativePath(importPaths, modulePath));
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * importPaths.size()));
+    }
+    BENCHMARK(BM_getQmlModuleRelativePath)->Arg(3)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+    void BM_pathContainsFile(benchmark::State& state) {
+        bf::path dir = "/tmp/AppDir/usr";
+
+        for (int64_t i = 0; i < state.range(0); ++i)
+            dir /= "level" + std::to_string(i);
+
+        const auto file = dir / "translations/qtbase_de.qm";
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(pathContainsFile(dir, file));
+    }
+    BENCHMARK(BM_pathContainsFile)->Arg(2)->Arg(64);
+
+    void BM_findQtModules(benchmark::State& state) {
+        // a mix of Qt and other libraries, like an AppDir contains them, or names which all share Qt prefixes in the
+        // worst case
+        const bool worstCase = state.range(1) != 0;
+        std::set<std::string> libraryNames;
+
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            if (worstCase)
+                libraryNames.insert("libQt5WebEngineCore" + std::to_string(i) + "X.so.5");
+            else if (i % 3 == 0)
+                libraryNames.insert(std::string(QtModules[i % QtModulesCount].libraryFilePrefix) + ".so.5");
+            else
+                libraryNames.insert("libexample" + std::to_string(i) + ".so." + std::to_string(i % 7));
+        }
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(findQtModules(libraryNames));
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * libraryNames.size()));
+    }
+    BENCHMARK(BM_findQtModules)->Args({60, 0})->Args({5000, 1})->Unit(benchmark::kMicrosecond);
+
+    void BM_matchQtModule(benchmark::State& state) {
+        const std::vector<std::string> names = {
+            "core", "libQt5Core.so.5", "libQt5WebEngineCore.so.5", "libQt5Gui.so.5.15.2", "webenginewidgets",
+            "libQt5QuickControls2.so", "libexample.so.1", "libQt5NoSuchModule.so.5",
+        };
+
+        for (auto _ : state) {
+            for (const auto& name : names)
+                benchmark::DoNotOptimize(matchQtModule(name));
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * names.size()));
+    }
+    BENCHMARK(BM_matchQtModule);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,185 @@
+// system includes
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <stdexcept>
+
+// local includes
+#include "stub-elf.h"
+
+namespace bf = boost::filesystem;
+
+namespace {
+    // the stub files are made for the benchmark's host, so e_machine is taken from the running executable
+    uint16_t hostMachine() {
+        static const uint16_t machine = []() {
+            std::ifstream ifs("/proc/self/exe", std::ios::binary);
+
+            Elf64_Ehdr header{};
+            ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+            if (!ifs || memcmp(header.e_ident, ELFMAG, SELFMAG) != 0)
+                throw std::runtime_error("Failed to read ELF header of /proc/self/exe");
+
+            if (header.e_ident[EI_CLASS] != ELFCLASS64 || header.e_ident[EI_DATA] != ELFDATA2LSB)
+                throw std::runtime_error("Stub ELF files can only be generated on 64-bit little endian systems");
+
+            return header.e_machine;
+        }();
+
+        return machine;
+    }
+
+    size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // appends a string to a string table, returns its offset
+    Elf64_Word addString(std::string& table, const std::string& value) {
+        const auto offset = static_cast<Elf64_Word>(table.size());
+        table += value;
+        table += '\0';
+        return offset;
+    }
+
+    template<typename T>
+    void put(std::vector<char>& buffer, size_t offset, const T& value) {
+        memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace bench {
+                void writeStubElf(const bf::path& path, const std::string& soname,
+                                  const std::vector<std::string>& needed, size_t paddingSize) {
+                    // layout: header, program headers, .dynsym, .hash, .dynstr, .dynamic, .bench.padding,
+                    // .shstrtab, section headers
+                    // everything up to .dynamic is covered by a single writable PT_LOAD segment at address 0, the
+                    // dynamic loader relocates the dynamic section in place
+                    enum { SecNull, SecDynsym, SecHash, SecDynstr, SecDynamic, SecPadding, SecShstrtab, SecCount };
+
+                    std::string dynstr(1, '\0');
+
+                    std::vector<Elf64_Dyn> dynamic;
+
+                    for (const auto& name : needed)
+                        dynamic.push_back({DT_NEEDED, {addString(dynstr, name)}});
+
+                    if (!soname.empty())
+                        dynamic.push_back({DT_SONAME, {addString(dynstr, soname)}});
+
+                    std::string shstrtab(1, '\0');
+                    Elf64_Word sectionNames[SecCount] = {0};
+                    sectionNames[SecDynsym] = addString(shstrtab, ".dynsym");
+                    sectionNames[SecHash] = addString(shstrtab, ".hash");
+                    sectionNames[SecDynstr] = addString(shstrtab, ".dynstr");
+                    sectionNames[SecDynamic] = addString(shstrtab, ".dynamic");
+                    sectionNames[SecPadding] = addString(shstrtab, ".bench.padding");
+                    sectionNames[SecShstrtab] = addString(shstrtab, ".shstrtab");
+
+                    // a symbol table with the null symbol only, and a hash table with a single, empty bucket
+                    const Elf64_Word hashTable[] = {1, 1, 0, 0};
+
+                    const size_t phdrsOffset = sizeof(Elf64_Ehdr);
+                    const size_t dynsymOffset = alignUp(phdrsOffset + 2 * sizeof(Elf64_Phdr), 8);
+                    const size_t hashOffset = dynsymOffset + sizeof(Elf64_Sym);
+                    const size_t dynstrOffset = hashOffset + sizeof(hashTable);
+                    const size_t dynamicOffset = alignUp(dynstrOffset + dynstr.size(), 8);
+
+                    dynamic.push_back({DT_HASH, {hashOffset}});
+                    dynamic.push_back({DT_STRTAB, {dynstrOffset}});
+                    dynamic.push_back({DT_SYMTAB, {dynsymOffset}});
+                    dynamic.push_back({DT_STRSZ, {dynstr.size()}});
+                    dynamic.push_back({DT_SYMENT, {sizeof(Elf64_Sym)}});
+                    dynamic.push_back({DT_NULL, {0}});
+
+                    const size_t dynamicSize = dynamic.size() * sizeof(Elf64_Dyn);
+                    const size_t loadEnd = dynamicOffset + dynamicSize;
+                    const size_t paddingOffset = loadEnd;
+                    const size_t shstrtabOffset = paddingOffset + paddingSize;
+                    const size_t shdrsOffset = alignUp(shstrtabOffset + shstrtab.size(), 8);
+                    const size_t fileSize = shdrsOffset + SecCount * sizeof(Elf64_Shdr);
+
+                    std::vector<char> buffer(fileSize, '\0');
+
+                    Elf64_Ehdr header{};
+                    memcpy(header.e_ident, ELFMAG, SELFMAG);
+                    header.e_ident[EI_CLASS] = ELFCLASS64;
+                    header.e_ident[EI_DATA] = ELFDATA2LSB;
+                    header.e_ident[EI_VERSION] = EV_CURRENT;
+                    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+                    header.e_type = ET_DYN;
+                    header.e_machine = hostMachine();
+                    header.e_version = EV_CURRENT;
+                    header.e_phoff = phdrsOffset;
+                    header.e_shoff = shdrsOffset;
+                    header.e_ehsize = sizeof(Elf64_Ehdr);
+                    header.e_phentsize = sizeof(Elf64_Phdr);
+                    header.e_phnum = 2;
+                    header.e_shentsize = sizeof(Elf64_Shdr);
+                    header.e_shnum = SecCount;
+                    header.e_shstrndx = SecShstrtab;
+                    put(buffer, 0, header);
+
+                    Elf64_Phdr load{};
+                    load.p_type = PT_LOAD;
+                    load.p_flags = PF_R | PF_W;
+                    load.p_filesz = load.p_memsz = loadEnd;
+                    load.p_align = 0x1000;
+                    put(buffer, phdrsOffset, load);
+
+                    Elf64_Phdr dynamicSegment{};
+                    dynamicSegment.p_type = PT_DYNAMIC;
+                    dynamicSegment.p_flags = PF_R | PF_W;
+                    dynamicSegment.p_offset = dynamicSegment.p_vaddr = dynamicSegment.p_paddr = dynamicOffset;
+                    dynamicSegment.p_filesz = dynamicSegment.p_memsz = dynamicSize;
+                    dynamicSegment.p_align = 8;
+                    put(buffer, phdrsOffset + sizeof(Elf64_Phdr), dynamicSegment);
+
+                    memcpy(buffer.data() + hashOffset, hashTable, sizeof(hashTable));
+                    memcpy(buffer.data() + dynstrOffset, dynstr.data(), dynstr.size());
+                    memcpy(buffer.data() + dynamicOffset, dynamic.data(), dynamicSize);
+                    memcpy(buffer.data() + shstrtabOffset, shstrtab.data(), shstrtab.size());
+
+                    // not all zeroes, so the padding doesn't compress to nothing and isn't stored sparsely
+                    for (size_t i = 0; i < paddingSize; ++i)
+                        buffer[paddingOffset + i] = static_cast<char>((i * 2654435761u) >> 24);
+
+                    auto section = [&](int index, Elf64_Word type, Elf64_Xword flags, size_t offset, size_t size,
+                                       Elf64_Word link, Elf64_Word info, Elf64_Xword alignment, Elf64_Xword entrySize) {
+                        Elf64_Shdr shdr{};
+                        shdr.sh_name = sectionNames[index];
+                        shdr.sh_type = type;
+                        shdr.sh_flags = flags;
+                        shdr.sh_addr = (flags & SHF_ALLOC) ? offset : 0;
+                        shdr.sh_offset = offset;
+                        shdr.sh_size = size;
+                        shdr.sh_link = link;
+                        shdr.sh_info = info;
+                        shdr.sh_addralign = alignment;
+                        shdr.sh_entsize = entrySize;
+                        put(buffer, shdrsOffset + index * sizeof(Elf64_Shdr), shdr);
+                    };
+
+                    section(SecDynsym, SHT_DYNSYM, SHF_ALLOC, dynsymOffset, sizeof(Elf64_Sym), SecDynstr, 1, 8,
+                            sizeof(Elf64_Sym));
+                    section(SecHash, SHT_HASH, SHF_ALLOC, hashOffset, sizeof(hashTable), SecDynsym, 0, 4,
+                            sizeof(Elf64_Word));
+                    section(SecDynstr, SHT_STRTAB, SHF_ALLOC, dynstrOffset, dynstr.size(), 0, 0, 1, 0);
+                    section(SecDynamic, SHT_DYNAMIC, SHF_ALLOC | SHF_WRITE, dynamicOffset, dynamicSize, SecDynstr, 0,
+                            8, sizeof(Elf64_Dyn));
+                    section(SecPadding, SHT_PROGBITS, 0, paddingOffset, paddingSize, 0, 0, 1, 0);
+                    section(SecShstrtab, SHT_STRTAB, 0, shstrtabOffset, shstrtab.size(), 0, 0, 1, 0);
+
+                    std::ofstream ofs(path.string(), std::ios::binary | std::ios::trunc);
+                    ofs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+                    if (!ofs)
+                        throw std::runtime_error("Failed to write " + path.string());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,30 @@
+// system includes
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace bench {
+                /**
+                 * Writes a minimal ELF shared object for the machine the benchmark runs on. It contains no code, just a
+                 * dynamic section with DT_SONAME and DT_NEEDED entries and the section headers tools like readelf,
+                 * strip and patchelf expect, so the dynamic loader can list its dependencies.
+                 *
+                 * @param path file to write
+                 * @param soname DT_SONAME, omitted if empty
+                 * @param needed DT_NEEDED entries, in this order
+                 * @param paddingSize size of an additional, non-loadable section, used to give files a realistic size
+                 * @throws std::runtime_error if the host is no 64-bit little endian system or the file cannot be written
+                 */
+                void writeStubElf(const boost::filesystem::path& path, const std::string& soname,
+                                  const std::vector<std::string>& needed, size_t paddingSize = 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,242 @@
+// system includes
+#include <fstream>
+#include <tuple>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "appdir-proxy.h"
+#include "fs.h"
+#include "plan.h"
+#include "progress.h"
+#include "provenance.h"
+#include "timeline.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace linuxdeploy::plugin::qt;
+
+namespace {
+    thread_local const AppDirProxy::Slot* currentSlot = nullptr;
+
+    // the path linuxdeploy copies a file to: into the destination if it ends with a slash, to the destination itself
+    // otherwise
+    bf::path resolveDestination(const bf::path& source, const bf::path& destination) {
+        const auto& destinationString = destination.string();
+
+        if (!destinationString.empty() && destinationString.back() == '/')
+            return destination / source.filename();
+
+        return destination;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            AppDirProxy::Slot::Slot(AppDirProxy& proxy, size_t index) : proxy(proxy), index(index),
+                                                                        previousSlot(currentSlot) {
+                currentSlot = this;
+            }
+
+            AppDirProxy::Slot::~Slot() {
+                currentSlot = previousSlot;
+
+                std::lock_guard<std::mutex> lock(proxy.mutex);
+                proxy.finishedSlots[index] = true;
+
+                while (proxy.turn < proxy.finishedSlots.size() && proxy.finishedSlots[proxy.turn])
+                    ++proxy.turn;
+
+                proxy.turnCondition.notify_all();
+            }
+
+            bool AppDirProxy::Operation::operator<(const Operation& other) const {
+                return std::tie(name, source, destination) < std::tie(other.name, other.source, other.destination);
+            }
+
+            AppDirProxy::AppDirProxy(core::appdir::AppDir& appDir) : appDir(appDir), repeatedOperations(0),
+                                                                     plan(nullptr), turn(0) {}
+
+            void AppDirProxy::beginSequence(size_t slotsCount) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                finishedSlots.assign(slotsCount, false);
+                turn = 0;
+            }
+
+            void AppDirProxy::planInto(DeploymentPlan& plan) {
+                std::lock_guard<std::mutex> lock(mutex);
+                this->plan = &plan;
+            }
+
+            std::unique_lock<std::mutex> AppDirProxy::waitForTurn() {
+                std::unique_lock<std::mutex> lock(mutex);
+
+                if (currentSlot != nullptr && &currentSlot->proxy == this) {
+                    const auto index = currentSlot->index;
+                    turnCondition.wait(lock, [this, index]() { return turn == index; });
+                }
+
+                return lock;
+            }
+
+            bool AppDirProxy::findRepeatedOperation(const Operation& operation, const bf::path& resolvedDestination,
+                                                    bool& result) {
+                const auto it = operations.find(operation);
+
+                if (it == operations.end())
+                    return false;
+
+                ldLog() << LD_DEBUG << "Skipping repeated" << operation.name << operation.source << std::endl;
+
+                ++repeatedOperations;
+
+                // it's still a reason for the file to be there
+                Provenance::instance().fileDeployed(resolvedDestination);
+
+                result = it->second;
+                return true;
+            }
+
+            bool AppDirProxy::recordPlanned(const Operation& operation, const bf::path& resolvedDestination) {
+                if (plan == nullptr)
+                    return false;
+
+                plan->add(operation.name, operation.source, resolvedDestination, operation.destination,
+                          Provenance::instance().describeCurrentScopes());
+                operations[operation] = true;
+                return true;
+            }
+
+            bool AppDirProxy::deployLibrary(const bf::path& path, const bf::path& destination) {
+                const auto lock = waitForTurn();
+                const Operation operation{"deployLibrary", path, destination};
+                const auto resolvedDestination = resolveDestination(
+                    path, destination.empty() ? appDir.path() / "usr/lib/" : destination
+                );
+
+                bool result;
+                if (findRepeatedOperation(operation, resolvedDestination, result))
+                    return result;
+
+                TimelineSpan span(path.filename().string(), "file", "deployLibrary " + path.string());
+                ProgressEvents::instance().fileQueued(path, resolvedDestination);
+                Provenance::instance().fileDeployed(resolvedDestination);
+
+                if (recordPlanned(operation, resolvedDestination))
+                    return true;
+
+                return operations[operation] = appDir.deployLibrary(path, destination);
+            }
+
+            bool AppDirProxy::deployExecutable(const bf::path& path, const bf::path& destination) {
+                const auto lock = waitForTurn();
+                const Operation operation{"deployExecutable", path, destination};
+                const auto resolvedDestination = resolveDestination(
+                    path, destination.empty() ? appDir.path() / "usr/bin/" : destination
+                );
+
+                bool result;
+                if (findRepeatedOperation(operation, resolvedDestination, result))
+                    return result;
+
+                TimelineSpan span(path.filename().string(), "file", "deployExecutable " + path.string());
+                ProgressEvents::instance().fileQueued(path, resolvedDestination);
+                Provenance::instance().fileDeployed(resolvedDestination);
+
+                if (recordPlanned(operation, resolvedDestination))
+                    return true;
+
+                return operations[operation] = appDir.deployExecutable(path, destination);
+            }
+
+            bool AppDirProxy::deployFile(const bf::path& from, const bf::path& to) {
+                const auto lock = waitForTurn();
+                const Operation operation{"deployFile", from, to};
+                const auto resolvedDestination = resolveDestination(from, to);
+
+                bool result;
+                if (findRepeatedOperation(operation, resolvedDestination, result))
+                    return result;
+
+                TimelineSpan span(from.filename().string(), "file", "deployFile " + from.string());
+                ProgressEvents::instance().fileQueued(from, resolvedDestination);
+                Provenance::instance().fileDeployed(resolvedDestination);
+
+                if (recordPlanned(operation, resolvedDestination))
+                    return true;
+
+                return operations[operation] = appDir.deployFile(from, to);
+            }
+
+            bool AppDirProxy::createRelativeSymlink(const bf::path& target, const bf::path& symlink) {
+                const auto lock = waitForTurn();
+                const Operation operation{"createRelativeSymlink", target, symlink};
+
+                bool result;
+                if (findRepeatedOperation(operation, symlink, result))
+                    return result;
+
+                TimelineSpan span(symlink.filename().string(), "file", "createRelativeSymlink " + target.string());
+                ProgressEvents::instance().fileQueued(target, symlink, true);
+                Provenance::instance().fileDeployed(symlink);
+
+                if (recordPlanned(operation, symlink))
+                    return true;
+
+                return operations[operation] = appDir.createRelativeSymlink(target, symlink);
+            }
+
+            bool AppDirProxy::writeFile(const bf::path& path, const std::string& contents) {
+                const auto lock = waitForTurn();
+
+                TimelineSpan span(path.filename().string(), "file", "writeFile " + path.string());
+                Provenance::instance().fileDeployed(path);
+
+                if (plan != nullptr) {
+                    plan->addWrittenFile(path, contents, Provenance::instance().describeCurrentScopes());
+                    return true;
+                }
+
+                fs::createDirectories(path.parent_path(), FS_HERE);
+
+                std::ofstream ofs(path.string());
+
+                if (!ofs) {
+                    ldLog() << LD_ERROR << "Failed to open" << path << "for writing" << std::endl;
+                    return false;
+                }
+
+                ofs << contents;
+                return static_cast<bool>(ofs);
+            }
+
+            bool AppDirProxy::executeDeferredOperations() {
+                const auto lock = waitForTurn();
+
+                // nothing has been queued
+                if (plan != nullptr)
+                    return true;
+
+                TimelineSpan span("execute deferred operations", "file");
+                return appDir.executeDeferredOperations();
+            }
+
+            bf::path AppDirProxy::path() {
+                return appDir.path();
+            }
+
+            size_t AppDirProxy::repeatedOperationsCount() {
+                std::lock_guard<std::mutex> lock(mutex);
+                return repeatedOperations;
+            }
+
+            core::appdir::AppDir& AppDirProxy::target() {
+                return appDir;
+            }
+        }
+    }
+}
@@ -0,0 +1,139 @@
+// system includes
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <linuxdeploy/core/appdir.h>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            class DeploymentPlan;
+
+            /**
+             * Forwards the deployment operations of the deployers to the actual AppDir, recording a timeline span for
+             * each of them. This way, all files deployed by this plugin can be observed in a single place.
+             *
+             * Note that linuxdeploy defers the actual copying to AppDir::executeDeferredOperations(), the spans cover
+             * the work done right away, e.g., tracing a library's dependencies.
+             *
+             * Operations are handed to linuxdeploy only once, repeating one, e.g., because two modules need the
+             * same plugins, returns the result of the first call.
+             *
+             * linuxdeploy's AppDir isn't thread-safe, the operations are serialized. Deployers running concurrently
+             * take a Slot, which orders their operations like in a serial run.
+             *
+             * When planning, the operations are recorded in a DeploymentPlan instead, nothing is written to the AppDir.
+             */
+            class AppDirProxy {
+            private:
+                struct Operation {
+                    std::string name;
+                    boost::filesystem::path source;
+
+                    // as passed by the caller, linuxdeploy treats some destinations differently, e.g., empty ones
+                    boost::filesystem::path destination;
+
+                    bool operator<(const Operation& other) const;
+                };
+
+                core::appdir::AppDir& appDir;
+
+                // the operations handed to linuxdeploy so far, and their results
+                std::map<Operation, bool> operations;
+                size_t repeatedOperations;
+
+                // set by planInto()
+                DeploymentPlan* plan;
+
+                std::mutex mutex;
+                std::condition_variable turnCondition;
+                std::vector<bool> finishedSlots;
+
+                // the first slot which hasn't finished yet
+                size_t turn;
+
+                // locks the AppDir, once all slots before the calling thread's one have finished
+                std::unique_lock<std::mutex> waitForTurn();
+
+                // looks up the result of an operation which has been handed to linuxdeploy before
+                bool findRepeatedOperation(const Operation& operation,
+                                           const boost::filesystem::path& resolvedDestination, bool& result);
+
+                // records the operation in the plan instead of handing it to linuxdeploy, if there is one
+                bool recordPlanned(const Operation& operation, const boost::filesystem::path& resolvedDestination);
+
+            public:
+                /**
+                 * Makes the operations of the calling thread wait until the slots before it have finished, so that
+                 * they reach the AppDir in the same order and with the same results as if the slots were run one
+                 * after another. Work not involving the AppDir isn't held up.
+                 */
+                class Slot {
+                private:
+                    AppDirProxy& proxy;
+                    const size_t index;
+                    const Slot* const previousSlot;
+
+                public:
+                    Slot(AppDirProxy& proxy, size_t index);
+                    ~Slot();
+
+                    Slot(const Slot&) = delete;
+                    Slot& operator=(const Slot&) = delete;
+
+                    friend class AppDirProxy;
+                };
+
+                explicit AppDirProxy(core::appdir::AppDir& appDir);
+
+                /**
+                 * Starts a sequence of slots, numbered from 0. Every slot has to be taken and released exactly once.
+                 */
+                void beginSequence(size_t slotsCount);
+
+                /**
+                 * Records the following operations in the plan, which must outlive the proxy, instead of handing them
+                 * to linuxdeploy. They succeed without checking whether the files could be deployed.
+                 */
+                void planInto(DeploymentPlan& plan);
+
+                bool deployLibrary(const boost::filesystem::path& path,
+                                   const boost::filesystem::path& destination = "");
+
+                bool deployExecutable(const boost::filesystem::path& path,
+                                      const boost::filesystem::path& destination = "");
+
+                bool deployFile(const boost::filesystem::path& from, const boost::filesystem::path& to);
+
+                bool createRelativeSymlink(const boost::filesystem::path& target,
+                                           const boost::filesystem::path& symlink);
+
+                /**
+                 * Writes a file generated by a deployer, e.g., a qt.conf, creating its directory. Unlike the other
+                 * operations, the file is written right away, and repeating it overwrites the file.
+                 */
+                bool writeFile(const boost::filesystem::path& path, const std::string& contents);
+
+                /**
+                 * Lets linuxdeploy copy the files queued so far, e.g., to overlap copying with other work.
+                 */
+                bool executeDeferredOperations();
+
+                boost::filesystem::path path();
+
+                // number of operations which weren't handed to linuxdeploy again
+                size_t repeatedOperationsCount();
+
+                // the AppDir operations are forwarded to
+                core::appdir::AppDir& target();
+            };
+        }
+    }
+}
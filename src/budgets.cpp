@@ -0,0 +1,295 @@
+// system includes
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "budgets.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace linuxdeploy::plugin::qt;
+
+namespace {
+    // number of contributors listed per violation
+    const size_t maxContributors = 5;
+
+    uintmax_t parseSize(const std::string& value) {
+        char* end = nullptr;
+        const auto number = strtod(value.c_str(), &end);
+
+        if (end == value.c_str() || number < 0)
+            throw BudgetError("Invalid size: " + value);
+
+        double factor = 1;
+
+        switch (toupper(*end)) {
+            case '\0':
+                break;
+            case 'K':
+                factor = 1024.0;
+                break;
+            case 'M':
+                factor = 1024.0 * 1024;
+                break;
+            case 'G':
+                factor = 1024.0 * 1024 * 1024;
+                break;
+            default:
+                throw BudgetError("Invalid size: " + value);
+        }
+
+        if (*end != '\0' && *(end + 1) != '\0')
+            throw BudgetError("Invalid size: " + value);
+
+        return static_cast<uintmax_t>(number * factor);
+    }
+
+    double parseNumber(const std::string& value) {
+        char* end = nullptr;
+        const auto number = strtod(value.c_str(), &end);
+
+        if (end == value.c_str() || *end != '\0' || number < 0)
+            throw BudgetError("Invalid number: " + value);
+
+        return number;
+    }
+
+    std::string formatSize(uintmax_t bytes) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024) << " MiB";
+        return oss.str();
+    }
+
+    std::string formatSeconds(double seconds) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << seconds << " s";
+        return oss.str();
+    }
+
+    // the directory a file is attributed to: a plugin category, a QML module, or the first two levels otherwise
+    std::string contributorGroup(const bf::path& relativePath) {
+        std::vector<std::string> components;
+
+        for (const auto& component : relativePath.parent_path())
+            components.push_back(component.string());
+
+        if (components.size() >= 3 && components[0] == "usr" && (components[1] == "plugins" || components[1] == "qml"))
+            return components[0] + "/" + components[1] + "/" + components[2];
+
+        if (components.size() >= 2)
+            return components[0] + "/" + components[1];
+
+        return relativePath.string();
+    }
+
+    // returns the keys with the highest values, highest first
+    template<typename T>
+    std::vector<std::pair<std::string, T>> largest(const std::map<std::string, T>& values) {
+        std::vector<std::pair<std::string, T>> rv(values.begin(), values.end());
+
+        std::stable_sort(rv.begin(), rv.end(), [](const std::pair<std::string, T>& a,
+                                                  const std::pair<std::string, T>& b) {
+            return a.second > b.second;
+        });
+
+        if (rv.size() > maxContributors)
+            rv.resize(maxContributors);
+
+        return rv;
+    }
+
+    // lists the groups and files contributing most to the size of the files matching the filter
+    template<typename Filter>
+    std::vector<std::string> sizeContributors(const AppDirUsage& usage, Filter filter) {
+        std::map<std::string, uintmax_t> groups;
+        std::map<std::string, uintmax_t> files;
+
+        for (const auto& file : usage.files) {
+            if (!filter(file))
+                continue;
+
+            groups[contributorGroup(file.path)] += file.bytes;
+            files[file.path.string()] = file.bytes;
+        }
+
+        std::vector<std::string> rv;
+
+        // a single group doesn't tell anything the files don't tell
+        if (groups.size() > 1) {
+            for (const auto& group : largest(groups))
+                rv.push_back(group.first + "/: " + formatSize(group.second));
+        }
+
+        for (const auto& file : largest(files))
+            rv.push_back(file.first + ": " + formatSize(file.second));
+
+        return rv;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            bool DeploymentBudgets::empty() const {
+                return totalBytes == 0 && files == 0 && seconds == 0 && pluginCategoryBytes == 0 &&
+                       pluginCategoryBytesByName.empty();
+            }
+
+            void parseBudget(const std::string& specification, DeploymentBudgets& budgets) {
+                const auto separatorPos = specification.find('=');
+
+                if (separatorPos == std::string::npos)
+                    throw BudgetError("Invalid budget, expected name=limit: " + specification);
+
+                const auto name = specification.substr(0, separatorPos);
+                const auto value = specification.substr(separatorPos + 1);
+
+                static const std::string pluginCategoryPrefix = "plugin-bytes:";
+
+                if (name == "total-bytes") {
+                    budgets.totalBytes = parseSize(value);
+                } else if (name == "files") {
+                    budgets.files = static_cast<size_t>(parseNumber(value));
+                } else if (name == "seconds") {
+                    budgets.seconds = parseNumber(value);
+                } else if (name == "plugin-bytes") {
+                    budgets.pluginCategoryBytes = parseSize(value);
+                } else if (name.compare(0, pluginCategoryPrefix.size(), pluginCategoryPrefix) == 0 &&
+                           name.size() > pluginCategoryPrefix.size()) {
+                    budgets.pluginCategoryBytesByName[name.substr(pluginCategoryPrefix.size())] = parseSize(value);
+                } else {
+                    throw BudgetError("Unknown budget: " + name);
+                }
+            }
+
+            AppDirUsage measureAppDirUsage(const bf::path& appDirPath) {
+                AppDirUsage usage;
+
+                for (bf::recursive_directory_iterator i(appDirPath); i != bf::recursive_directory_iterator(); ++i) {
+                    const auto type = i->symlink_status().type();
+
+                    if (type != bf::regular_file && type != bf::symlink_file)
+                        continue;
+
+                    const auto bytes = type == bf::regular_file ? bf::file_size(i->path()) : 0;
+
+                    usage.files.push_back({bf::relative(i->path(), appDirPath), bytes});
+                    usage.totalBytes += bytes;
+                }
+
+                return usage;
+            }
+
+            std::vector<BudgetViolation> checkBudgets(const DeploymentBudgets& budgets, const AppDirUsage& usage,
+                                                      double elapsedSeconds,
+                                                      const std::vector<Timeline::Span>& spans) {
+                std::vector<BudgetViolation> violations;
+
+                if (budgets.totalBytes > 0 && usage.totalBytes > budgets.totalBytes) {
+                    violations.push_back({"total-bytes", formatSize(budgets.totalBytes), formatSize(usage.totalBytes),
+                                          sizeContributors(usage, [](const AppDirUsage::File&) { return true; })});
+                }
+
+                if (budgets.files > 0 && usage.files.size() > budgets.files) {
+                    std::map<std::string, size_t> groups;
+
+                    for (const auto& file : usage.files)
+                        ++groups[contributorGroup(file.path)];
+
+                    BudgetViolation violation{"files", std::to_string(budgets.files),
+                                              std::to_string(usage.files.size()), {}};
+
+                    for (const auto& group : largest(groups))
+                        violation.contributors.push_back(group.first + "/: " + std::to_string(group.second) + " files");
+
+                    violations.push_back(violation);
+                }
+
+                if (budgets.pluginCategoryBytes > 0 || !budgets.pluginCategoryBytesByName.empty()) {
+                    std::map<std::string, uintmax_t> categories;
+
+                    for (const auto& file : usage.files) {
+                        const auto group = contributorGroup(file.path);
+
+                        if (group.compare(0, 12, "usr/plugins/") == 0)
+                            categories[group.substr(12)] += file.bytes;
+                    }
+
+                    for (const auto& category : categories) {
+                        const auto limitIt = budgets.pluginCategoryBytesByName.find(category.first);
+                        const auto limit = limitIt != budgets.pluginCategoryBytesByName.end()
+                                           ? limitIt->second : budgets.pluginCategoryBytes;
+
+                        if (limit == 0 || category.second <= limit)
+                            continue;
+
+                        const auto prefix = "usr/plugins/" + category.first + "/";
+
+                        violations.push_back({"plugin-bytes:" + category.first, formatSize(limit),
+                                              formatSize(category.second),
+                                              sizeContributors(usage, [&prefix](const AppDirUsage::File& file) {
+                                                  return file.path.string().compare(0, prefix.size(), prefix) == 0;
+                                              })});
+                    }
+                }
+
+                if (budgets.seconds > 0 && elapsedSeconds > budgets.seconds) {
+                    // phases of the main thread and the deployers nested in them, deployers used for several modules
+                    // are summed up
+                    std::map<std::string, double> durations;
+
+                    for (const auto& span : spans) {
+                        if ((span.category == "phase" && span.threadId == 0) || span.category == "deployer")
+                            durations[span.name] += std::chrono::duration<double>(span.end - span.start).count();
+                    }
+
+                    BudgetViolation violation{"seconds", formatSeconds(budgets.seconds),
+                                              formatSeconds(elapsedSeconds), {}};
+
+                    for (const auto& duration : largest(durations))
+                        violation.contributors.push_back(duration.first + ": " + formatSeconds(duration.second));
+
+                    violations.push_back(violation);
+                }
+
+                return violations;
+            }
+
+            bool checkDeploymentBudgets(const bf::path& appDirPath, const DeploymentBudgets& budgets) {
+                const auto& timeline = Timeline::instance();
+                const auto elapsedSeconds = std::chrono::duration<double>(
+                    Timeline::Clock::now() - timeline.start()
+                ).count();
+
+                const auto violations = checkBudgets(budgets, measureAppDirUsage(appDirPath), elapsedSeconds,
+                                                     timeline.spans());
+
+                if (violations.empty()) {
+                    ldLog() << "All budgets met" << std::endl;
+                    return true;
+                }
+
+                for (const auto& violation : violations) {
+                    ldLog() << LD_ERROR << "Budget" << violation.budget << "exceeded:" << violation.actual
+                            << "(limit:" << violation.limit << LD_NO_SPACE << ")" << std::endl;
+
+                    if (!violation.contributors.empty()) {
+                        ldLog() << LD_ERROR << "Largest contributors:" << std::endl;
+
+                        for (const auto& contributor : violation.contributors)
+                            ldLog() << LD_ERROR << "  " << contributor << std::endl;
+                    }
+                }
+
+                return false;
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+// system includes
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+// local includes
+#include "timeline.h"
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            struct BudgetError : public std::runtime_error {
+                explicit BudgetError(const std::string& message) : runtime_error(message) {}
+            };
+
+            /**
+             * Limits for the AppDir after the deployment. Limits set to 0 aren't checked.
+             */
+            struct DeploymentBudgets {
+                uintmax_t totalBytes = 0;
+                size_t files = 0;
+                double seconds = 0;
+
+                // applies to every directory in usr/plugins which has no limit of its own
+                uintmax_t pluginCategoryBytes = 0;
+                std::map<std::string, uintmax_t> pluginCategoryBytesByName;
+
+                bool empty() const;
+            };
+
+            /**
+             * Parses a budget specification and sets the limit in budgets. Supported specifications:
+             *  - total-bytes=SIZE: size of all files in the AppDir
+             *  - files=N: number of files and symlinks in the AppDir
+             *  - seconds=S: time the plugin took until the deferred operations have been executed
+             *  - plugin-bytes=SIZE: size of every directory in usr/plugins, e.g., imageformats
+             *  - plugin-bytes:CATEGORY=SIZE: size of a single directory in usr/plugins
+             *
+             * Sizes may have a K, M or G suffix (powers of 1024).
+             *
+             * @throws BudgetError if the specification is invalid
+             */
+            void parseBudget(const std::string& specification, DeploymentBudgets& budgets);
+
+            /**
+             * Sizes of the files in an AppDir.
+             */
+            struct AppDirUsage {
+                struct File {
+                    // relative to the AppDir
+                    boost::filesystem::path path;
+
+                    // 0 for symlinks
+                    uintmax_t bytes;
+                };
+
+                std::vector<File> files;
+                uintmax_t totalBytes = 0;
+            };
+
+            AppDirUsage measureAppDirUsage(const boost::filesystem::path& appDirPath);
+
+            struct BudgetViolation {
+                // e.g., "total-bytes", as in the specification
+                std::string budget;
+
+                // human readable limit and actual value, e.g., "50.0 MiB"
+                std::string limit;
+                std::string actual;
+
+                // the largest contributors, biggest first, e.g., "usr/plugins/imageformats: 12.3 MiB"
+                std::vector<std::string> contributors;
+            };
+
+            /**
+             * Checks the usage and the time spent so far against the budgets.
+             *
+             * Size and file count violations name the directories (usr/lib, usr/plugins/imageformats, usr/qml/QtQuick,
+             * ...) and files contributing most, time violations the longest phases and deployers.
+             *
+             * @param spans spans recorded so far, see Timeline::spans()
+             */
+            std::vector<BudgetViolation> checkBudgets(const DeploymentBudgets& budgets, const AppDirUsage& usage,
+                                                      double elapsedSeconds,
+                                                      const std::vector<Timeline::Span>& spans);
+
+            /**
+             * Measures the AppDir and checks it and the time spent since the start of the timeline against the
+             * budgets. Violations are logged along with their largest contributors.
+             *
+             * @return false if a budget is exceeded
+             */
+            bool checkDeploymentBudgets(const boost::filesystem::path& appDirPath, const DeploymentBudgets& budgets);
+        }
+    }
+}
@@ -0,0 +1,205 @@
+// system includes
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "cache.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+
+namespace {
+    uint64_t fnv1aUpdate(const char* data, size_t size, uint64_t hash) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            DiskCache::DiskCache(bf::path directory, size_t maxEntries) : directory(std::move(directory)),
+                                                                          hitsCount(0), missesCount(0) {
+                if (this->directory.empty())
+                    return;
+
+                ldLog() << LD_DEBUG << "Using cache directory:" << this->directory << std::endl;
+
+                if (maxEntries > 0)
+                    evictOldEntries(maxEntries);
+            }
+
+            void DiskCache::evictOldEntries(size_t maxEntries) {
+                std::vector<std::pair<std::time_t, bf::path>> entries;
+
+                boost::system::error_code ec;
+
+                // a missing directory just means there's nothing to evict yet
+                for (bf::directory_iterator i(directory, ec), end; !ec && i != end; i.increment(ec)) {
+                    boost::system::error_code timeEc;
+                    const auto time = bf::last_write_time(i->path(), timeEc);
+
+                    if (!timeEc)
+                        entries.emplace_back(time, i->path());
+                }
+
+                if (entries.size() <= maxEntries)
+                    return;
+
+                // the entries stored least recently go first
+                const auto evictedCount = entries.size() - maxEntries;
+                std::nth_element(entries.begin(), entries.begin() + evictedCount, entries.end());
+
+                for (size_t i = 0; i < evictedCount; ++i)
+                    bf::remove(entries[i].second, ec);
+
+                ldLog() << LD_DEBUG << "Evicted" << evictedCount << "old entries from cache" << directory << std::endl;
+            }
+
+            bf::path DiskCache::defaultDirectory(const std::string& name) {
+                if (getenv("DISABLE_QT_PLUGIN_CACHE") != nullptr)
+                    return {};
+
+                bf::path cacheHome;
+
+                const auto* xdgCacheHome = getenv("XDG_CACHE_HOME");
+                const auto* home = getenv("HOME");
+
+                if (xdgCacheHome != nullptr && xdgCacheHome[0] != '\0') {
+                    cacheHome = xdgCacheHome;
+                } else if (home != nullptr && home[0] != '\0') {
+                    cacheHome = bf::path(home) / ".cache";
+                } else {
+                    return {};
+                }
+
+                return cacheHome / "linuxdeploy-plugin-qt" / name;
+            }
+
+            bool DiskCache::enabled() const {
+                return !directory.empty();
+            }
+
+            bool DiskCache::lookup(const std::string& key, std::string& value) {
+                if (!enabled())
+                    return false;
+
+                std::ostringstream entryName;
+                entryName << std::hex << std::setw(16) << std::setfill('0') << fnv1aHash(key);
+
+                std::ifstream ifs((directory / entryName.str()).string(), std::ios::binary);
+
+                std::string storedKey;
+
+                // a missing file is just as much of a miss as a hash collision
+                if (!ifs || !std::getline(ifs, storedKey) || storedKey != key) {
+                    ++missesCount;
+                    return false;
+                }
+
+                std::ostringstream contents;
+                contents << ifs.rdbuf();
+
+                value = contents.str();
+                ++hitsCount;
+                return true;
+            }
+
+            void DiskCache::store(const std::string& key, const std::string& value,
+                                  std::vector<std::string>* warnings) {
+                if (!enabled())
+                    return;
+
+                std::ostringstream entryName;
+                entryName << std::hex << std::setw(16) << std::setfill('0') << fnv1aHash(key);
+
+                const auto entryPath = directory / entryName.str();
+                const auto tempPath = directory / bf::unique_path(entryName.str() + ".%%%%-%%%%-%%%%.tmp");
+
+                try {
+                    bf::create_directories(directory);
+
+                    {
+                        std::ofstream ofs(tempPath.string(), std::ios::binary);
+                        ofs << key << '\n' << value;
+
+                        if (!ofs)
+                            throw std::runtime_error("Could not write " + tempPath.string());
+                    }
+
+                    bf::rename(tempPath, entryPath);
+                } catch (const std::exception& e) {
+                    if (warnings != nullptr)
+                        warnings->push_back(std::string("Failed to store cache entry: ") + e.what());
+                    else
+                        ldLog() << LD_WARNING << "Failed to store cache entry:" << e.what() << std::endl;
+
+                    boost::system::error_code ec;
+                    bf::remove(tempPath, ec);
+                }
+            }
+
+            size_t DiskCache::hits() const {
+                return hitsCount;
+            }
+
+            size_t DiskCache::misses() const {
+                return missesCount;
+            }
+
+            uint64_t fnv1aHash(const std::string& data, uint64_t hash) {
+                return fnv1aUpdate(data.data(), data.size(), hash);
+            }
+
+            uint64_t fnv1aHashFile(const bf::path& path) {
+                std::ifstream ifs(path.string(), std::ios::binary);
+
+                if (!ifs)
+                    throw std::runtime_error("Could not open file for hashing: " + path.string());
+
+                uint64_t hash = 0xcbf29ce484222325ull;
+
+                std::vector<char> buffer(64 * 1024);
+
+                while (ifs) {
+                    ifs.read(buffer.data(), buffer.size());
+                    hash = fnv1aUpdate(buffer.data(), static_cast<size_t>(ifs.gcount()), hash);
+                }
+
+                if (!ifs.eof())
+                    throw std::runtime_error("Could not read file for hashing: " + path.string());
+
+                return hash;
+            }
+
+            std::string fileIdentity(const bf::path& path) {
+                struct stat st{};
+
+                if (stat(path.c_str(), &st) != 0)
+                    return "";
+
+                std::ostringstream identity;
+                identity << st.st_dev << ":" << st.st_ino << ":" << st.st_size << ":"
+                         << st.st_mtim.tv_sec << "." << std::setw(9) << std::setfill('0') << st.st_mtim.tv_nsec;
+
+                return identity.str();
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// system includes
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Simple persistent key-value store.
+             *
+             * Every entry is stored in a file named after a hash of its key. The key is stored along with the value,
+             * so hash collisions are detected on lookup. Entries are written to a temporary file and renamed, so
+             * concurrent writers (threads or processes) never produce partially written entries.
+             *
+             * A cache constructed with an empty directory is disabled, i.e., all lookups miss and nothing is stored.
+             *
+             * If the number of entries is limited, the least recently stored entries beyond the limit are removed when
+             * the cache is opened.
+             */
+            class DiskCache {
+            private:
+                const boost::filesystem::path directory;
+
+                std::atomic<size_t> hitsCount;
+                std::atomic<size_t> missesCount;
+
+                void evictOldEntries(size_t maxEntries);
+
+            public:
+                // maxEntries: 0 means unlimited
+                explicit DiskCache(boost::filesystem::path directory, size_t maxEntries = 0);
+
+                /**
+                 * Returns the directory in which the cache with the given name should be stored by default, i.e.,
+                 * $XDG_CACHE_HOME/linuxdeploy-plugin-qt/<name>, falling back to ~/.cache if $XDG_CACHE_HOME is not set.
+                 * Returns an empty path if caching is disabled via $DISABLE_QT_PLUGIN_CACHE, or no suitable location
+                 * could be determined.
+                 */
+                static boost::filesystem::path defaultDirectory(const std::string& name);
+
+                bool enabled() const;
+
+                /**
+                 * Looks up an entry.
+                 *
+                 * @param key key to look up
+                 * @param value set to the stored value on success
+                 * @return true if an entry was found, false otherwise
+                 */
+                bool lookup(const std::string& key, std::string& value);
+
+                /**
+                 * Stores an entry, replacing existing entries for the same key. Failures are not fatal, they are
+                 * logged, or added to warnings if given.
+                 */
+                void store(const std::string& key, const std::string& value,
+                           std::vector<std::string>* warnings = nullptr);
+
+                size_t hits() const;
+                size_t misses() const;
+            };
+
+            /**
+             * Calculates the 64-bit FNV-1a hash of a string.
+             */
+            uint64_t fnv1aHash(const std::string& data, uint64_t hash = 0xcbf29ce484222325ull);
+
+            /**
+             * Calculates the 64-bit FNV-1a hash of a file's contents.
+             *
+             * @throws std::runtime_error if the file cannot be read
+             */
+            uint64_t fnv1aHashFile(const boost::filesystem::path& path);
+
+            /**
+             * Builds a string identifying a file's current state on disk, consisting of the device and inode numbers,
+             * the size and the modification time (with nanosecond resolution, if available).
+             * Returns an empty string if the file cannot be stat()ed.
+             */
+            std::string fileIdentity(const boost::filesystem::path& path);
+        }
+    }
+}
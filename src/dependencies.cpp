@@ -0,0 +1,218 @@
+// system includes
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// library includes
+#include <linuxdeploy/core/elf.h>
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "dependencies.h"
+#include "provenance.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core;
+using namespace linuxdeploy::core::log;
+using namespace linuxdeploy::plugin::qt;
+
+namespace {
+    struct TraceResult {
+        bool isElfFile = false;
+        std::exception_ptr error;
+    };
+}
+
+std::shared_ptr<ElfDependencyResolver> elfDependencyResolver() {
+    static std::mutex mutex;
+    static std::string currentLdLibraryPath;
+    static std::shared_ptr<ElfDependencyResolver> resolver;
+
+    const auto* ldLibraryPath = getenv("LD_LIBRARY_PATH");
+    const std::string newLdLibraryPath = ldLibraryPath == nullptr ? "" : ldLibraryPath;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // the search path is fixed for a resolver's lifetime, we need a new one whenever $LD_LIBRARY_PATH changes
+    if (resolver == nullptr || newLdLibraryPath != currentLdLibraryPath) {
+        resolver = std::make_shared<ElfDependencyResolver>(newLdLibraryPath);
+        currentLdLibraryPath = newLdLibraryPath;
+    }
+
+    return resolver;
+}
+
+DiskCache& elfDependencyCache() {
+    // there's a set of entries per $LD_LIBRARY_PATH, old ones are evicted
+    static DiskCache cache(DiskCache::defaultDirectory("elf"), 50000);
+    return cache;
+}
+
+std::vector<bf::path> traceDynamicDependencies(const bf::path& path) {
+    auto& cache = elfDependencyCache();
+
+    // the dependencies are resolved through the loader's cache, too
+    static const auto ldSoCacheIdentity = fileIdentity("/etc/ld.so.cache");
+
+    std::string key;
+
+    if (cache.enabled()) {
+        const auto identity = fileIdentity(path);
+
+        if (!identity.empty()) {
+            const auto* ldLibraryPath = getenv("LD_LIBRARY_PATH");
+            key = "elf-dependencies-v3|" + identity + "|" + (ldLibraryPath == nullptr ? "" : ldLibraryPath);
+        }
+    }
+
+    std::string cachedValue;
+
+    if (!key.empty() && cache.lookup(key, cachedValue)) {
+        std::istringstream iss(cachedValue);
+
+        std::string line;
+        std::getline(iss, line);
+
+        // non-ELF files are cached as well, that saves parsing them again
+        if (line != "elf")
+            throw elf::ElfFileParseError("Not an ELF file (cached): " + path.string());
+
+        // the trace is transitive, it's stale once the loader's cache or any of the dependencies has changed
+        bool upToDate = std::getline(iss, line) && line == "ld.so.cache " + ldSoCacheIdentity;
+
+        std::vector<bf::path> dependencies;
+
+        while (upToDate && std::getline(iss, line)) {
+            const auto separator = line.find('\t');
+
+            if (separator == std::string::npos) {
+                upToDate = false;
+                break;
+            }
+
+            dependencies.emplace_back(line.substr(separator + 1));
+            upToDate = fileIdentity(dependencies.back()) == line.substr(0, separator);
+        }
+
+        if (upToDate)
+            return dependencies;
+
+        ldLog() << LD_DEBUG << "Cached dependencies of" << path << "are out of date, tracing again" << std::endl;
+    }
+
+    std::vector<bf::path> dependencies;
+
+    try {
+        dependencies = elfDependencyResolver()->traceDynamicDependencies(path);
+    } catch (const elf::ElfFileParseError&) {
+        if (!key.empty())
+            cache.store(key, "not-elf\n");
+
+        throw;
+    }
+
+    if (!key.empty()) {
+        std::ostringstream value;
+        value << "elf" << std::endl
+              << "ld.so.cache " << ldSoCacheIdentity << std::endl;
+
+        for (const auto& dependency : dependencies) {
+            const auto identity = fileIdentity(dependency);
+
+            // a missing library may show up later on, the trace isn't cached then
+            if (identity.empty()) {
+                key.clear();
+                break;
+            }
+
+            value << identity << '\t' << dependency.string() << std::endl;
+        }
+
+        if (!key.empty())
+            cache.store(key, value.str());
+    }
+
+    return dependencies;
+}
+
+std::set<std::string> traceLibraryNames(const std::vector<bf::path>& paths, unsigned int jobs) {
+    // shared by all workers, deduplicates the names while the workers are still running
+    std::set<std::string> libraryNames;
+    std::mutex libraryNamesMutex;
+
+    // one slot per input path, evaluated in input order once all workers are done
+    std::vector<TraceResult> results(paths.size());
+    std::atomic<size_t> nextIndex(0);
+
+    auto worker = [&paths, &results, &nextIndex, &libraryNames, &libraryNamesMutex]() {
+        for (size_t i = nextIndex++; i < paths.size(); i = nextIndex++) {
+            const auto& path = paths[i];
+            auto& result = results[i];
+
+            std::vector<std::string> names{path.filename().string()};
+
+            try {
+                for (const auto& dependency : traceDynamicDependencies(path))
+                    names.emplace_back(dependency.filename().string());
+
+                result.isElfFile = true;
+            } catch (const elf::ElfFileParseError&) {
+                // reported below
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+
+            auto& provenance = Provenance::instance();
+
+            if (provenance.enabled()) {
+                const auto fileNode = provenance.fileNode(path);
+
+                for (size_t j = 0; j < names.size(); ++j)
+                    provenance.addReason({"library", names[j]}, fileNode, j == 0 ? "found as" : "needed by");
+            }
+
+            std::lock_guard<std::mutex> lock(libraryNamesMutex);
+            libraryNames.insert(names.begin(), names.end());
+        }
+    };
+
+    if (jobs == 0)
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    const auto workersCount = std::min<size_t>(jobs, paths.size());
+
+    if (workersCount <= 1) {
+        worker();
+    } else {
+        ldLog() << LD_DEBUG << "Tracing" << paths.size() << "files using" << workersCount << "threads" << std::endl;
+
+        std::vector<std::thread> workers;
+        workers.reserve(workersCount);
+
+        for (size_t i = 0; i < workersCount; ++i)
+            workers.emplace_back(worker);
+
+        for (auto& thread : workers)
+            thread.join();
+    }
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const auto& result = results[i];
+
+        // errors other than parse errors are fatal, just like in a serial run
+        if (result.error)
+            std::rethrow_exception(result.error);
+
+        if (!result.isElfFile)
+            ldLog() << LD_DEBUG << "Failed to parse file as ELF file:" << paths[i] << std::endl;
+    }
+
+    return libraryNames;
+}
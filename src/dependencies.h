@@ -0,0 +1,53 @@
+// system includes
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+// local includes
+#include "cache.h"
+#include "elf-resolver.h"
+
+#pragma once
+
+/**
+ * Returns the resolver used to trace dependencies in-process. A new resolver is created whenever $LD_LIBRARY_PATH has
+ * changed since the last call.
+ */
+std::shared_ptr<linuxdeploy::plugin::qt::ElfDependencyResolver> elfDependencyResolver();
+
+/**
+ * Returns the persistent cache used to store the results of dependency traces.
+ */
+linuxdeploy::plugin::qt::DiskCache& elfDependencyCache();
+
+/**
+ * Traces the dynamic dependencies of an ELF file. The persistent dependency cache is consulted first, the results are
+ * stored in there after a successful trace.
+ *
+ * Cache entries are keyed by the file's identity (device, inode, size and modification time) and the current value of
+ * $LD_LIBRARY_PATH, which influences how the dependencies are resolved. As the trace covers the dependencies'
+ * dependencies, the identities of the resolved dependencies and of /etc/ld.so.cache are stored along with it, a cached
+ * trace is used only if they still match. Traces with unresolved dependencies aren't cached.
+ *
+ * @param path ELF file to trace
+ * @return paths of the dependencies
+ * @throws linuxdeploy::core::elf::ElfFileParseError if the file is not an ELF file
+ */
+std::vector<boost::filesystem::path> traceDynamicDependencies(const boost::filesystem::path& path);
+
+/**
+ * Traces the dynamic dependencies of the given ELF files, and collects the filenames of the files themselves as well as
+ * the ones of all their dependencies.
+ *
+ * Up to jobs files are traced concurrently (0 means one worker per CPU). Log messages are emitted in the order of the
+ * input paths after all workers have finished, so the output does not depend on thread timing.
+ *
+ * @param paths files to trace
+ * @param jobs maximum number of worker threads
+ * @return set of library filenames
+ */
+std::set<std::string> traceLibraryNames(const std::vector<boost::filesystem::path>& paths, unsigned int jobs = 1);
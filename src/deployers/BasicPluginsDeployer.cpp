@@ -13,7 +13,7 @@ using namespace linuxdeploy::plugin::qt;
 namespace bf = boost::filesystem;
 
 BasicPluginsDeployer::BasicPluginsDeployer(std::string moduleName,
-                                           core::appdir::AppDir& appDir,
+                                           AppDirProxy& appDir,
                                            bf::path qtPluginsPath,
                                            bf::path qtLibexecsPath,
                                            bf::path installLibsPath,
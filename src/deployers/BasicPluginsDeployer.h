@@ -8,6 +8,7 @@
 
 // local headers
 #include "PluginsDeployer.h"
+#include "appdir-proxy.h"
 
 
 namespace linuxdeploy {
@@ -19,7 +20,7 @@ namespace linuxdeploy {
             class BasicPluginsDeployer : public PluginsDeployer {
             protected:
                 std::string moduleName;
-                core::appdir::AppDir& appDir;
+                AppDirProxy& appDir;
 
                 // Qt data
                 const boost::filesystem::path qtPluginsPath;
@@ -34,7 +35,7 @@ namespace linuxdeploy {
                  *
                  * @param moduleName
                  */
-                explicit BasicPluginsDeployer(std::string moduleName, core::appdir::AppDir& appDir,
+                explicit BasicPluginsDeployer(std::string moduleName, AppDirProxy& appDir,
                                               boost::filesystem::path qtPluginsPath,
                                               boost::filesystem::path qtLibexecsPath,
                                               boost::filesystem::path installLibsPath,
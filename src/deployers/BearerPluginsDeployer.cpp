@@ -4,6 +4,7 @@
 
 // local headers
 #include "BearerPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -17,7 +18,7 @@ bool BearerPluginsDeployer::deploy() {
 
     ldLog() << "Deploying bearer plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "bearer"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "bearer", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/bearer/"))
             return false;
     }
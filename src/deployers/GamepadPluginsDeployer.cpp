@@ -4,6 +4,7 @@
 
 // local headers
 #include "GamepadPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -17,7 +18,7 @@ bool GamepadPluginsDeployer::deploy() {
 
     ldLog() << "Deploying Gamepad plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "gamepads"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "gamepads", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/gamepads/"))
             return false;
     }
@@ -4,6 +4,7 @@
 
 // local headers
 #include "MultimediaPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -17,14 +18,14 @@ bool MultimediaPluginsDeployer::deploy() {
 
     ldLog() << "Deploying mediaservice plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "mediaservice"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "mediaservice", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/mediaservice/"))
             return false;
     }
 
     ldLog() << "Deploying audio plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "audio"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "audio", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/audio/"))
             return false;
     }
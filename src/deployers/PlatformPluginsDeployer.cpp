@@ -4,6 +4,7 @@
 
 // local headers
 #include "PlatformPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -20,12 +21,12 @@ bool PlatformPluginsDeployer::deploy() {
     if (!appDir.deployLibrary(qtPluginsPath / "platforms/libqxcb.so", appDir.path() / "usr/plugins/platforms/"))
         return false;
 
-    for (bf::directory_iterator i(qtPluginsPath / "platforminputcontexts"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "platforminputcontexts", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/platforminputcontexts/"))
             return false;
     }
 
-    for (bf::directory_iterator i(qtPluginsPath / "imageformats"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "imageformats", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/imageformats/"))
             return false;
     }
@@ -41,13 +42,13 @@ bool PlatformPluginsDeployer::deploy() {
     if (getenv("DEPLOY_PLATFORM_THEMES") != nullptr) {
         ldLog() << LD_WARNING << "Deploying all platform themes and styles [experimental feature]" << std::endl;
 
-        if (bf::is_directory(platformThemesPath))
-            for (bf::directory_iterator i(platformThemesPath); i != bf::directory_iterator(); ++i)
+        if (fs::isDirectory(platformThemesPath, FS_HERE))
+            for (auto i = fs::directoryIterator(platformThemesPath, FS_HERE); i != bf::directory_iterator(); ++i)
                 if (!appDir.deployLibrary(*i, platformThemesDestination))
                     return false;
 
-        if (bf::is_directory(stylesPath))
-            for (bf::directory_iterator i(stylesPath); i != bf::directory_iterator(); ++i)
+        if (fs::isDirectory(stylesPath, FS_HERE))
+            for (auto i = fs::directoryIterator(stylesPath, FS_HERE); i != bf::directory_iterator(); ++i)
                 if (!appDir.deployLibrary(*i, stylesDestination))
                     return false;
     } else {
@@ -64,14 +65,14 @@ bool PlatformPluginsDeployer::deploy() {
         const auto libqgtk2stylePath = stylesPath / libqgtk2styleFilename;
 
         // we need to check whether the files exist at least, otherwise the deferred deployment operation fails
-        if (bf::is_regular_file(libqgtk2Path)) {
+        if (fs::isRegularFile(libqgtk2Path, FS_HERE)) {
             ldLog() << "Attempting to deploy" << libqgtk2Filename << "found at path" << libqgtk2Path << std::endl;
             appDir.deployFile(libqgtk2Path, platformThemesDestination);
         } else {
             ldLog() << "Could not find" << libqgtk2Filename << "on system, skipping deployment" << std::endl;
         }
 
-        if (bf::is_regular_file(libqgtk2stylePath)) {
+        if (fs::isRegularFile(libqgtk2stylePath, FS_HERE)) {
             ldLog() << "Attempting to deploy" << libqgtk2styleFilename << "found at path" << libqgtk2stylePath << std::endl;
             appDir.deployFile(libqgtk2stylePath, stylesDestination);
         } else {
@@ -1 +1,26 @@
+// system headers
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+#include <typeinfo>
+
+// local headers
 #include "PluginsDeployer.h"
+
+std::string linuxdeploy::plugin::qt::pluginsDeployerName(const PluginsDeployer& deployer) {
+    const auto* const mangledName = typeid(deployer).name();
+
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangledName(
+        abi::__cxa_demangle(mangledName, nullptr, nullptr, &status), std::free
+    );
+
+    std::string name = status == 0 ? demangledName.get() : mangledName;
+
+    // strip namespaces
+    const auto separatorPos = name.rfind("::");
+    if (separatorPos != std::string::npos)
+        name = name.substr(separatorPos + 2);
+
+    return name;
+}
@@ -12,6 +12,11 @@ namespace linuxdeploy {
             public:
                 virtual bool deploy() = 0;
             };
+
+            /**
+             * Returns the class name of a deployer, e.g., PlatformPluginsDeployer, for use in logs and traces.
+             */
+            std::string pluginsDeployerName(const PluginsDeployer& deployer);
         }
     }
 }
@@ -17,7 +17,7 @@ using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::appdir;
 namespace bf = boost::filesystem;
 
-PluginsDeployerFactory::PluginsDeployerFactory(AppDir& appDir,
+PluginsDeployerFactory::PluginsDeployerFactory(AppDirProxy& appDir,
                                                bf::path qtPluginsPath,
                                                bf::path qtLibexecsPath,
                                                bf::path qtInstallQmlPath,
@@ -29,48 +29,70 @@ PluginsDeployerFactory::PluginsDeployerFactory(AppDir& appDir,
                                                                       qtTranslationsPath(std::move(qtTranslationsPath)),
                                                                       qtDataPath(std::move(qtDataPath)) {}
 
-std::vector<std::shared_ptr<PluginsDeployer>> PluginsDeployerFactory::getDeployers(const std::string& moduleName) {
-    if (moduleName == "gui") {
+std::vector<std::shared_ptr<PluginsDeployer>> PluginsDeployerFactory::getDeployers(const QtModuleId module) {
+    // resolved at compile time, comparisons are plain integer comparisons
+    static constexpr QtModuleId gui = qtModuleId("gui");
+    static constexpr QtModuleId opengl = qtModuleId("opengl");
+    static constexpr QtModuleId xcbqpa = qtModuleId("xcbqpa");
+    static constexpr QtModuleId network = qtModuleId("network");
+    static constexpr QtModuleId svg = qtModuleId("svg");
+    static constexpr QtModuleId sql = qtModuleId("sql");
+    static constexpr QtModuleId positioning = qtModuleId("positioning");
+    static constexpr QtModuleId multimedia = qtModuleId("multimedia");
+    static constexpr QtModuleId webenginecore = qtModuleId("webenginecore");
+    static constexpr QtModuleId qml = qtModuleId("qml");
+    static constexpr QtModuleId qt3dquickrender = qtModuleId("3dquickrender");
+    static constexpr QtModuleId gamepad = qtModuleId("gamepad");
+
+    static_assert(gui < QtModulesCount && opengl < QtModulesCount && xcbqpa < QtModulesCount &&
+                  network < QtModulesCount && svg < QtModulesCount && sql < QtModulesCount &&
+                  positioning < QtModulesCount && multimedia < QtModulesCount && webenginecore < QtModulesCount &&
+                  qml < QtModulesCount && qt3dquickrender < QtModulesCount && gamepad < QtModulesCount,
+                  "unknown module name");
+
+    const std::string moduleName = QtModules[module].name;
+
+    if (module == gui) {
         return {getInstance<PlatformPluginsDeployer>(moduleName), getInstance<XcbglIntegrationPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "opengl" || moduleName == "xcbqpa") {
+    if (module == opengl || module == xcbqpa) {
         return {getInstance<XcbglIntegrationPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "network") {
+    if (module == network) {
         return {getInstance<BearerPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "svg") {
+    if (module == svg) {
         return {getInstance<SvgPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "sql") {
+    if (module == sql) {
         return {getInstance<SqlPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "positioning") {
+    if (module == positioning) {
         return {getInstance<PositioningPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "multimedia") {
+    if (module == multimedia) {
         return {getInstance<MultimediaPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "webenginecore") {
+    if (module == webenginecore) {
         return {getInstance<WebEnginePluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "qml") {
+    if (module == qml) {
         return {getInstance<QmlPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "3dquickrender") {
+    if (module == qt3dquickrender) {
         return {getInstance<Qt3DPluginsDeployer>(moduleName)};
     }
 
-    if (moduleName == "gamepad") {
+    if (module == gamepad) {
         return {getInstance<GamepadPluginsDeployer>(moduleName)};
     }
 
@@ -1,14 +1,18 @@
 #pragma once
 
 // system headers
+#include <map>
 #include <memory>
 #include <string>
+#include <typeindex>
+#include <typeinfo>
 
 // library headers
 #include <linuxdeploy/core/appdir.h>
 #include <boost/filesystem.hpp>
 
 // local headers
+#include "qt-modules.h"
 #include "PluginsDeployer.h"
 #include "BasicPluginsDeployer.h"
 
@@ -17,37 +21,50 @@ namespace linuxdeploy {
         namespace qt {
             class PluginsDeployerFactory {
             private:
-                core::appdir::AppDir& appDir;
+                AppDirProxy& appDir;
                 const boost::filesystem::path qtPluginsPath;
                 const boost::filesystem::path qtLibexecsPath;
                 const boost::filesystem::path qtInstallQmlPath;
                 const boost::filesystem::path qtTranslationsPath;
                 const boost::filesystem::path qtDataPath;
 
+                // one instance per deployer type, shared by all modules needing it
+                std::map<std::type_index, std::shared_ptr<PluginsDeployer>> instances;
+
                 template<typename T>
                 std::shared_ptr<PluginsDeployer> getInstance(const std::string& moduleName) {
                     static_assert(std::is_convertible<T*, PluginsDeployer*>::value, "T must inherit PluginsDeployer");
 
-                    return std::make_shared<T>(
-                        moduleName,
-                        appDir,
-                        qtPluginsPath,
-                        qtLibexecsPath,
-                        qtInstallQmlPath,
-                        qtTranslationsPath,
-                        qtDataPath
-                    );
+                    auto& instance = instances[std::type_index(typeid(T))];
+
+                    if (instance == nullptr) {
+                        instance = std::make_shared<T>(
+                            moduleName,
+                            appDir,
+                            qtPluginsPath,
+                            qtLibexecsPath,
+                            qtInstallQmlPath,
+                            qtTranslationsPath,
+                            qtDataPath
+                        );
+                    }
+
+                    return instance;
                 }
 
             public:
-                explicit PluginsDeployerFactory(core::appdir::AppDir& appDir,
+                explicit PluginsDeployerFactory(AppDirProxy& appDir,
                                                 boost::filesystem::path qtPluginsPath,
                                                 boost::filesystem::path qtLibexecsPath,
                                                 boost::filesystem::path qtInstallQmlPath,
                                                 boost::filesystem::path qtTranslationsPath,
                                                 boost::filesystem::path qtDataPath);
 
-                std::vector<std::shared_ptr<PluginsDeployer>> getDeployers(const std::string& moduleName);
+                /**
+                 * Returns the deployers a module needs. Modules needing the same kind of deployer get the same
+                 * instance, which only has to be run once.
+                 */
+                std::vector<std::shared_ptr<PluginsDeployer>> getDeployers(QtModuleId module);
             };
         }
     }
@@ -4,6 +4,7 @@
 
 // local headers
 #include "PositioningPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -17,7 +18,7 @@ bool PositioningPluginsDeployer::deploy() {
 
     ldLog() << "Deploying positioning plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "position"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "position", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/position/"))
             return false;
     }
@@ -17,6 +17,8 @@ bool QmlPluginsDeployer::deploy() {
         deployQml(appDir, qtInstallQmlPath);
     } catch (const QmlImportScannerError &) {
         return false;
+    } catch (const QmlDeploymentError &) {
+        return false;
     }
 
     return true;
@@ -4,6 +4,7 @@
 
 // local headers
 #include "Qt3DPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -17,12 +18,12 @@ bool Qt3DPluginsDeployer::deploy() {
 
     ldLog() << "Deploying Qt 3D plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "geometryloaders"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "geometryloaders", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/geometryloaders/"))
             return false;
     }
 
-    for (bf::directory_iterator i(qtPluginsPath / "sceneparsers"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "sceneparsers", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/sceneparsers/"))
             return false;
     }
@@ -4,6 +4,7 @@
 
 // local headers
 #include "SqlPluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -17,7 +18,7 @@ bool SqlPluginsDeployer::deploy() {
 
     ldLog() << "Deploying SQL plugins" << std::endl;
 
-    for (bf::directory_iterator i(qtPluginsPath / "sqldrivers"); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtPluginsPath / "sqldrivers", FS_HERE); i != bf::directory_iterator(); ++i) {
         if (!appDir.deployLibrary(*i, appDir.path() / "usr/plugins/sqldrivers/"))
             return false;
     }
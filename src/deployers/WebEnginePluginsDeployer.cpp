@@ -5,6 +5,7 @@
 
 // local headers
 #include "WebEnginePluginsDeployer.h"
+#include "fs.h"
 
 using namespace linuxdeploy::plugin::qt;
 using namespace linuxdeploy::core::log;
@@ -20,10 +21,7 @@ bool WebEnginePluginsDeployer::deploy() {
 
     const auto newLibexecPath = appDir.path() / "usr/libexec/";
 
-    // make sure directory is there before trying to write a qt.conf file
-    bf::create_directories(newLibexecPath);
-
-    for (bf::directory_iterator i(qtLibexecsPath); i != bf::directory_iterator(); ++i) {
+    for (auto i = fs::directoryIterator(qtLibexecsPath, FS_HERE); i != bf::directory_iterator(); ++i) {
         auto &entry = *i;
         const std::string prefix = "QtWeb";
 
@@ -43,28 +41,19 @@ bool WebEnginePluginsDeployer::deploy() {
                                  "qtwebengine_resources_200p.pak", "icudtl.dat"}) {
         auto path = qtDataPath / "resources" / fileName;
 
-        if (bf::is_regular_file(path))
+        if (fs::isRegularFile(path, FS_HERE))
             appDir.deployFile(path, appDir.path() / "usr/resources/");
     }
 
-    if (bf::is_directory(qtTranslationsPath / "qtwebengine_locales")) {
-        for (bf::directory_iterator i(qtTranslationsPath / "qtwebengine_locales"); i != bf::directory_iterator(); ++i) {
+    if (fs::isDirectory(qtTranslationsPath / "qtwebengine_locales", FS_HERE)) {
+        for (auto i = fs::directoryIterator(qtTranslationsPath / "qtwebengine_locales", FS_HERE); i != bf::directory_iterator(); ++i) {
             appDir.deployFile(*i, appDir.path() / "usr/translations/qtwebengine_locales/");
         }
     }
 
-    const auto qtConfPath = newLibexecPath / "qt.conf";
-
-    std::ofstream ofs(qtConfPath.string());
-
-    if (!ofs) {
-        ldLog() << LD_ERROR << "Failed to open" << qtConfPath << "for writing" << std::endl;
-        return false;
-    }
-
-    ofs << "# generated by linuxdeploy" << std::endl
-        << "[Paths]" << std::endl
-        << "Prefix = ../" << std::endl;
-
-    return true;
+    // written through the AppDir, so that it ends up in deployment plans
+    return appDir.writeFile(newLibexecPath / "qt.conf",
+                            "# generated by linuxdeploy\n"
+                            "[Paths]\n"
+                            "Prefix = ../\n");
 }
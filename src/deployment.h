@@ -8,28 +8,31 @@
 #include <linuxdeploy/util/util.h>
 
 // local includes
+#include "appdir-proxy.h"
+#include "fs.h"
 #include "qt-modules.h"
 #include "qml.h"
 #include "util.h"
 
 namespace bf = boost::filesystem;
+namespace fs = linuxdeploy::plugin::qt::fs;
 
 using namespace linuxdeploy::core;
 using namespace linuxdeploy::util::misc;
 using namespace linuxdeploy::core::log;
 
 // little helper called by other integration plugins
-inline bool deployIntegrationPlugins(appdir::AppDir& appDir, const bf::path& qtPluginsPath, const std::initializer_list<bf::path>& subDirs) {
+inline bool deployIntegrationPlugins(linuxdeploy::plugin::qt::AppDirProxy& appDir, const bf::path& qtPluginsPath, const std::initializer_list<bf::path>& subDirs) {
     for (const bf::path& subDir : subDirs) {
         // make sure the path ends with a / so that liblinuxdeploy recognize the destination as a directory
         auto dir = qtPluginsPath / subDir / "/";
 
-        if (!bf::is_directory(dir)) {
+        if (!fs::isDirectory(dir, FS_HERE)) {
             ldLog() << "Directory" << dir << "doesn't exist, skipping deployment" << std::endl;
             continue;
         }
 
-        for (bf::directory_iterator i(dir); i != bf::directory_iterator(); ++i) {
+        for (auto i = fs::directoryIterator(dir, FS_HERE); i != bf::directory_iterator(); ++i) {
             // append a trailing slash to make linuxdeploy aware of the destination being a directory
             // otherwise, when the directory doesn't exist, it might just copy all files to files called like
             // destinationDir
@@ -43,10 +46,10 @@ inline bool deployIntegrationPlugins(appdir::AppDir& appDir, const bf::path& qtP
     return true;
 }
 
-inline bool createQtConf(appdir::AppDir &appDir) {
+inline bool createQtConf(linuxdeploy::plugin::qt::AppDirProxy &appDir) {
     auto qtConfPath = appDir.path() / "usr" / "bin" / "qt.conf";
 
-    if (bf::is_regular_file(qtConfPath)) {
+    if (fs::isRegularFile(qtConfPath, FS_HERE)) {
         ldLog() << LD_WARNING << "Overwriting existing qt.conf file:" << qtConfPath << std::endl;
     } else {
         ldLog() << "Creating Qt conf file:" << qtConfPath << std::endl;
@@ -69,17 +72,17 @@ inline bool createQtConf(appdir::AppDir &appDir) {
     return true;
 }
 
-inline bool createAppRunHook(appdir::AppDir &appDir) {
+inline bool createAppRunHook(linuxdeploy::plugin::qt::AppDirProxy &appDir) {
     auto hookPath = appDir.path() / "apprun-hooks" / "linuxdeploy-plugin-qt-hook.sh";
 
     try {
-        bf::create_directories(hookPath.parent_path());
+        fs::createDirectories(hookPath.parent_path(), FS_HERE);
     } catch (const bf::filesystem_error& e) {
         ldLog() << LD_ERROR << "Failed to create hooks directory:" << e.what() << std::endl;
         return false;
     }
 
-    if (bf::is_regular_file(hookPath)) {
+    if (fs::isRegularFile(hookPath, FS_HERE)) {
         ldLog() << LD_WARNING << "Overwriting existing AppRun hook file:" << hookPath << std::endl;
     } else {
         ldLog() << "Creating AppRun hook file:" << hookPath << std::endl;
@@ -107,8 +110,8 @@ inline bool createAppRunHook(appdir::AppDir &appDir) {
 }
 
 inline bool
-deployTranslations(appdir::AppDir &appDir, const bf::path &qtTranslationsPath, const std::vector<QtModule> &modules) {
-    if (qtTranslationsPath.empty() || !bf::is_directory(qtTranslationsPath)) {
+deployTranslations(linuxdeploy::plugin::qt::AppDirProxy &appDir, const bf::path &qtTranslationsPath, const QtModuleSet &modules) {
+    if (qtTranslationsPath.empty() || !fs::isDirectory(qtTranslationsPath, FS_HERE)) {
         ldLog() << LD_WARNING << "Translation directory does not exist, skipping deployment";
         return true;
     }
@@ -124,16 +127,19 @@ deployTranslations(appdir::AppDir &appDir, const bf::path &qtTranslationsPath, c
             bf::basename(fileName).size() <= 6)
             return true;
 
-        for (const auto &module : modules) {
-            if (!module.translationFilePrefix.empty() && strStartsWith(fileName.string(), module.translationFilePrefix))
+        for (QtModuleId module = 0; module < QtModulesCount; ++module) {
+            const auto* prefix = QtModules[module].translationFilePrefix;
+
+            if (modules.test(module) && prefix[0] != '\0' &&
+                strncmp(fileName.c_str(), prefix, strlen(prefix)) == 0)
                 return true;
         }
 
         return false;
     };
 
-    for (bf::directory_iterator i(qtTranslationsPath); i != bf::directory_iterator(); ++i) {
-        if (!bf::is_regular_file(*i))
+    for (auto i = fs::directoryIterator(qtTranslationsPath, FS_HERE); i != bf::directory_iterator(); ++i) {
+        if (!fs::isRegularFile(*i, FS_HERE))
             continue;
 
         const auto fileName = (*i).path().filename();
@@ -143,15 +149,15 @@ deployTranslations(appdir::AppDir &appDir, const bf::path &qtTranslationsPath, c
     }
 
     const auto& appDirTranslationsPath = appDir.path() / "usr/translations";
-    for (auto& i: bf::recursive_directory_iterator(appDir.path())) {
-        if (!bf::is_regular_file(i) || pathContainsFile(appDirTranslationsPath, i))
-            continue;
+    fs::forEachEntryRecursive(appDir.path(), FS_HERE, [&](const bf::directory_entry& i) {
+        if (!fs::isRegularFile(i, FS_HERE) || pathContainsFile(appDirTranslationsPath, i))
+            return;
 
         const auto fileName = i.path().filename();
 
         if (strEndsWith(fileName.string(), ".qm"))
             appDir.createRelativeSymlink(i, appDir.path() / "usr/translations" / fileName);
-    }
+    });
 
     return true;
 }
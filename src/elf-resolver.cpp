@@ -0,0 +1,582 @@
+// system includes
+#include <algorithm>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+// library includes
+#include <linuxdeploy/core/elf.h>
+#include <linuxdeploy/core/log.h>
+#include <linuxdeploy/util/util.h>
+
+// local includes
+#include "elf-resolver.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core;
+using namespace linuxdeploy::core::log;
+
+namespace {
+    /**
+     * Read-only memory mapping of a file, unmapped on destruction.
+     */
+    class MappedFile {
+    public:
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+
+        explicit MappedFile(const bf::path& path) {
+            const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd < 0)
+                throw elf::ElfFileParseError("Could not open file: " + path.string());
+
+            struct stat st{};
+
+            if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < EI_NIDENT) {
+                close(fd);
+                throw elf::ElfFileParseError("Not an ELF file: " + path.string());
+            }
+
+            void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+
+            if (mapping == MAP_FAILED)
+                throw elf::ElfFileParseError("Could not map file: " + path.string());
+
+            data = static_cast<const unsigned char*>(mapping);
+            size = static_cast<size_t>(st.st_size);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            munmap(const_cast<unsigned char*>(data), size);
+        }
+
+        // copies a structure out of the mapping, so alignment doesn't matter
+        template<typename T>
+        bool read(uint64_t offset, T& value) const {
+            if (offset > size || size - offset < sizeof(T))
+                return false;
+
+            memcpy(&value, data + offset, sizeof(T));
+            return true;
+        }
+    };
+
+    /**
+     * Converts values read from an ELF file to host byte order.
+     */
+    class ByteOrder {
+    private:
+        const bool swap;
+
+    public:
+        explicit ByteOrder(bool swap) : swap(swap) {}
+
+        template<typename T>
+        T operator()(T value) const {
+            if (!swap)
+                return value;
+
+            auto* bytes = reinterpret_cast<unsigned char*>(&value);
+            std::reverse(bytes, bytes + sizeof(T));
+            return value;
+        }
+    };
+
+    std::vector<std::string> splitSearchPath(const std::string& value) {
+        std::vector<std::string> rv;
+
+        for (const auto& entry : linuxdeploy::util::split(value, ':')) {
+            if (!entry.empty())
+                rv.emplace_back(entry);
+        }
+
+        return rv;
+    }
+
+    template<typename Ehdr, typename Phdr, typename Dyn>
+    linuxdeploy::plugin::qt::ElfDynamicInfo parseElfFile(const MappedFile& file, const bool swap, const bf::path& path) {
+        const ByteOrder fix(swap);
+
+        Ehdr ehdr{};
+
+        if (!file.read(0, ehdr))
+            throw elf::ElfFileParseError("Truncated ELF header: " + path.string());
+
+        linuxdeploy::plugin::qt::ElfDynamicInfo info;
+        info.elfClass = ehdr.e_ident[EI_CLASS];
+        info.machine = fix(ehdr.e_machine);
+
+        const uint64_t phoff = fix(ehdr.e_phoff);
+        const uint64_t phnum = fix(ehdr.e_phnum);
+        const uint64_t phentsize = fix(ehdr.e_phentsize);
+
+        if (phnum == 0)
+            return info;
+
+        if (phentsize < sizeof(Phdr))
+            throw elf::ElfFileParseError("Invalid program header size: " + path.string());
+
+        std::vector<Phdr> loadSegments;
+        Phdr dynamicSegment{};
+        bool hasDynamicSegment = false;
+
+        for (uint64_t i = 0; i < phnum; ++i) {
+            Phdr phdr{};
+
+            if (!file.read(phoff + i * phentsize, phdr))
+                throw elf::ElfFileParseError("Truncated program headers: " + path.string());
+
+            const auto type = fix(phdr.p_type);
+
+            if (type == PT_LOAD) {
+                loadSegments.push_back(phdr);
+            } else if (type == PT_DYNAMIC) {
+                dynamicSegment = phdr;
+                hasDynamicSegment = true;
+            }
+        }
+
+        // statically linked
+        if (!hasDynamicSegment)
+            return info;
+
+        // the dynamic section refers to the string table by its virtual address
+        auto addressToOffset = [&](uint64_t address, uint64_t& offset) {
+            for (const auto& segment : loadSegments) {
+                const uint64_t vaddr = fix(segment.p_vaddr);
+                const uint64_t filesz = fix(segment.p_filesz);
+
+                if (address >= vaddr && address < vaddr + filesz) {
+                    offset = address - vaddr + fix(segment.p_offset);
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        uint64_t stringTableAddress = 0;
+        uint64_t stringTableSize = 0;
+        std::vector<uint64_t> neededOffsets;
+        std::vector<uint64_t> rpathOffsets;
+        std::vector<uint64_t> runpathOffsets;
+        bool hasSoname = false;
+        uint64_t sonameOffset = 0;
+
+        const uint64_t dynamicOffset = fix(dynamicSegment.p_offset);
+        const uint64_t dynamicCount = fix(dynamicSegment.p_filesz) / sizeof(Dyn);
+
+        for (uint64_t i = 0; i < dynamicCount; ++i) {
+            Dyn dyn{};
+
+            if (!file.read(dynamicOffset + i * sizeof(Dyn), dyn))
+                throw elf::ElfFileParseError("Truncated dynamic section: " + path.string());
+
+            const int64_t tag = fix(dyn.d_tag);
+            const uint64_t value = fix(dyn.d_un.d_val);
+
+            if (tag == DT_NULL)
+                break;
+
+            switch (tag) {
+                case DT_STRTAB:
+                    stringTableAddress = value;
+                    break;
+                case DT_STRSZ:
+                    stringTableSize = value;
+                    break;
+                case DT_NEEDED:
+                    neededOffsets.push_back(value);
+                    break;
+                case DT_RPATH:
+                    rpathOffsets.push_back(value);
+                    break;
+                case DT_RUNPATH:
+                    runpathOffsets.push_back(value);
+                    info.hasRunpath = true;
+                    break;
+                case DT_SONAME:
+                    sonameOffset = value;
+                    hasSoname = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (neededOffsets.empty() && rpathOffsets.empty() && runpathOffsets.empty() && !hasSoname)
+            return info;
+
+        uint64_t stringTableOffset = 0;
+
+        if (!addressToOffset(stringTableAddress, stringTableOffset) || stringTableOffset >= file.size)
+            throw elf::ElfFileParseError("Could not locate dynamic string table: " + path.string());
+
+        const auto stringTableEnd = std::min<uint64_t>(stringTableOffset + stringTableSize, file.size);
+
+        auto getString = [&](uint64_t offset) {
+            const auto begin = stringTableOffset + offset;
+
+            if (begin >= stringTableEnd)
+                throw elf::ElfFileParseError("Invalid string table offset: " + path.string());
+
+            const auto* first = reinterpret_cast<const char*>(file.data + begin);
+            const auto* last = reinterpret_cast<const char*>(file.data + stringTableEnd);
+
+            return std::string(first, std::find(first, last, '\0'));
+        };
+
+        for (const auto offset : neededOffsets)
+            info.needed.emplace_back(getString(offset));
+
+        for (const auto offset : rpathOffsets) {
+            const auto entries = splitSearchPath(getString(offset));
+            info.rpath.insert(info.rpath.end(), entries.begin(), entries.end());
+        }
+
+        for (const auto offset : runpathOffsets) {
+            const auto entries = splitSearchPath(getString(offset));
+            info.runpath.insert(info.runpath.end(), entries.begin(), entries.end());
+        }
+
+        if (hasSoname)
+            info.soname = getString(sonameOffset);
+
+        return info;
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& systemLdSoCache() {
+        static const auto cache = linuxdeploy::plugin::qt::parseLdSoCache("/etc/ld.so.cache");
+        return cache;
+    }
+
+    std::vector<std::string> defaultLibraryDirectories(const linuxdeploy::plugin::qt::ElfDynamicInfo& info) {
+        std::vector<std::string> directories;
+
+        // Debian style multiarch directories are compiled into the loader on those systems
+        std::string triplet;
+
+        switch (info.machine) {
+            case EM_X86_64:
+                triplet = "x86_64-linux-gnu";
+                break;
+            case EM_386:
+                triplet = "i386-linux-gnu";
+                break;
+            case EM_AARCH64:
+                triplet = "aarch64-linux-gnu";
+                break;
+            case EM_ARM:
+                triplet = "arm-linux-gnueabihf";
+                break;
+            default:
+                break;
+        }
+
+        if (!triplet.empty()) {
+            directories.emplace_back("/lib/" + triplet);
+            directories.emplace_back("/usr/lib/" + triplet);
+        }
+
+        if (info.elfClass == ELFCLASS64) {
+            directories.emplace_back("/lib64");
+            directories.emplace_back("/usr/lib64");
+        }
+
+        directories.emplace_back("/lib");
+        directories.emplace_back("/usr/lib");
+
+        return directories;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            struct ElfDependencyResolver::LoadedObject {
+                bf::path path;
+                std::shared_ptr<const ElfDynamicInfo> info;
+
+                // index of the object which caused this one to be loaded, the traced file has no parent
+                size_t parentIndex;
+            };
+
+            ElfDynamicInfo readElfDynamicInfo(const bf::path& path) {
+                MappedFile file(path);
+
+                if (memcmp(file.data, ELFMAG, SELFMAG) != 0)
+                    throw elf::ElfFileParseError("Not an ELF file: " + path.string());
+
+                const auto dataEncoding = file.data[EI_DATA];
+
+                if (dataEncoding != ELFDATA2LSB && dataEncoding != ELFDATA2MSB)
+                    throw elf::ElfFileParseError("Invalid ELF data encoding: " + path.string());
+
+                static const uint16_t byteOrderProbe = 1;
+                const bool hostIsLittleEndian = *reinterpret_cast<const uint8_t*>(&byteOrderProbe) == 1;
+                const bool swap = (dataEncoding == ELFDATA2LSB) != hostIsLittleEndian;
+
+                switch (file.data[EI_CLASS]) {
+                    case ELFCLASS32:
+                        return parseElfFile<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn>(file, swap, path);
+                    case ELFCLASS64:
+                        return parseElfFile<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn>(file, swap, path);
+                    default:
+                        throw elf::ElfFileParseError("Invalid ELF class: " + path.string());
+                }
+            }
+
+            std::vector<std::pair<std::string, std::string>> parseLdSoCache(const bf::path& path) {
+                static const char oldMagic[] = "ld.so-1.7.0";
+                static const char newMagic[] = "glibc-ld.so.cache1.1";
+
+                // struct cache_file_new and struct file_entry_new from glibc's dl-cache.h
+                static const size_t newHeaderSize = 48;
+                static const size_t newEntrySize = 24;
+
+                std::vector<std::pair<std::string, std::string>> entries;
+
+                try {
+                    MappedFile file(path);
+
+                    size_t newHeaderOffset = 0;
+
+                    if (file.size >= sizeof(oldMagic) - 1 && memcmp(file.data, oldMagic, sizeof(oldMagic) - 1) == 0) {
+                        // old format header (magic + nlibs) followed by 12 byte entries, the new format may follow
+                        uint32_t oldCount = 0;
+
+                        if (!file.read(12, oldCount))
+                            return {};
+
+                        const size_t oldEnd = 16 + static_cast<size_t>(oldCount) * 12;
+
+                        // the alignment of the new header depends on the architecture
+                        bool found = false;
+
+                        for (const size_t alignment : {8u, 4u}) {
+                            const auto candidate = (oldEnd + alignment - 1) & ~(alignment - 1);
+
+                            if (candidate + newHeaderSize <= file.size &&
+                                memcmp(file.data + candidate, newMagic, sizeof(newMagic) - 1) == 0) {
+                                newHeaderOffset = candidate;
+                                found = true;
+                                break;
+                            }
+                        }
+
+                        if (!found)
+                            return {};
+                    } else if (file.size < newHeaderSize || memcmp(file.data, newMagic, sizeof(newMagic) - 1) != 0) {
+                        return {};
+                    }
+
+                    uint32_t count = 0;
+                    if (!file.read(newHeaderOffset + 20, count))
+                        return {};
+
+                    // string offsets are relative to the beginning of the new format header
+                    const auto* stringsBase = reinterpret_cast<const char*>(file.data + newHeaderOffset);
+                    const auto stringsSize = file.size - newHeaderOffset;
+
+                    auto getString = [stringsBase, stringsSize](uint32_t offset) {
+                        if (offset >= stringsSize)
+                            return std::string();
+
+                        return std::string(stringsBase + offset,
+                                           std::find(stringsBase + offset, stringsBase + stringsSize, '\0'));
+                    };
+
+                    for (uint32_t i = 0; i < count; ++i) {
+                        const auto entryOffset = newHeaderOffset + newHeaderSize + i * newEntrySize;
+
+                        uint32_t key = 0, value = 0;
+
+                        if (!file.read(entryOffset + 4, key) || !file.read(entryOffset + 8, value))
+                            break;
+
+                        entries.emplace_back(getString(key), getString(value));
+                    }
+                } catch (const elf::ElfFileParseError&) {
+                    ldLog() << LD_DEBUG << "Could not read loader cache:" << path << std::endl;
+                }
+
+                return entries;
+            }
+
+            ElfDependencyResolver::ElfDependencyResolver(const std::string& ldLibraryPath) {
+                // empty entries in $LD_LIBRARY_PATH refer to the current working directory
+                for (const auto& entry : linuxdeploy::util::split(ldLibraryPath, ':'))
+                    libraryPaths.emplace_back(entry.empty() ? "." : entry);
+            }
+
+            std::shared_ptr<const ElfDynamicInfo> ElfDependencyResolver::getInfo(const bf::path& path) {
+                {
+                    std::lock_guard<std::mutex> lock(infoCacheMutex);
+
+                    const auto it = infoCache.find(path.string());
+                    if (it != infoCache.end())
+                        return it->second;
+                }
+
+                std::shared_ptr<const ElfDynamicInfo> info;
+
+                try {
+                    info = std::make_shared<const ElfDynamicInfo>(readElfDynamicInfo(path));
+                } catch (const elf::ElfFileParseError&) {
+                    // cached as nullptr, too
+                }
+
+                std::lock_guard<std::mutex> lock(infoCacheMutex);
+                infoCache.emplace(path.string(), info);
+                return info;
+            }
+
+            bf::path ElfDependencyResolver::findInDirectories(const std::string& name,
+                                                              const std::vector<std::string>& directories,
+                                                              const LoadedObject& owner,
+                                                              const ElfDynamicInfo& requester) {
+                for (auto directory : directories) {
+                    // expand dynamic string tokens (see ld.so(8))
+                    auto replaceToken = [&directory](const std::string& token, const std::string& value) {
+                        for (const auto& variant : {"${" + token + "}", "$" + token}) {
+                            for (auto pos = directory.find(variant); pos != std::string::npos;
+                                 pos = directory.find(variant, pos + value.size())) {
+                                directory.replace(pos, variant.size(), value);
+                            }
+                        }
+                    };
+
+                    if (directory.find('$') != std::string::npos) {
+                        struct utsname uts{};
+                        uname(&uts);
+
+                        replaceToken("ORIGIN", bf::absolute(owner.path).parent_path().string());
+                        replaceToken("LIB", requester.elfClass == ELFCLASS64 ? "lib64" : "lib");
+                        replaceToken("PLATFORM", uts.machine);
+                    }
+
+                    const auto candidate = bf::path(directory) / name;
+                    const auto candidateInfo = getInfo(candidate);
+
+                    if (candidateInfo != nullptr && candidateInfo->elfClass == requester.elfClass &&
+                        candidateInfo->machine == requester.machine)
+                        return candidate;
+                }
+
+                return {};
+            }
+
+            bf::path ElfDependencyResolver::findLibrary(const std::string& name,
+                                                        const std::vector<LoadedObject>& objects,
+                                                        size_t requesterIndex) {
+                const auto& requester = objects[requesterIndex];
+                const auto& requesterInfo = *requester.info;
+
+                // names containing a slash are used as they are
+                if (name.find('/') != std::string::npos)
+                    return getInfo(name) != nullptr ? bf::path(name) : bf::path();
+
+                bf::path rv;
+
+                // DT_RPATH of the requester and the objects which loaded it, but only if it doesn't have a DT_RUNPATH
+                // objects with a DT_RUNPATH don't contribute their DT_RPATH either
+                if (!requesterInfo.hasRunpath) {
+                    for (auto i = requesterIndex; i < objects.size(); i = objects[i].parentIndex) {
+                        const auto& object = objects[i];
+
+                        if (!object.info->hasRunpath) {
+                            rv = findInDirectories(name, object.info->rpath, object, requesterInfo);
+
+                            if (!rv.empty())
+                                return rv;
+                        }
+
+                        if (i == 0)
+                            break;
+                    }
+                }
+
+                rv = findInDirectories(name, libraryPaths, requester, requesterInfo);
+                if (!rv.empty())
+                    return rv;
+
+                rv = findInDirectories(name, requesterInfo.runpath, requester, requesterInfo);
+                if (!rv.empty())
+                    return rv;
+
+                for (const auto& entry : systemLdSoCache()) {
+                    if (entry.first != name)
+                        continue;
+
+                    const auto candidateInfo = getInfo(entry.second);
+
+                    if (candidateInfo != nullptr && candidateInfo->elfClass == requesterInfo.elfClass &&
+                        candidateInfo->machine == requesterInfo.machine)
+                        return entry.second;
+                }
+
+                return findInDirectories(name, defaultLibraryDirectories(requesterInfo), requester, requesterInfo);
+            }
+
+            std::vector<bf::path> ElfDependencyResolver::traceDynamicDependencies(const bf::path& path) {
+                std::vector<LoadedObject> objects;
+                objects.push_back({path, std::make_shared<const ElfDynamicInfo>(readElfDynamicInfo(path)), 0});
+
+                // the loader doesn't load the same library twice, neither by name nor by path
+                std::set<std::string> knownNames;
+                std::set<std::string> knownPaths{path.string()};
+
+                if (!objects.front().info->soname.empty())
+                    knownNames.insert(objects.front().info->soname);
+
+                std::vector<bf::path> dependencies;
+
+                // breadth-first, just like the loader
+                for (size_t i = 0; i < objects.size(); ++i) {
+                    // copy, as objects may be reallocated below
+                    const auto needed = objects[i].info->needed;
+
+                    for (const auto& name : needed) {
+                        if (knownNames.find(name) != knownNames.end())
+                            continue;
+
+                        const auto libraryPath = findLibrary(name, objects, i);
+
+                        knownNames.insert(name);
+
+                        if (libraryPath.empty()) {
+                            ldLog() << LD_DEBUG << "Could not resolve dependency" << name << "of" << objects[i].path
+                                    << std::endl;
+                            dependencies.emplace_back(name);
+                            continue;
+                        }
+
+                        if (!knownPaths.insert(libraryPath.string()).second)
+                            continue;
+
+                        const auto info = getInfo(libraryPath);
+
+                        if (!info->soname.empty())
+                            knownNames.insert(info->soname);
+
+                        objects.push_back({libraryPath, info, i});
+                        dependencies.push_back(libraryPath);
+                    }
+                }
+
+                return dependencies;
+            }
+        }
+    }
+}
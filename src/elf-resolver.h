@@ -0,0 +1,102 @@
+// system includes
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Contents of an ELF file's dynamic section which are relevant for resolving its dependencies.
+             */
+            struct ElfDynamicInfo {
+                // ELFCLASS32 or ELFCLASS64, and the e_machine value, used to skip incompatible libraries
+                uint8_t elfClass = 0;
+                uint16_t machine = 0;
+
+                std::string soname;
+                std::vector<std::string> needed;
+                std::vector<std::string> rpath;
+                std::vector<std::string> runpath;
+
+                // an empty DT_RUNPATH disables DT_RPATH just like a non-empty one, so we need to track it separately
+                bool hasRunpath = false;
+            };
+
+            /**
+             * Reads DT_NEEDED, DT_RPATH, DT_RUNPATH and DT_SONAME from an ELF file by memory-mapping it.
+             * Supports ELF32 and ELF64 files in either byte order. Files without a dynamic section yield an empty
+             * result.
+             *
+             * @throws linuxdeploy::core::elf::ElfFileParseError if the file is not a valid ELF file
+             */
+            ElfDynamicInfo readElfDynamicInfo(const boost::filesystem::path& path);
+
+            /**
+             * Parses the dynamic loader's cache file, as generated by ldconfig.
+             * Supports the "new" format as well as files which contain both the old and the new format.
+             *
+             * @return (library name, path) pairs in the order they are stored in the cache, or an empty list if the
+             * file cannot be read
+             */
+            std::vector<std::pair<std::string, std::string>> parseLdSoCache(const boost::filesystem::path& path);
+
+            /**
+             * In-process replacement for ldd.
+             *
+             * Resolves the dependencies of ELF files with the same search order the dynamic loader uses:
+             * DT_RPATH of the requesting object and the ones of the objects it was loaded by (unless the requesting
+             * object has a DT_RUNPATH), $LD_LIBRARY_PATH, DT_RUNPATH, /etc/ld.so.cache and finally the default
+             * library directories. $ORIGIN, $LIB and $PLATFORM are expanded in DT_RPATH and DT_RUNPATH.
+             * Libraries whose ELF class or machine differ from the requesting object's are skipped.
+             *
+             * Parsed files are kept in memory, so a single instance should be used for many traces. It is safe to
+             * call traceDynamicDependencies from multiple threads concurrently.
+             */
+            class ElfDependencyResolver {
+            private:
+                struct LoadedObject;
+
+                std::vector<std::string> libraryPaths;
+
+                std::mutex infoCacheMutex;
+                std::map<std::string, std::shared_ptr<const ElfDynamicInfo>> infoCache;
+
+                // returns nullptr if the file doesn't exist or isn't an ELF file
+                std::shared_ptr<const ElfDynamicInfo> getInfo(const boost::filesystem::path& path);
+
+                boost::filesystem::path findLibrary(const std::string& name,
+                                                    const std::vector<LoadedObject>& objects, size_t requesterIndex);
+
+                boost::filesystem::path findInDirectories(const std::string& name,
+                                                          const std::vector<std::string>& directories,
+                                                          const LoadedObject& owner, const ElfDynamicInfo& requester);
+
+            public:
+                /**
+                 * @param ldLibraryPath colon separated list of directories, like $LD_LIBRARY_PATH
+                 */
+                explicit ElfDependencyResolver(const std::string& ldLibraryPath);
+
+                /**
+                 * Resolves all direct and indirect dependencies of an ELF file, like ldd does.
+                 * Dependencies which cannot be found are returned as plain filenames.
+                 *
+                 * @param path ELF file to trace
+                 * @return paths of the dependencies, in the order the dynamic loader would load them
+                 * @throws linuxdeploy::core::elf::ElfFileParseError if the file is not a valid ELF file
+                 */
+                std::vector<boost::filesystem::path> traceDynamicDependencies(const boost::filesystem::path& path);
+            };
+        }
+    }
+}
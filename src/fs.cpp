@@ -0,0 +1,164 @@
+// system includes
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "fs.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+
+namespace {
+    typedef std::tuple<const char*, const char*, int> CallKey;
+
+    std::mutex countsMutex;
+    std::map<CallKey, size_t> counts;
+
+    void count(const char* operation, const linuxdeploy::plugin::qt::fs::CallSite& site, size_t calls = 1) {
+        std::lock_guard<std::mutex> lock(countsMutex);
+        counts[CallKey(operation, site.file, site.line)] += calls;
+    }
+
+    // __FILE__ may be an absolute path, only the part below src/ is of interest
+    std::string shortFileName(const char* file) {
+        const std::string path(file);
+        const auto srcPos = path.rfind("src/");
+
+        return srcPos == std::string::npos ? path : path.substr(srcPos + 4);
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace fs {
+                bool exists(const bf::path& path, const CallSite& site) {
+                    count("exists", site);
+                    return bf::exists(path);
+                }
+
+                bool isDirectory(const bf::path& path, const CallSite& site) {
+                    count("is_directory", site);
+                    return bf::is_directory(path);
+                }
+
+                bool isRegularFile(const bf::path& path, const CallSite& site) {
+                    count("is_regular_file", site);
+                    return bf::is_regular_file(path);
+                }
+
+                bool isDirectory(const bf::directory_entry& entry, const CallSite& site) {
+                    count("is_directory (entry)", site);
+                    return bf::is_directory(entry.status());
+                }
+
+                bool isRegularFile(const bf::directory_entry& entry, const CallSite& site) {
+                    count("is_regular_file (entry)", site);
+                    return bf::is_regular_file(entry.status());
+                }
+
+                uintmax_t fileSize(const bf::path& path, const CallSite& site) {
+                    count("file_size", site);
+                    return bf::file_size(path);
+                }
+
+                bool symlinkExists(const bf::path& path, const CallSite& site) {
+                    count("symlink_status", site);
+                    return bf::exists(bf::symlink_status(path));
+                }
+
+                bf::path relative(const bf::path& path, const bf::path& base, const CallSite& site) {
+                    count("relative", site);
+                    return bf::relative(path, base);
+                }
+
+                bool createDirectories(const bf::path& path, const CallSite& site) {
+                    count("create_directories", site);
+                    return bf::create_directories(path);
+                }
+
+                bf::directory_iterator directoryIterator(const bf::path& path, const CallSite& site) {
+                    count("directory_iterator", site);
+                    return bf::directory_iterator(path);
+                }
+
+                void forEachEntryRecursive(const bf::path& path, const CallSite& site,
+                                           const std::function<void(const bf::directory_entry&)>& callback) {
+                    size_t directoriesOpened = 1;
+
+                    for (bf::recursive_directory_iterator i(path); i != bf::recursive_directory_iterator(); ++i) {
+                        // the iterator descends into all directories which aren't symlinks
+                        if (i->symlink_status().type() == bf::directory_file)
+                            ++directoriesOpened;
+
+                        callback(*i);
+                    }
+
+                    count("recursive_directory_iterator", site, directoriesOpened);
+                }
+
+                std::vector<CallCount> callCounts() {
+                    // the same file may show up with different __FILE__ pointers, so merge by name
+                    std::map<std::pair<std::string, std::string>, size_t> merged;
+
+                    {
+                        std::lock_guard<std::mutex> lock(countsMutex);
+
+                        for (const auto& entry : counts) {
+                            const auto& key = entry.first;
+                            const auto site = shortFileName(std::get<1>(key)) + ":" + std::to_string(std::get<2>(key));
+
+                            merged[std::make_pair(std::get<0>(key), site)] += entry.second;
+                        }
+                    }
+
+                    std::vector<CallCount> rv;
+
+                    for (const auto& entry : merged)
+                        rv.push_back({entry.first.first, entry.first.second, entry.second});
+
+                    std::stable_sort(rv.begin(), rv.end(), [](const CallCount& a, const CallCount& b) {
+                        return a.count > b.count;
+                    });
+
+                    return rv;
+                }
+
+                StatsReport::StatsReport(bool enabled) : enabled(enabled) {}
+
+                StatsReport::~StatsReport() {
+                    if (!enabled)
+                        return;
+
+                    const auto calls = callCounts();
+
+                    std::map<std::string, size_t> totals;
+                    size_t total = 0;
+
+                    for (const auto& call : calls) {
+                        totals[call.operation] += call.count;
+                        total += call.count;
+                    }
+
+                    ldLog() << std::endl << "-- Filesystem calls --" << std::endl;
+
+                    for (const auto& operation : totals)
+                        ldLog() << operation.first << LD_NO_SPACE << ":" << operation.second << std::endl;
+
+                    ldLog() << "Total:" << total << std::endl;
+
+                    ldLog() << std::endl << "Call sites:" << std::endl;
+
+                    for (const auto& call : calls)
+                        ldLog() << call.site << call.operation << LD_NO_SPACE << ":" << call.count << std::endl;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+// system includes
+#include <functional>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Thin facade over the boost::filesystem calls the plugin makes itself, counting them by operation and
+             * call site. Makes it possible to see how much metadata I/O a run causes, and where.
+             *
+             * All functions behave like their boost::filesystem counterparts, including throwing on errors. Pass
+             * FS_HERE as call site. Counting is thread-safe.
+             */
+            namespace fs {
+                struct CallSite {
+                    const char* file;
+                    int line;
+                };
+
+                bool exists(const boost::filesystem::path& path, const CallSite& site);
+
+                bool isDirectory(const boost::filesystem::path& path, const CallSite& site);
+
+                bool isRegularFile(const boost::filesystem::path& path, const CallSite& site);
+
+                // the directory_entry overloads may use the file type cached while reading the directory, they are
+                // counted separately
+                bool isDirectory(const boost::filesystem::directory_entry& entry, const CallSite& site);
+
+                bool isRegularFile(const boost::filesystem::directory_entry& entry, const CallSite& site);
+
+                uintmax_t fileSize(const boost::filesystem::path& path, const CallSite& site);
+
+                // like exists(), but doesn't follow symlinks, i.e., is true for dangling symlinks
+                bool symlinkExists(const boost::filesystem::path& path, const CallSite& site);
+
+                boost::filesystem::path relative(const boost::filesystem::path& path,
+                                                 const boost::filesystem::path& base, const CallSite& site);
+
+                bool createDirectories(const boost::filesystem::path& path, const CallSite& site);
+
+                boost::filesystem::directory_iterator directoryIterator(const boost::filesystem::path& path,
+                                                                        const CallSite& site);
+
+                /**
+                 * Calls the callback for all entries below a directory, like iterating over a
+                 * recursive_directory_iterator. Every directory opened on the way is counted.
+                 */
+                void forEachEntryRecursive(const boost::filesystem::path& path, const CallSite& site,
+                                           const std::function<void(const boost::filesystem::directory_entry&)>& callback);
+
+                struct CallCount {
+                    std::string operation;
+
+                    // file:line, relative to the source directory
+                    std::string site;
+
+                    size_t count;
+                };
+
+                /**
+                 * Returns the number of calls per operation and call site, most frequent first.
+                 */
+                std::vector<CallCount> callCounts();
+
+                /**
+                 * Logs the call counts per operation and per call site when destroyed, e.g., at the end of main().
+                 */
+                class StatsReport {
+                private:
+                    const bool enabled;
+
+                public:
+                    explicit StatsReport(bool enabled);
+                    ~StatsReport();
+                };
+            }
+        }
+    }
+}
+
+#define FS_HERE (::linuxdeploy::plugin::qt::fs::CallSite{__FILE__, __LINE__})
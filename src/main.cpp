@@ -1,7 +1,12 @@
 // system includes
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -13,8 +18,23 @@
 #include <linuxdeploy/util/util.h>
 
 // local includes
-#include "qt-modules.h"
+#include "appdir-proxy.h"
+#include "budgets.h"
+#include "cache.h"
+#include "dependencies.h"
+#include "fs.h"
+#include "perf-report.h"
+#include "plan.h"
+#include "plugin-costs.h"
+#include "progress.h"
+#include "provenance.h"
+#include "qml.h"
+#include "qt-install-paths.h"
+#include "qt-module-matcher.h"
+#include "task-pool.h"
+#include "timeline.h"
 #include "util.h"
+#include "workers.h"
 #include "deployment.h"
 #include "deployers/PluginsDeployerFactory.h"
 
@@ -25,6 +45,131 @@ using namespace linuxdeploy::util::misc;
 using namespace linuxdeploy::core::log;
 using namespace linuxdeploy::plugin::qt;
 
+namespace {
+    // deploys a worker's share of the deployment into its staging AppDir, see deployInWorkerProcesses()
+    int runWorkerJob(const bf::path& jobPath) {
+        WorkerJob job;
+
+        if (!readWorkerJob(jobPath, job))
+            return 1;
+
+        appdir::AppDir appDir(job.stagingAppDir);
+        AppDirProxy appDirProxy(appDir);
+
+        if (getenv("DISABLE_COPYRIGHT_FILES_DEPLOYMENT") != nullptr)
+            appDir.setDisableCopyrightFilesDeployment(true);
+
+        // the parent process has scanned the real AppDir for QML imports already, the staging AppDir is empty
+        setQmlImports(job.qmlImports);
+
+        PluginsDeployerFactory deployerFactory(
+            appDirProxy,
+            job.qtPaths["QT_INSTALL_PLUGINS"],
+            job.qtPaths["QT_INSTALL_LIBEXECS"],
+            job.qtPaths["QT_INSTALL_QML"],
+            job.qtPaths["QT_INSTALL_TRANSLATIONS"],
+            job.qtPaths["QT_INSTALL_DATA"]
+        );
+
+        for (const auto& jobDeployer : job.deployers) {
+            const auto module = findQtModuleByName(jobDeployer.first.c_str(), jobDeployer.first.size());
+
+            if (module >= QtModulesCount) {
+                ldLog() << LD_ERROR << "Unknown Qt module in worker job:" << jobDeployer.first << std::endl;
+                return 1;
+            }
+
+            const auto deployers = deployerFactory.getDeployers(module);
+
+            if (jobDeployer.second >= deployers.size()) {
+                ldLog() << LD_ERROR << "Module" << jobDeployer.first << "has no deployer" << jobDeployer.second
+                        << std::endl;
+                return 1;
+            }
+
+            const auto& deployer = deployers[jobDeployer.second];
+
+            ldLog() << "-- Running" << pluginsDeployerName(*deployer) << "for module:" << jobDeployer.first << "--"
+                    << std::endl;
+
+            if (!deployer->deploy())
+                return 1;
+        }
+
+        if (!appDir.executeDeferredOperations()) {
+            ldLog() << LD_ERROR << "Failed to execute deferred operations" << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    // deploys the files listed in a plan written by --plan-only, skipping the analysis
+    int deployFromPlan(const bf::path& appDirPath, const bf::path& planPath, const DeploymentBudgets& budgets) {
+        DeploymentPlan plan;
+
+        if (!readDeploymentPlan(planPath, plan))
+            return 1;
+
+        ldLog() << "Applying deployment plan" << planPath << "with" << plan.files().size() << "files" << std::endl;
+
+        if (!plan.ldLibraryPath().empty()) {
+            setenv("LD_LIBRARY_PATH", plan.ldLibraryPath().c_str(), true);
+            ldLog() << "Using $LD_LIBRARY_PATH from plan:" << plan.ldLibraryPath() << std::endl;
+        }
+
+        appdir::AppDir appDir(appDirPath);
+        AppDirProxy appDirProxy(appDir);
+
+        if (getenv("DISABLE_COPYRIGHT_FILES_DEPLOYMENT") != nullptr) {
+            ldLog() << std::endl << LD_WARNING << "Copyright files deployment disabled" << std::endl;
+            appDir.setDisableCopyrightFilesDeployment(true);
+        }
+
+        {
+            TimelineSpan span("apply deployment plan");
+
+            if (!applyDeploymentPlan(appDirProxy, plan))
+                return 1;
+        }
+
+        ldLog() << std::endl << "-- Executing deferred operations --" << std::endl;
+        {
+            TimelineSpan span("execute deferred operations");
+            DeferredOperationsProgress progress;
+
+            if (!appDir.executeDeferredOperations()) {
+                ldLog() << LD_ERROR << "Failed to execute deferred operations" << std::endl;
+                return 1;
+            }
+        }
+
+        if (!budgets.empty()) {
+            ldLog() << std::endl << "-- Checking deployment budgets --" << std::endl;
+
+            if (!checkDeploymentBudgets(appDirPath, budgets))
+                return 1;
+        }
+
+        ldLog() << std::endl << "-- Creating qt.conf in AppDir --" << std::endl;
+
+        if (!createQtConf(appDirProxy)) {
+            ldLog() << LD_ERROR << "Failed to create qt.conf in AppDir" << std::endl;
+            return 1;
+        }
+
+        ldLog() << std::endl << "-- Creating AppRun hook --" << std::endl;
+
+        if (!createAppRunHook(appDirProxy)) {
+            ldLog() << LD_ERROR << "Failed to create AppRun hook in AppDir" << std::endl;
+            return 1;
+        }
+
+        ldLog() << std::endl << "Done!" << std::endl;
+        return 0;
+    }
+}
+
 
 int main(const int argc, const char *const *const argv) {
     // set up verbose logging if $DEBUG is set
@@ -38,6 +183,66 @@ int main(const int argc, const char *const *const argv) {
     args::ValueFlagList<std::string> extraPlugins(parser, "plugin",
                                                   "Extra Qt plugin to deploy (specified by name, filename or path)",
                                                   {'p', "extra-plugin"});
+    args::ValueFlag<unsigned int> jobs(parser, "jobs",
+                                       "Number of threads used to trace library dependencies and to run the deployers "
+                                       "(0: one per CPU, default: 1)",
+                                       {'j', "jobs"}, 1);
+    args::ValueFlag<unsigned int> workerProcesses(parser, "count",
+                                                  "Number of processes the deployers are run in, each deploying into "
+                                                  "a staging AppDir merged into the AppDir afterwards "
+                                                  "(0: one per CPU, default: 1, i.e., none)",
+                                                  {"worker-processes"}, 1);
+    args::ValueFlag<std::string> workerJob(parser, "path",
+                                           "Run the share of a deployment written to the given file by "
+                                           "--worker-processes (used internally)",
+                                           {"worker-job"});
+    args::ValueFlag<std::string> planOnly(parser, "path",
+                                          "Write the files the deployment would put into the AppDir, with their "
+                                          "source, size and reason, to the given file as JSON, without modifying "
+                                          "the AppDir",
+                                          {"plan-only"});
+    args::ValueFlag<std::string> applyPlan(parser, "path",
+                                           "Deploy the files listed in a plan written by --plan-only, skipping "
+                                           "module detection and qmake",
+                                           {"apply-plan"});
+    args::Flag timings(parser, "", "Print the time spent in each step and the latency hidden by background work",
+                       {"timings"});
+    args::Flag stats(parser, "", "Print the number of filesystem calls made by the plugin, per operation and call site",
+                     {"stats"});
+    args::ValueFlag<std::string> traceFile(parser, "path",
+                                           "Write a trace of the run in Chrome's trace event format to the given file",
+                                           {"trace-file"});
+    args::ValueFlag<std::string> perfReport(parser, "path",
+                                            "Write a JSON summary of phase durations, subprocesses, files deployed "
+                                            "and cache hit rates to the given file",
+                                            {"perf-report"});
+    args::ValueFlag<std::string> compareBaseline(parser, "path",
+                                                 "Compare the run to a report written by --perf-report, and fail if "
+                                                 "it got slower or bigger",
+                                                 {"compare-baseline"});
+    args::ValueFlag<double> regressionThreshold(parser, "percent",
+                                                "Increase counted as a regression by --compare-baseline (default: 10)",
+                                                {"regression-threshold"}, 10);
+    args::ValueFlagList<std::string> budgetSpecifications(parser, "name=limit",
+                                                          "Fail if the AppDir exceeds the given budget after the "
+                                                          "deployment, e.g., total-bytes=200M, files=2000, "
+                                                          "seconds=30, plugin-bytes=20M or "
+                                                          "plugin-bytes:imageformats=5M",
+                                                          {"budget"});
+    args::ValueFlag<std::string> pluginCostReport(parser, "path",
+                                                  "Write the size of every deployed plugin and the libraries it "
+                                                  "pulls in to the given file",
+                                                  {"plugin-cost-report"});
+    args::ValueFlag<int> progressFd(parser, "fd",
+                                    "Write progress events as newline-delimited JSON to the given file descriptor",
+                                    {"progress-fd"});
+    args::ValueFlagList<std::string> explainPaths(parser, "path",
+                                                  "Explain why the given file, relative to the AppDir, was deployed",
+                                                  {"explain"});
+    args::ValueFlag<std::string> provenanceGraph(parser, "path",
+                                                 "Write the graph of why every file was deployed to the given file, "
+                                                 "in DOT format if it ends with .dot, as JSON otherwise",
+                                                 {"provenance-graph"});
 
     args::Flag pluginType(parser, "", "Print plugin type and exit", {"plugin-type"});
     args::Flag pluginApiVersion(parser, "", "Print plugin API version and exit", {"plugin-api-version"});
@@ -59,18 +264,134 @@ int main(const int argc, const char *const *const argv) {
         return 0;
     }
 
+    if (workerJob)
+        return runWorkerJob(workerJob.Get());
+
     if (!appDirPath) {
         ldLog() << LD_ERROR << "--appdir parameter required" << std::endl;
         std::cout << std::endl << parser;
         return 1;
     }
 
-    if (!bf::is_directory(appDirPath.Get())) {
+    if (!fs::isDirectory(appDirPath.Get(), FS_HERE)) {
         ldLog() << LD_ERROR << "No such directory:" << appDirPath.Get() << std::endl;
         return 1;
     }
 
+    DeploymentBudgets budgets;
+
+    {
+        std::vector<std::string> budgetsFromEnv;
+        const auto* const budgetsFromEnvData = getenv("QT_DEPLOYMENT_BUDGETS");
+        if (budgetsFromEnvData != nullptr)
+            budgetsFromEnv = linuxdeploy::util::split(std::string(budgetsFromEnvData), ';');
+
+        // budgets passed on the command line override the ones from the environment
+        const std::vector<std::string> budgetsFromArgs = budgetSpecifications.Get();
+
+        for (const auto& specifications : {budgetsFromEnv, budgetsFromArgs}) {
+            for (const auto& specification : specifications) {
+                if (specification.empty())
+                    continue;
+
+                try {
+                    parseBudget(specification, budgets);
+                } catch (const BudgetError& e) {
+                    ldLog() << LD_ERROR << e.what() << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    TaskPool::instance().start(jobs.Get());
+
+    TimelineReport timelineReport(static_cast<bool>(timings), traceFile.Get());
+    fs::StatsReport statsReport(static_cast<bool>(stats));
+
+    {
+        int fd = -1;
+        const auto* const progressFdFromEnv = getenv("QT_PLUGIN_PROGRESS_FD");
+
+        if (progressFd)
+            fd = progressFd.Get();
+        else if (progressFdFromEnv != nullptr)
+            fd = atoi(progressFdFromEnv);
+
+        if ((progressFd || progressFdFromEnv != nullptr) && !ProgressEvents::instance().open(fd)) {
+            ldLog() << LD_ERROR << "Not an open file descriptor:" << fd << std::endl;
+            return 1;
+        }
+    }
+
+    if (planOnly && applyPlan) {
+        ldLog() << LD_ERROR << "--plan-only and --apply-plan can't be combined" << std::endl;
+        return 1;
+    }
+
+    if (applyPlan)
+        return deployFromPlan(appDirPath.Get(), applyPlan.Get(), budgets);
+
+    // the AppDir's contents are measured before and after the deployment to find out what has been added
+    const bool checkPerf = perfReport || compareBaseline;
+    PerfCounters perfCounters;
+    DirectoryTotals appDirTotalsBefore;
+
+    if (checkPerf)
+        appDirTotalsBefore = measureDirectory(appDirPath.Get());
+
+    // qmake is looked up and queried in the background while the AppDir is scanned, its results are needed only once
+    // the modules to deploy are known
+    // if possible, the Qt paths are read from the installation directly, which is a lot faster than calling qmake,
+    // otherwise the results of previous qmake calls are reused
+    // the task doesn't log, so that its messages don't interleave with the ones of the scan, it returns a message
+    // describing where the paths came from and the warnings of qmake -query and the cache instead
+    DiskCache qmakeCache(DiskCache::defaultDirectory("qmake"));
+
+    auto qmakeFuture = std::async(std::launch::async, [&qmakeCache, &perfCounters]() {
+        TimelineSpan span("find and query qmake", "background");
+
+        std::tuple<bf::path, std::map<std::string, std::string>, std::string, std::vector<std::string>> rv;
+        std::get<0>(rv) = findQmake();
+
+        if (std::get<0>(rv).empty() || !fs::exists(std::get<0>(rv), FS_HERE))
+            return rv;
+
+        bf::path source;
+
+        if (getenv("FORCE_QMAKE_QUERY") == nullptr)
+            std::get<1>(rv) = readQtInstallPaths(std::get<0>(rv), source);
+
+        if (!std::get<1>(rv).empty()) {
+            std::get<2>(rv) = "Read Qt paths from " + source.string() + ", skipped qmake -query";
+            return rv;
+        }
+
+        bool fromCache = false;
+        std::get<1>(rv) = queryQmakeCached(std::get<0>(rv), qmakeCache, fromCache, &std::get<3>(rv));
+
+        if (fromCache) {
+            std::get<2>(rv) = "Using cached qmake -query results";
+            ++perfCounters.qmakeCacheHits;
+        } else {
+            ++perfCounters.qmakeCacheMisses;
+        }
+
+        return rv;
+    });
+
     appdir::AppDir appDir(appDirPath.Get());
+    AppDirProxy appDirProxy(appDir);
+
+    // when planning, the deployers run as usual, but their files are recorded instead of being deployed
+    // the reasons for the files are taken from the provenance scopes
+    DeploymentPlan plan(appDirPath.Get());
+
+    if (planOnly)
+        appDirProxy.planInto(plan);
+
+    if (explainPaths || provenanceGraph || planOnly)
+        Provenance::instance().enable(appDirPath.Get());
 
     // allow disabling copyright files deployment via environment variable
     if (getenv("DISABLE_COPYRIGHT_FILES_DEPLOYMENT") != nullptr) {
@@ -80,15 +401,18 @@ int main(const int argc, const char *const *const argv) {
 
     // check which libraries and plugins the binaries and libraries depend on
     std::set<std::string> libraryNames;
-    for (const auto &path : appDir.listSharedLibraries()) {
-        libraryNames.insert(path.filename().string());
-        try {
-            for (const auto &dependency : elf::ElfFile(path).traceDynamicDependencies()) {
-                libraryNames.insert(dependency.filename().string());
-            }
-        } catch (const elf::ElfFileParseError &e) {
-            ldLog() << LD_DEBUG << "Failed to parse file as ELF file:" << path << std::endl;
-        }
+    {
+        TimelineSpan span("trace AppDir libraries");
+        libraryNames = traceLibraryNames(appDir.listSharedLibraries(), jobs.Get());
+
+        // the executables' dependencies are deployed by linuxdeploy already, but they explain why a module is needed
+        if (Provenance::instance().enabled())
+            traceLibraryNames(appDir.listExecutables(), jobs.Get());
+    }
+
+    if (elfDependencyCache().enabled()) {
+        ldLog() << "ELF dependency cache:" << elfDependencyCache().hits() << "hits,"
+                << elfDependencyCache().misses() << "misses" << std::endl;
     }
 
     {
@@ -99,98 +423,89 @@ int main(const int argc, const char *const *const argv) {
     }
 
     // check for Qt modules
-    std::vector<QtModule> foundQtModules;
-    std::vector<QtModule> extraQtModules;
+    QtModuleSet foundQtModules;
+    QtModuleSet extraQtModules;
+    {
+        TimelineSpan span("detect Qt modules");
 
-    auto matchesQtModule = [](std::string libraryName, const QtModule &module) {
-        // extract filename if argument is path
-        if (bf::is_regular_file(libraryName))
-            libraryName = bf::path(libraryName).filename().string();
+        foundQtModules = findQtModules(libraryNames);
 
-        // adding the trailing dot makes sure e.g., libQt5WebEngineCore won't be matched as webengine and webenginecore
-        const auto &libraryPrefix = module.libraryFilePrefix + ".";
+        std::vector<std::string> extraPluginsFromEnv;
+        const auto* const extraPluginsFromEnvData = getenv("EXTRA_QT_PLUGINS");
+        if (extraPluginsFromEnvData != nullptr)
+            extraPluginsFromEnv = linuxdeploy::util::split(std::string(extraPluginsFromEnvData, ';'));
 
-        // match plugin filename
-        if (strncmp(libraryName.c_str(), libraryPrefix.c_str(), libraryPrefix.size()) == 0) {
-            ldLog() << LD_DEBUG << "-> matches library filename, found module:" << module.name << std::endl;
-            return true;
-        }
+        for (const auto& pluginsList : {static_cast<std::vector<std::string>>(extraPlugins.Get()), extraPluginsFromEnv})
+            extraQtModules |= findQtModulesForArguments(pluginsList);
 
-        // match plugin name
-        if (strcmp(libraryName.c_str(), module.name.c_str()) == 0) {
-            ldLog() << LD_DEBUG << "-> matches module name, found module:" << module.name << std::endl;
-            return true;
-        }
+        auto& provenance = Provenance::instance();
 
-        return false;
-    };
+        if (provenance.enabled()) {
+            for (const auto& libraryName : libraryNames) {
+                const auto module = matchQtModule(libraryName);
 
-    std::copy_if(QtModules.begin(), QtModules.end(), std::back_inserter(foundQtModules),
-                 [&matchesQtModule, &libraryNames](const QtModule &module) {
-                     return std::find_if(libraryNames.begin(), libraryNames.end(),
-                                         [&matchesQtModule, &module](const std::string &libraryName) {
-                                             return matchesQtModule(libraryName, module);
-                                         }) != libraryNames.end();
-                 });
-
-    std::vector<std::string> extraPluginsFromEnv;
-    const auto* const extraPluginsFromEnvData = getenv("EXTRA_QT_PLUGINS");
-    if (extraPluginsFromEnvData != nullptr)
-        extraPluginsFromEnv = linuxdeploy::util::split(std::string(extraPluginsFromEnvData, ';'));
-
-    for (const auto& pluginsList : {static_cast<std::vector<std::string>>(extraPlugins.Get()), extraPluginsFromEnv}) {
-        std::copy_if(QtModules.begin(), QtModules.end(), std::back_inserter(extraQtModules),
-            [&matchesQtModule, &libraryNames, &pluginsList](const QtModule &module) {
-                return std::find_if(pluginsList.begin(), pluginsList.end(),
-                    [&matchesQtModule, &module](const std::string &libraryName) {
-                        return matchesQtModule(libraryName, module);
-                    }) != pluginsList.end();
+                if (module < QtModulesCount && foundQtModules.test(module))
+                    provenance.addReason({"module", QtModules[module].name}, {"library", libraryName}, "detected from");
             }
-        );
-    }
 
-    {
-        std::set<std::string> moduleNames;
-        std::for_each(foundQtModules.begin(), foundQtModules.end(), [&moduleNames](const QtModule &module) {
-            moduleNames.insert(module.name);
-        });
-        ldLog() << "Found Qt modules:" << join(moduleNames) << std::endl;
-    }
+            std::vector<std::string> arguments = extraPlugins.Get();
+            arguments.insert(arguments.end(), extraPluginsFromEnv.begin(), extraPluginsFromEnv.end());
 
-    {
-        std::set<std::string> moduleNames;
-        std::for_each(extraQtModules.begin(), extraQtModules.end(), [&moduleNames](const QtModule &module) {
-            moduleNames.insert(module.name);
-        });
-        ldLog() << "Extra Qt modules:" << join(moduleNames) << std::endl;
+            for (const auto& argument : arguments) {
+                const auto modules = findQtModulesForArguments({argument});
+
+                for (QtModuleId module = 0; module < QtModulesCount; ++module) {
+                    if (modules.test(module))
+                        provenance.addReason({"module", QtModules[module].name}, {"argument", argument},
+                                             "requested by");
+                }
+            }
+        }
     }
 
-    if (foundQtModules.empty() && extraQtModules.empty()) {
+    ldLog() << "Found Qt modules:" << join(qtModuleNames(foundQtModules)) << std::endl;
+    ldLog() << "Extra Qt modules:" << join(qtModuleNames(extraQtModules)) << std::endl;
+
+    if (foundQtModules.none() && extraQtModules.none()) {
         ldLog() << LD_ERROR << "Could not find Qt modules to deploy" << std::endl;
         return 1;
     }
 
-    auto qmakePath = findQmake();
+    bf::path qmakePath;
+    std::map<std::string, std::string> qmakeVars;
+    std::string qtPathsMessage;
+    std::vector<std::string> qmakeWarnings;
+    {
+        TimelineSpan span("wait for qmake", "wait");
+        std::tie(qmakePath, qmakeVars, qtPathsMessage, qmakeWarnings) = qmakeFuture.get();
+    }
+
+    for (const auto& warning : qmakeWarnings)
+        ldLog() << LD_WARNING << warning << std::endl;
+
+    if (getenv("QMAKE"))
+        ldLog() << "Using user specified qmake:" << qmakePath << std::endl;
 
     if (qmakePath.empty()) {
         ldLog() << LD_ERROR << "Could not find qmake, please install or provide path using $QMAKE" << std::endl;
         return 1;
     }
 
-    if (!bf::exists(qmakePath)) {
+    if (!fs::exists(qmakePath, FS_HERE)) {
         ldLog() << LD_ERROR << "No such file or directory:" << qmakePath << std::endl;
         return 1;
     }
 
     ldLog() << "Using qmake:" << qmakePath << std::endl;
 
-    auto qmakeVars = queryQmake(qmakePath);
-
     if (qmakeVars.empty()) {
         ldLog() << LD_ERROR << "Failed to query Qt paths using qmake -query" << std::endl;
         return 1;
     }
 
+    if (!qtPathsMessage.empty())
+        ldLog() << qtPathsMessage << std::endl;
+
     const bf::path qtPluginsPath = qmakeVars["QT_INSTALL_PLUGINS"];
     const bf::path qtLibexecsPath = qmakeVars["QT_INSTALL_LIBEXECS"];
     const bf::path qtDataPath = qmakeVars["QT_INSTALL_DATA"];
@@ -213,12 +528,15 @@ int main(const int argc, const char *const *const argv) {
     ldLog() << "Prepending QT_INSTALL_BINS path to $PATH, new $PATH:" << newPath.str() << std::endl;
 
 
-    auto qtModulesToDeploy = foundQtModules;
-    qtModulesToDeploy.reserve(extraQtModules.size());
-    std::copy(extraQtModules.begin(), extraQtModules.end(), std::back_inserter(qtModulesToDeploy));
+    // modules which are both found and requested explicitly are deployed only once
+    const auto qtModulesToDeploy = foundQtModules | extraQtModules;
+
+    // $PATH is final now, so qmlimportscanner can be looked up while the modules before qml are deployed
+    if (qtModulesToDeploy.test(qtModuleId("qml")))
+        prefetchQmlImportScanner();
 
     PluginsDeployerFactory deployerFactory(
-        appDir,
+        appDirProxy,
         qtPluginsPath,
         qtLibexecsPath,
         qtInstallQmlPath,
@@ -226,38 +544,279 @@ int main(const int argc, const char *const *const argv) {
         qtDataPath
     );
 
-    for (const auto& module : qtModulesToDeploy) {
-        ldLog() << std::endl << "-- Deploying module:" << module.name << "--" << std::endl;
+    // modules needing the same kind of deployer share its instance, which is run for the first of them only
+    std::set<const PluginsDeployer*> deployersRun;
 
-        auto deployers = deployerFactory.getDeployers(module.name);
+    auto recordRepeatedDeployer = [&deployersRun](const PluginsDeployer& deployer, QtModuleId module) {
+        if (deployersRun.insert(&deployer).second)
+            return false;
 
-        for (const auto& deployer : deployers)
-            if (!deployer->deploy())
+        ldLog() << LD_DEBUG << pluginsDeployerName(deployer) << "has run already, skipping" << std::endl;
+        Provenance::instance().addReason({"deployer", pluginsDeployerName(deployer)},
+                                         {"module", QtModules[module].name}, "run for");
+        return true;
+    };
+
+    auto workerProcessesCount = workerProcesses.Get();
+
+    if (workerProcessesCount == 0)
+        workerProcessesCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // the workers would deploy into their staging AppDirs
+    if (planOnly)
+        workerProcessesCount = 1;
+
+    // the workers record neither provenance nor progress events, the graph, the explanations and the remaining work
+    // would miss their files
+    if (workerProcessesCount > 1 && (Provenance::instance().enabled() || ProgressEvents::instance().enabled())) {
+        ldLog() << LD_WARNING << "--explain, --provenance-graph and progress events don't support worker processes,"
+                << "deploying in this process" << std::endl;
+        workerProcessesCount = 1;
+    }
+
+    if (workerProcessesCount > 1) {
+        ldLog() << std::endl << "-- Deploying modules:" << join(qtModuleNames(qtModulesToDeploy)) << "using"
+                << workerProcessesCount << "worker processes --" << std::endl;
+
+        TimelineSpan span("deploy modules");
+
+        // the workers look the deployers up by module and position, they create instances of their own
+        std::vector<WorkerDeployer> deployers;
+        bool haveShardedDeployers = false;
+
+        for (QtModuleId module = 0; module < QtModulesCount; ++module) {
+            if (!qtModulesToDeploy.test(module))
+                continue;
+
+            const auto moduleDeployers = deployerFactory.getDeployers(module);
+
+            for (size_t i = 0; i < moduleDeployers.size(); ++i) {
+                if (recordRepeatedDeployer(*moduleDeployers[i], module))
+                    continue;
+
+                // the QML imports are split between the workers
+                const bool sharded = pluginsDeployerName(*moduleDeployers[i]) == "QmlPluginsDeployer";
+                deployers.push_back({QtModules[module].name, i, sharded});
+                haveShardedDeployers = haveShardedDeployers || sharded;
+            }
+        }
+
+        // qmlimportscanner is run once, here, instead of in every worker
+        std::vector<QmlModuleImport> qmlImports;
+
+        if (haveShardedDeployers) {
+            try {
+                qmlImports = getQmlImports(appDirPath.Get(), qtInstallQmlPath);
+            } catch (const QmlImportScannerError&) {
                 return 1;
+            }
+        }
+
+        if (!deployInWorkerProcesses(appDirPath.Get(), qmakeVars, deployers, workerProcessesCount, qmlImports))
+            return 1;
+    } else if (TaskPool::instance().threadsCount() == 1) {
+        for (QtModuleId module = 0; module < QtModulesCount; ++module) {
+            if (!qtModulesToDeploy.test(module))
+                continue;
+
+            ldLog() << std::endl << "-- Deploying module:" << QtModules[module].name << "--" << std::endl;
+
+            TimelineSpan span(std::string("deploy module ") + QtModules[module].name);
+            ProvenanceScope moduleScope({"module", QtModules[module].name});
+
+            auto deployers = deployerFactory.getDeployers(module);
+
+            for (const auto& deployer : deployers) {
+                if (recordRepeatedDeployer(*deployer, module))
+                    continue;
+
+                TimelineSpan deployerSpan(pluginsDeployerName(*deployer), "deployer");
+                ProvenanceScope deployerScope({"deployer", pluginsDeployerName(*deployer)}, "run for");
+
+                if (!deployer->deploy())
+                    return 1;
+            }
+        }
+    } else {
+        ldLog() << std::endl << "-- Deploying modules:" << join(qtModuleNames(qtModulesToDeploy)) << "using"
+                << TaskPool::instance().threadsCount() << "threads --" << std::endl;
+
+        TimelineSpan span("deploy modules");
+
+        // the deployers in the order of a serial run, their AppDir operations are applied in that order
+        std::vector<std::pair<QtModuleId, std::shared_ptr<PluginsDeployer>>> deployers;
+
+        for (QtModuleId module = 0; module < QtModulesCount; ++module) {
+            if (!qtModulesToDeploy.test(module))
+                continue;
+
+            for (const auto& deployer : deployerFactory.getDeployers(module)) {
+                if (!recordRepeatedDeployer(*deployer, module))
+                    deployers.emplace_back(module, deployer);
+            }
+        }
+
+        std::vector<char> results(deployers.size(), false);
+        std::vector<std::function<void()>> tasks;
+
+        for (size_t i = 0; i < deployers.size(); ++i) {
+            tasks.emplace_back([&appDirProxy, &deployers, &results, i]() {
+                AppDirProxy::Slot slot(appDirProxy, i);
+
+                auto& deployer = *deployers[i].second;
+                const auto deployerName = pluginsDeployerName(deployer);
+
+                TimelineSpan deployerSpan(deployerName, "deployer");
+                ProvenanceScope moduleScope({"module", QtModules[deployers[i].first].name});
+                ProvenanceScope deployerScope({"deployer", deployerName}, "run for");
+
+                results[i] = deployer.deploy();
+            });
+        }
+
+        appDirProxy.beginSequence(deployers.size());
+        TaskPool::instance().runInOrder(tasks);
+
+        if (std::find(results.begin(), results.end(), false) != results.end())
+            return 1;
+    }
+
+    if (appDirProxy.repeatedOperationsCount() > 0) {
+        ldLog() << LD_DEBUG << "Skipped" << appDirProxy.repeatedOperationsCount() << "repeated AppDir operations"
+                << std::endl;
     }
 
     ldLog() << std::endl << "-- Deploying translations --" << std::endl;
-    if (!deployTranslations(appDir, qtTranslationsPath, qtModulesToDeploy)) {
-        ldLog() << LD_ERROR << "Failed to deploy translations" << std::endl;
-        return 1;
+    {
+        TimelineSpan span("deploy translations");
+        ProvenanceScope scope({"step", "deploy translations"});
+
+        if (!deployTranslations(appDirProxy, qtTranslationsPath, qtModulesToDeploy)) {
+            ldLog() << LD_ERROR << "Failed to deploy translations" << std::endl;
+            return 1;
+        }
+    }
+
+    if (planOnly) {
+        ldLog() << std::endl << "-- Writing deployment plan --" << std::endl;
+        TimelineSpan span("write deployment plan");
+
+        plan.add("generated", "", appDirPath.Get() / "usr/bin/qt.conf", "", "step create qt.conf");
+        plan.add("generated", "", appDirPath.Get() / "apprun-hooks/linuxdeploy-plugin-qt-hook.sh", "",
+                 "step create AppRun hook");
+
+        plan.addDependencies(traceDynamicDependencies);
+        plan.setLdLibraryPath(newLibraryPath.str());
+
+        const auto& path = planOnly.Get();
+        std::ofstream ofs(path);
+        ofs << plan.toJson().dump(4) << std::endl;
+
+        if (!ofs) {
+            ldLog() << LD_ERROR << "Failed to write deployment plan to" << path << std::endl;
+            return 1;
+        }
+
+        ldLog() << "Planned" << plan.files().size() << "files," << plan.totalBytes() << "bytes, wrote plan to"
+                << path << std::endl;
+        return 0;
     }
 
     ldLog() << std::endl << "-- Executing deferred operations --" << std::endl;
-    if (!appDir.executeDeferredOperations()) {
-        ldLog() << LD_ERROR << "Failed to execute deferred operations" << std::endl;
-        return 1;
+    {
+        TimelineSpan span("execute deferred operations");
+        DeferredOperationsProgress progress;
+
+        if (!appDir.executeDeferredOperations()) {
+            ldLog() << LD_ERROR << "Failed to execute deferred operations" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!budgets.empty()) {
+        ldLog() << std::endl << "-- Checking deployment budgets --" << std::endl;
+
+        if (!checkDeploymentBudgets(appDirPath.Get(), budgets))
+            return 1;
+    }
+
+    if (pluginCostReport) {
+        ldLog() << std::endl << "-- Computing plugin costs --" << std::endl;
+        TimelineSpan span("compute plugin costs");
+
+        if (!writePluginCostReport(appDirPath.Get(), pluginCostReport.Get()))
+            return 1;
+    }
+
+    if (explainPaths) {
+        ldLog() << std::endl << "-- Explaining deployed files --" << std::endl;
+
+        for (const auto& path : explainPaths.Get()) {
+            std::ostringstream explanation;
+            Provenance::instance().explain(path, explanation);
+
+            std::string line;
+            std::istringstream iss(explanation.str());
+
+            while (std::getline(iss, line))
+                ldLog() << line << std::endl;
+        }
+    }
+
+    if (provenanceGraph) {
+        const auto& path = provenanceGraph.Get();
+        std::ofstream ofs(path);
+
+        if (bf::path(path).extension() == ".dot")
+            Provenance::instance().writeDot(ofs);
+        else
+            ofs << Provenance::instance().toJson().dump(4) << std::endl;
+
+        if (!ofs) {
+            ldLog() << LD_ERROR << "Failed to write provenance graph to" << path << std::endl;
+            return 1;
+        }
+
+        ldLog() << "Wrote provenance graph to" << path << std::endl;
     }
 
     ldLog() << std::endl << "-- Creating qt.conf in AppDir --" << std::endl;
-    if (!createQtConf(appDir)) {
-        ldLog() << LD_ERROR << "Failed to create qt.conf in AppDir" << std::endl;
-        return 1;
+    {
+        TimelineSpan span("create qt.conf");
+
+        if (!createQtConf(appDirProxy)) {
+            ldLog() << LD_ERROR << "Failed to create qt.conf in AppDir" << std::endl;
+            return 1;
+        }
     }
 
     ldLog() << std::endl << "-- Creating AppRun hook --" << std::endl;
-    if (!createAppRunHook(appDir)) {
-        ldLog() << LD_ERROR << "Failed to create AppRun hook in AppDir" << std::endl;
-        return 1;
+    {
+        TimelineSpan span("create AppRun hook");
+
+        if (!createAppRunHook(appDirProxy)) {
+            ldLog() << LD_ERROR << "Failed to create AppRun hook in AppDir" << std::endl;
+            return 1;
+        }
+    }
+
+    if (checkPerf) {
+        ldLog() << std::endl << "-- Checking performance --" << std::endl;
+
+        const auto appDirTotalsAfter = measureDirectory(appDirPath.Get());
+
+        if (appDirTotalsAfter.files > appDirTotalsBefore.files)
+            perfCounters.filesDeployed = appDirTotalsAfter.files - appDirTotalsBefore.files;
+
+        if (appDirTotalsAfter.bytes > appDirTotalsBefore.bytes)
+            perfCounters.bytesWritten = appDirTotalsAfter.bytes - appDirTotalsBefore.bytes;
+
+        perfCounters.elfCacheHits = elfDependencyCache().hits();
+        perfCounters.elfCacheMisses = elfDependencyCache().misses();
+        perfCounters.queues = PipelineStats::instance().queues();
+
+        if (!checkPerformance(perfReport.Get(), compareBaseline.Get(), regressionThreshold.Get() / 100, perfCounters))
+            return 1;
     }
 
     ldLog() << std::endl << "Done!" << std::endl;
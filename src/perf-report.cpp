@@ -0,0 +1,230 @@
+// system includes
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "perf-report.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace nlohmann;
+
+namespace {
+    const int formatVersion = 1;
+
+    // whether qmake -query runs depends on the qmake cache, just like the cache statistics
+    const char* const cacheDependentMetrics[] = {"phaseSeconds/find and query qmake", "subprocesses/totalSeconds"};
+
+    // microsecond resolution is plenty, and keeps the numbers in the report short
+    double toSeconds(linuxdeploy::plugin::qt::Timeline::Clock::duration duration) {
+        return std::round(std::chrono::duration<double>(duration).count() * 1e6) / 1e6;
+    }
+
+    json cacheStatistics(size_t hits, size_t misses) {
+        json rv;
+        rv["hits"] = hits;
+        rv["misses"] = misses;
+        rv["hitRate"] = hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+        return rv;
+    }
+
+    // collects the numbers in a report by their path, e.g., files/bytes
+    void flatten(const json& value, const std::string& path, std::map<std::string, double>& out) {
+        if (value.is_object()) {
+            for (auto it = value.begin(); it != value.end(); ++it)
+                flatten(it.value(), path.empty() ? it.key() : path + "/" + it.key(), out);
+        } else if (value.is_number()) {
+            out[path] = value.get<double>();
+        }
+    }
+
+    std::string formatValue(const std::string& metric, double value) {
+        std::ostringstream oss;
+
+        if (metric.find("Seconds") != std::string::npos)
+            oss << std::fixed << std::setprecision(3) << value << " s";
+        else
+            oss << std::fixed << std::setprecision(0) << value;
+
+        return oss.str();
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            DirectoryTotals measureDirectory(const bf::path& path) {
+                DirectoryTotals totals;
+
+                for (bf::recursive_directory_iterator i(path); i != bf::recursive_directory_iterator(); ++i) {
+                    const auto type = i->symlink_status().type();
+
+                    if (type == bf::regular_file) {
+                        ++totals.files;
+                        totals.bytes += bf::file_size(i->path());
+                    } else if (type == bf::symlink_file) {
+                        ++totals.files;
+                    }
+                }
+
+                return totals;
+            }
+
+            json makePerfReport(const std::vector<Timeline::Span>& spans, Timeline::Clock::time_point start,
+                                Timeline::Clock::time_point end, const PerfCounters& counters) {
+                json phases = json::object();
+                json deployers = json::object();
+                size_t processCount = 0;
+                double processSeconds = 0;
+
+                for (const auto& span : spans) {
+                    const auto duration = toSeconds(span.end - span.start);
+
+                    if (span.category == "phase" || span.category == "wait") {
+                        phases[span.name] = phases.value(span.name, 0.0) + duration;
+                    } else if (span.category == "deployer") {
+                        deployers[span.name] = deployers.value(span.name, 0.0) + duration;
+                    } else if (span.category == "process") {
+                        ++processCount;
+                        processSeconds += duration;
+                    }
+                }
+
+                json report;
+                report["formatVersion"] = formatVersion;
+                report["totalSeconds"] = toSeconds(end - start);
+                report["phaseSeconds"] = phases;
+                report["deployerSeconds"] = deployers;
+                report["subprocesses"]["count"] = processCount;
+                report["subprocesses"]["totalSeconds"] = processSeconds;
+                report["files"]["deployed"] = counters.filesDeployed;
+                report["files"]["bytes"] = counters.bytesWritten;
+                report["caches"]["elfDependencies"] = cacheStatistics(counters.elfCacheHits, counters.elfCacheMisses);
+                report["caches"]["qmakeQuery"] = cacheStatistics(counters.qmakeCacheHits, counters.qmakeCacheMisses);
+
+                for (const auto& queue : counters.queues) {
+                    report["queues"][queue.name] = {
+                        {"capacity", queue.capacity},
+                        {"items", queue.items},
+                        {"maxDepth", queue.maxDepth},
+                        {"averageDepth", queue.averageDepth},
+                        {"pushStallSeconds", queue.pushStallSeconds},
+                        {"popStallSeconds", queue.popStallSeconds},
+                    };
+                }
+
+                return report;
+            }
+
+            std::vector<PerfRegression> comparePerfReports(const json& baseline, const json& current,
+                                                           double threshold, double minSeconds,
+                                                           double minSubprocesses) {
+                std::map<std::string, double> baselineValues;
+                std::map<std::string, double> currentValues;
+                flatten(baseline, "", baselineValues);
+                flatten(current, "", currentValues);
+
+                std::vector<PerfRegression> regressions;
+
+                for (const auto& value : currentValues) {
+                    const auto& metric = value.first;
+
+                    if (metric == "formatVersion" || metric.compare(0, 7, "caches/") == 0 ||
+                        metric.compare(0, 7, "queues/") == 0 ||
+                        std::find(std::begin(cacheDependentMetrics), std::end(cacheDependentMetrics), metric) !=
+                        std::end(cacheDependentMetrics))
+                        continue;
+
+                    const auto baselineValue = baselineValues.find(metric);
+
+                    if (baselineValue == baselineValues.end())
+                        continue;
+
+                    const auto increase = value.second - baselineValue->second;
+
+                    if (increase <= threshold * baselineValue->second)
+                        continue;
+
+                    if (metric.find("Seconds") != std::string::npos && increase <= minSeconds)
+                        continue;
+
+                    if (metric == "subprocesses/count" && increase <= minSubprocesses)
+                        continue;
+
+                    regressions.push_back({metric, baselineValue->second, value.second});
+                }
+
+                return regressions;
+            }
+
+            bool checkPerformance(const std::string& reportPath, const std::string& baselinePath, double threshold,
+                                  const PerfCounters& counters) {
+                const auto& timeline = Timeline::instance();
+                const auto report = makePerfReport(timeline.spans(), timeline.start(), Timeline::Clock::now(),
+                                                   counters);
+
+                if (!reportPath.empty()) {
+                    std::ofstream ofs(reportPath);
+                    ofs << report.dump(4) << std::endl;
+
+                    if (!ofs) {
+                        ldLog() << LD_ERROR << "Failed to write performance report to" << reportPath << std::endl;
+                        return false;
+                    }
+
+                    ldLog() << "Wrote performance report to" << reportPath << std::endl;
+                }
+
+                if (baselinePath.empty())
+                    return true;
+
+                json baseline;
+
+                try {
+                    std::ifstream ifs(baselinePath);
+
+                    if (!ifs)
+                        throw std::invalid_argument("cannot open file");
+
+                    baseline = json::parse(ifs);
+                } catch (const std::exception& e) {
+                    ldLog() << LD_ERROR << "Failed to read baseline" << baselinePath << LD_NO_SPACE << ":" << e.what()
+                            << std::endl;
+                    return false;
+                }
+
+                if (baseline.value("formatVersion", 0) != formatVersion) {
+                    ldLog() << LD_ERROR << "Unsupported baseline format:" << baselinePath << std::endl;
+                    return false;
+                }
+
+                const auto regressions = comparePerfReports(baseline, report, threshold);
+
+                if (regressions.empty()) {
+                    ldLog() << "No regressions compared to baseline" << baselinePath << std::endl;
+                    return true;
+                }
+
+                ldLog() << LD_ERROR << "Regressions compared to baseline" << baselinePath << LD_NO_SPACE << ":"
+                        << std::endl;
+
+                for (const auto& regression : regressions) {
+                    ldLog() << LD_ERROR << regression.metric << LD_NO_SPACE << ":"
+                            << formatValue(regression.metric, regression.baseline) << "->"
+                            << formatValue(regression.metric, regression.current) << std::endl;
+                }
+
+                return false;
+            }
+        }
+    }
+}
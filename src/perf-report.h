@@ -0,0 +1,93 @@
+// system includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <json.hpp>
+
+// local includes
+#include "pipeline.h"
+#include "timeline.h"
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Numbers describing a run which aren't recorded on the timeline.
+             */
+            struct PerfCounters {
+                // files (including symlinks) and bytes added to the AppDir
+                size_t filesDeployed = 0;
+                uintmax_t bytesWritten = 0;
+
+                size_t elfCacheHits = 0;
+                size_t elfCacheMisses = 0;
+
+                // the qmake -query cache is only used if the paths can't be read from the installation directly
+                size_t qmakeCacheHits = 0;
+                size_t qmakeCacheMisses = 0;
+
+                std::vector<QueueStats> queues;
+            };
+
+            struct DirectoryTotals {
+                size_t files = 0;
+                uintmax_t bytes = 0;
+            };
+
+            /**
+             * Counts the regular files and symlinks below a directory, and sums up the sizes of the regular files.
+             */
+            DirectoryTotals measureDirectory(const boost::filesystem::path& path);
+
+            /**
+             * Summarizes a run in a stable JSON format, meant to be stored and compared with later runs.
+             *
+             * Durations are given in seconds, in members whose name contains "Seconds". Phases and waits of the main
+             * thread, as well as deployers, are summed up by name. Keys are sorted, so reports diff well.
+             */
+            nlohmann::json makePerfReport(const std::vector<Timeline::Span>& spans,
+                                          Timeline::Clock::time_point start, Timeline::Clock::time_point end,
+                                          const PerfCounters& counters);
+
+            struct PerfRegression {
+                // path of the value in the report, e.g., phaseSeconds/deploy translations
+                std::string metric;
+
+                double baseline;
+                double current;
+            };
+
+            /**
+             * Compares the numbers in two reports created by makePerfReport(). A number regresses if it grew by more
+             * than threshold, relative to the baseline. Durations also need to have grown by more than minSeconds, so
+             * jitter in short phases doesn't count as a regression.
+             *
+             * Cache statistics aren't compared, they depend on the state of the cache rather than on the code. Neither
+             * are the time spent in subprocesses and in the "find and query qmake" phase, as qmake -query only runs on
+             * a qmake cache miss. For the same reason, the number of subprocesses needs to have grown by more than
+             * minSubprocesses, a run with a cold cache spawns one more than the baseline recorded with a warm one.
+             * Queue statistics aren't compared either, they depend on the scheduling of the threads. Numbers which are
+             * missing in either report are skipped.
+             */
+            std::vector<PerfRegression> comparePerfReports(const nlohmann::json& baseline,
+                                                           const nlohmann::json& current,
+                                                           double threshold, double minSeconds = 0.05,
+                                                           double minSubprocesses = 1);
+
+            /**
+             * Creates the report for the current run, writes it to reportPath and compares it to the report stored at
+             * baselinePath. Either path may be empty. The regressions found are logged.
+             *
+             * @param threshold see comparePerfReports()
+             * @return false if the report couldn't be written, the baseline couldn't be read or a regression was found
+             */
+            bool checkPerformance(const std::string& reportPath, const std::string& baselinePath, double threshold,
+                                  const PerfCounters& counters);
+        }
+    }
+}
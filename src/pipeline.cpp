@@ -0,0 +1,53 @@
+// system includes
+#include <cstdlib>
+
+// local includes
+#include "pipeline.h"
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            size_t pipelineQueueCapacity() {
+                const auto* const capacity = getenv("QT_PLUGIN_QUEUE_CAPACITY");
+
+                if (capacity != nullptr && strtoul(capacity, nullptr, 10) > 0)
+                    return strtoul(capacity, nullptr, 10);
+
+                return 256;
+            }
+
+            PipelineStats& PipelineStats::instance() {
+                static PipelineStats stats;
+                return stats;
+            }
+
+            void PipelineStats::record(const QueueStats& stats) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                for (auto& queue : recordedQueues) {
+                    if (queue.name != stats.name)
+                        continue;
+
+                    const auto items = queue.items + stats.items;
+
+                    if (items > 0)
+                        queue.averageDepth = (queue.averageDepth * queue.items + stats.averageDepth * stats.items) / items;
+
+                    queue.items = items;
+                    queue.capacity = std::max(queue.capacity, stats.capacity);
+                    queue.maxDepth = std::max(queue.maxDepth, stats.maxDepth);
+                    queue.pushStallSeconds += stats.pushStallSeconds;
+                    queue.popStallSeconds += stats.popStallSeconds;
+                    return;
+                }
+
+                recordedQueues.push_back(stats);
+            }
+
+            std::vector<QueueStats> PipelineStats::queues() const {
+                std::lock_guard<std::mutex> lock(mutex);
+                return recordedQueues;
+            }
+        }
+    }
+}
@@ -0,0 +1,231 @@
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * What a queue between two pipeline stages saw, for tuning the pipeline's parameters.
+             */
+            struct QueueStats {
+                std::string name;
+                size_t capacity = 0;
+
+                // number of items pushed
+                size_t items = 0;
+
+                // number of items in the queue, sampled whenever an item is pushed
+                size_t maxDepth = 0;
+                double averageDepth = 0;
+
+                // time the producers were blocked on a full queue, i.e., the next stage was too slow
+                double pushStallSeconds = 0;
+
+                // time the consumers were blocked on an empty queue, i.e., the previous stage was too slow
+                double popStallSeconds = 0;
+            };
+
+            /**
+             * Process-wide record of the stats of all queues, for --timings and --perf-report. Queues with the same
+             * name, e.g., the ones of several runs of a pipeline, are summed up. Recording is thread-safe.
+             */
+            class PipelineStats {
+            private:
+                mutable std::mutex mutex;
+                std::vector<QueueStats> recordedQueues;
+
+                PipelineStats() = default;
+
+            public:
+                static PipelineStats& instance();
+
+                void record(const QueueStats& stats);
+
+                std::vector<QueueStats> queues() const;
+            };
+
+            /**
+             * Capacity of the queues between pipeline stages, $QT_PLUGIN_QUEUE_CAPACITY or 256 by default.
+             */
+            size_t pipelineQueueCapacity();
+
+            /**
+             * Queue connecting two pipeline stages, with any number of producers and consumers. Producers block while
+             * the queue is full, so a slow stage holds up the ones before it instead of letting work pile up.
+             *
+             * The stats are recorded in PipelineStats when the queue is destroyed.
+             */
+            template<typename T>
+            class BoundedQueue {
+            private:
+                typedef std::chrono::steady_clock Clock;
+
+                mutable std::mutex mutex;
+                std::condition_variable notFull;
+                std::condition_variable notEmpty;
+                std::deque<T> items;
+                bool closed;
+
+                QueueStats stats;
+                size_t depthSum;
+
+                static double toSeconds(Clock::duration duration) {
+                    return std::chrono::duration<double>(duration).count();
+                }
+
+            public:
+                BoundedQueue(std::string name, size_t capacity) : closed(false), depthSum(0) {
+                    stats.name = std::move(name);
+                    stats.capacity = capacity == 0 ? 1 : capacity;
+                }
+
+                ~BoundedQueue() {
+                    PipelineStats::instance().record(currentStats());
+                }
+
+                BoundedQueue(const BoundedQueue&) = delete;
+                BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+                /**
+                 * Adds an item, waiting for room if the queue is full.
+                 *
+                 * @return false if the queue has been closed, the item is dropped then
+                 */
+                bool push(T item) {
+                    std::unique_lock<std::mutex> lock(mutex);
+
+                    if (!closed && items.size() >= stats.capacity) {
+                        const auto stallStart = Clock::now();
+                        notFull.wait(lock, [this]() { return closed || items.size() < stats.capacity; });
+                        stats.pushStallSeconds += toSeconds(Clock::now() - stallStart);
+                    }
+
+                    if (closed)
+                        return false;
+
+                    items.push_back(std::move(item));
+
+                    ++stats.items;
+                    depthSum += items.size();
+                    stats.maxDepth = std::max(stats.maxDepth, items.size());
+
+                    notEmpty.notify_one();
+                    return true;
+                }
+
+                /**
+                 * Takes the oldest item, waiting for one if the queue is empty.
+                 *
+                 * @return false once the queue has been closed and all items have been taken
+                 */
+                bool pop(T& item) {
+                    std::unique_lock<std::mutex> lock(mutex);
+
+                    if (!closed && items.empty()) {
+                        const auto stallStart = Clock::now();
+                        notEmpty.wait(lock, [this]() { return closed || !items.empty(); });
+                        stats.popStallSeconds += toSeconds(Clock::now() - stallStart);
+                    }
+
+                    if (items.empty())
+                        return false;
+
+                    item = std::move(items.front());
+                    items.pop_front();
+
+                    notFull.notify_one();
+                    return true;
+                }
+
+                /**
+                 * Signals that no more items will be pushed. The items in the queue can still be taken.
+                 */
+                void close() {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    closed = true;
+                    notFull.notify_all();
+                    notEmpty.notify_all();
+                }
+
+                /**
+                 * Closes the queue and drops the items in it, e.g., because the consumers have failed.
+                 */
+                void abort() {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    closed = true;
+                    items.clear();
+                    notFull.notify_all();
+                    notEmpty.notify_all();
+                }
+
+                QueueStats currentStats() const {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    auto rv = stats;
+                    rv.averageDepth = stats.items == 0 ? 0 : static_cast<double>(depthSum) / stats.items;
+                    return rv;
+                }
+            };
+
+            /**
+             * Bounds how far stages working on numbered items may run ahead of the stage which puts them back in
+             * order, so that the items waiting to be put back in order never exceed the window's capacity.
+             */
+            class SequenceWindow {
+            private:
+                std::mutex mutex;
+                std::condition_variable moved;
+                size_t capacity;
+                size_t next;
+                bool aborted;
+
+            public:
+                explicit SequenceWindow(size_t capacity) : capacity(capacity == 0 ? 1 : capacity), next(0),
+                                                           aborted(false) {}
+
+                SequenceWindow(const SequenceWindow&) = delete;
+                SequenceWindow& operator=(const SequenceWindow&) = delete;
+
+                /**
+                 * Waits until the item may be started, i.e., until it is less than capacity items ahead of the next
+                 * one to be put back in order.
+                 *
+                 * @return false if the window has been aborted
+                 */
+                bool waitFor(size_t sequence) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    moved.wait(lock, [this, sequence]() { return aborted || sequence < next + capacity; });
+                    return !aborted;
+                }
+
+                /**
+                 * Signals that the next item has been put back in order.
+                 */
+                void advance() {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    ++next;
+                    moved.notify_all();
+                }
+
+                void abort() {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    aborted = true;
+                    moved.notify_all();
+                }
+            };
+        }
+    }
+}
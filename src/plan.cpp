@@ -0,0 +1,247 @@
+// system includes
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "appdir-proxy.h"
+#include "fs.h"
+#include "plan.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace nlohmann;
+
+namespace {
+    const int PlanVersion = 1;
+
+    // paths below the AppDir are stored relative to it, so that a plan can be applied to another AppDir
+    bf::path relativeToAppDir(const bf::path& path, const bf::path& appDirPath) {
+        const auto name = path.string();
+
+        // deployers use paths below the AppDir path they were given, which may be relative
+        for (const auto& prefix : {appDirPath.string(), bf::absolute(appDirPath).string()}) {
+            if (!prefix.empty() && name.compare(0, prefix.size() + 1, prefix + "/") == 0)
+                return name.substr(prefix.size() + 1);
+        }
+
+        return path;
+    }
+
+    bf::path resolveInAppDir(const bf::path& path, const bf::path& appDirPath) {
+        return path.is_absolute() ? path : appDirPath / path;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            DeploymentPlan::DeploymentPlan(bf::path appDirPath) : appDirPath(std::move(appDirPath)) {}
+
+            void DeploymentPlan::add(const std::string& operation, const bf::path& source, const bf::path& destination,
+                                     const bf::path& passedDestination, const std::string& reason) {
+                PlannedFile file;
+                file.operation = operation;
+                file.source = relativeToAppDir(source, appDirPath);
+                file.destination = relativeToAppDir(destination, appDirPath);
+                file.passedDestination = relativeToAppDir(passedDestination, appDirPath);
+                file.reason = reason;
+
+                // symlinks take next to no space
+                if (operation != "createRelativeSymlink" && !source.empty() && fs::isRegularFile(source, FS_HERE))
+                    file.bytes = fs::fileSize(source, FS_HERE);
+
+                plannedFiles.push_back(std::move(file));
+            }
+
+            void DeploymentPlan::addWrittenFile(const bf::path& destination, const std::string& contents,
+                                                const std::string& reason) {
+                PlannedFile file;
+                file.operation = "writeFile";
+                file.destination = relativeToAppDir(destination, appDirPath);
+                file.passedDestination = file.destination;
+                file.bytes = contents.size();
+                file.reason = reason;
+                file.contents = contents;
+
+                plannedFiles.push_back(std::move(file));
+            }
+
+            void DeploymentPlan::addDependencies(const std::function<std::vector<bf::path>(const bf::path&)>& trace) {
+                std::set<bf::path> plannedDestinations;
+
+                for (const auto& file : plannedFiles)
+                    plannedDestinations.insert(file.destination);
+
+                // the dependencies are appended while iterating
+                const auto filesCount = plannedFiles.size();
+
+                for (size_t i = 0; i < filesCount; ++i) {
+                    if (plannedFiles[i].operation != "deployLibrary" && plannedFiles[i].operation != "deployExecutable")
+                        continue;
+
+                    const auto source = resolveInAppDir(plannedFiles[i].source, appDirPath);
+                    const auto neededBy = plannedFiles[i].destination;
+
+                    std::vector<bf::path> dependencies;
+
+                    try {
+                        dependencies = trace(source);
+                    } catch (const std::exception& e) {
+                        ldLog() << LD_DEBUG << "Failed to trace dependencies of" << source << LD_NO_SPACE << ":"
+                                << e.what() << std::endl;
+                        continue;
+                    }
+
+                    for (const auto& dependency : dependencies) {
+                        // not found by the resolver, linuxdeploy won't find it either
+                        if (!dependency.is_absolute())
+                            continue;
+
+                        const auto destination = bf::path("usr/lib") / dependency.filename();
+
+                        if (!plannedDestinations.insert(destination).second ||
+                            fs::symlinkExists(appDirPath / destination, FS_HERE))
+                            continue;
+
+                        add("dependency", dependency, destination, "", "needed by file " + neededBy.string());
+                    }
+                }
+            }
+
+            const std::vector<PlannedFile>& DeploymentPlan::files() const {
+                return plannedFiles;
+            }
+
+            void DeploymentPlan::setLdLibraryPath(const std::string& ldLibraryPath) {
+                plannedLdLibraryPath = ldLibraryPath;
+            }
+
+            const std::string& DeploymentPlan::ldLibraryPath() const {
+                return plannedLdLibraryPath;
+            }
+
+            uintmax_t DeploymentPlan::totalBytes() const {
+                uintmax_t rv = 0;
+
+                for (const auto& file : plannedFiles)
+                    rv += file.bytes;
+
+                return rv;
+            }
+
+            json DeploymentPlan::toJson() const {
+                json files = json::array();
+
+                for (const auto& file : plannedFiles) {
+                    json fileJson = {
+                        {"operation", file.operation},
+                        {"source", file.source.string()},
+                        {"destination", file.destination.string()},
+                        {"passedDestination", file.passedDestination.string()},
+                        {"bytes", file.bytes},
+                        {"reason", file.reason},
+                    };
+
+                    if (file.operation == "writeFile")
+                        fileJson["contents"] = file.contents;
+
+                    files.push_back(fileJson);
+                }
+
+                json rv;
+                rv["version"] = PlanVersion;
+                rv["appDir"] = appDirPath.string();
+                rv["ldLibraryPath"] = plannedLdLibraryPath;
+                rv["files"] = files;
+                rv["totals"] = {{"files", plannedFiles.size()}, {"bytes", totalBytes()}};
+                return rv;
+            }
+
+            DeploymentPlan DeploymentPlan::fromJson(const json& json) {
+                if (json.at("version").get<int>() != PlanVersion)
+                    throw std::invalid_argument("unsupported plan version");
+
+                DeploymentPlan plan(json.at("appDir").get<std::string>());
+                plan.plannedLdLibraryPath = json.at("ldLibraryPath").get<std::string>();
+
+                for (const auto& fileJson : json.at("files")) {
+                    PlannedFile file;
+                    file.operation = fileJson.at("operation").get<std::string>();
+                    file.source = fileJson.at("source").get<std::string>();
+                    file.destination = fileJson.at("destination").get<std::string>();
+                    file.passedDestination = fileJson.at("passedDestination").get<std::string>();
+                    file.bytes = fileJson.at("bytes").get<uintmax_t>();
+                    file.reason = fileJson.at("reason").get<std::string>();
+
+                    if (file.operation == "writeFile")
+                        file.contents = fileJson.at("contents").get<std::string>();
+                    plan.plannedFiles.push_back(std::move(file));
+                }
+
+                return plan;
+            }
+
+            bool readDeploymentPlan(const bf::path& path, DeploymentPlan& plan) {
+                try {
+                    std::ifstream ifs(path.string());
+
+                    if (!ifs)
+                        throw std::invalid_argument("cannot open file");
+
+                    plan = DeploymentPlan::fromJson(json::parse(ifs));
+                } catch (const std::exception& e) {
+                    ldLog() << LD_ERROR << "Failed to read deployment plan" << path << LD_NO_SPACE << ":" << e.what()
+                            << std::endl;
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool applyDeploymentPlan(AppDirProxy& appDir, const DeploymentPlan& plan) {
+                const auto appDirPath = appDir.path();
+
+                for (const auto& file : plan.files()) {
+                    const auto source = resolveInAppDir(file.source, appDirPath);
+
+                    // replayed as passed, the operations resolve directories and default locations just like before
+                    const auto destination = file.passedDestination.empty()
+                                             ? bf::path()
+                                             : resolveInAppDir(file.passedDestination, appDirPath);
+
+                    bool success;
+
+                    if (file.operation == "deployLibrary") {
+                        success = appDir.deployLibrary(source, destination);
+                    } else if (file.operation == "deployExecutable") {
+                        success = appDir.deployExecutable(source, destination);
+                    } else if (file.operation == "deployFile") {
+                        success = appDir.deployFile(source, destination);
+                    } else if (file.operation == "createRelativeSymlink") {
+                        success = appDir.createRelativeSymlink(source, destination);
+                    } else if (file.operation == "writeFile") {
+                        success = appDir.writeFile(destination, file.contents);
+                    } else if (file.operation == "dependency" || file.operation == "generated") {
+                        continue;
+                    } else {
+                        ldLog() << LD_ERROR << "Unknown operation in deployment plan:" << file.operation << std::endl;
+                        return false;
+                    }
+
+                    if (!success) {
+                        ldLog() << LD_ERROR << "Failed to" << file.operation << source << "to" << destination
+                                << std::endl;
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+        }
+    }
+}
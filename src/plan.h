@@ -0,0 +1,114 @@
+// system includes
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <json.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            class AppDirProxy;
+
+            /**
+             * A file the deployment would put into the AppDir.
+             */
+            struct PlannedFile {
+                // the AppDirProxy operation, dependency for libraries linuxdeploy deploys along with the ones handed
+                // to it, or generated for the files main() writes after the deployment, qt.conf and the AppRun hook
+                std::string operation;
+
+                // the symlink target for createRelativeSymlink, empty for generated files
+                boost::filesystem::path source;
+
+                // relative to the AppDir
+                boost::filesystem::path destination;
+
+                // the destination exactly as passed to the operation, e.g., a directory ending with a slash, or empty
+                // for a library's default location, relative to the AppDir; that's what is replayed
+                boost::filesystem::path passedDestination;
+
+                uintmax_t bytes = 0;
+
+                // e.g., "deployer SqlPluginsDeployer ← module sql"
+                std::string reason;
+
+                // the file's contents for writeFile
+                std::string contents;
+            };
+
+            /**
+             * The files a deployment would put into the AppDir, in the order they are handed to linuxdeploy, as
+             * recorded by --plan-only and replayed by --apply-plan.
+             */
+            class DeploymentPlan {
+            private:
+                boost::filesystem::path appDirPath;
+                std::vector<PlannedFile> plannedFiles;
+
+                // $LD_LIBRARY_PATH while planning, linuxdeploy needs it to find the Qt libraries
+                std::string plannedLdLibraryPath;
+
+            public:
+                explicit DeploymentPlan(boost::filesystem::path appDirPath = "");
+
+                /**
+                 * Adds a file, measuring the source's size. Destinations below the AppDir are stored relative to it.
+                 *
+                 * @param destination the resolved destination, i.e., the file's path
+                 * @param passedDestination the destination as passed to the operation, empty for files not replayed
+                 */
+                void add(const std::string& operation, const boost::filesystem::path& source,
+                         const boost::filesystem::path& destination, const boost::filesystem::path& passedDestination,
+                         const std::string& reason);
+
+                /**
+                 * Adds a file a deployer writes itself, see AppDirProxy::writeFile(). Its contents are stored in the
+                 * plan, they are written when it is applied.
+                 */
+                void addWrittenFile(const boost::filesystem::path& destination, const std::string& contents,
+                                    const std::string& reason);
+
+                /**
+                 * Adds the dependencies of the planned libraries and executables which aren't in usr/lib yet, nor
+                 * planned to be. Dependencies which can't be resolved are skipped.
+                 *
+                 * linuxdeploy skips the libraries on its excludelist, e.g., glibc, which are counted nevertheless.
+                 *
+                 * @param trace returns the paths of an ELF file's dependencies, see traceDynamicDependencies()
+                 */
+                void addDependencies(const std::function<std::vector<boost::filesystem::path>(
+                    const boost::filesystem::path&)>& trace);
+
+                const std::vector<PlannedFile>& files() const;
+
+                void setLdLibraryPath(const std::string& ldLibraryPath);
+
+                const std::string& ldLibraryPath() const;
+
+                uintmax_t totalBytes() const;
+
+                nlohmann::json toJson() const;
+
+                // throws the JSON library's exceptions if the plan is malformed
+                static DeploymentPlan fromJson(const nlohmann::json& json);
+            };
+
+            // reads a plan written by --plan-only, errors are logged
+            bool readDeploymentPlan(const boost::filesystem::path& path, DeploymentPlan& plan);
+
+            /**
+             * Hands the planned files to the AppDir, in order. Dependencies are left to linuxdeploy, generated files
+             * to the caller.
+             *
+             * @return false if an operation failed
+             */
+            bool applyDeploymentPlan(AppDirProxy& appDir, const DeploymentPlan& plan);
+        }
+    }
+}
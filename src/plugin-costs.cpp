@@ -0,0 +1,335 @@
+// system includes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <zlib.h>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "plugin-costs.h"
+#include "elf-resolver.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace linuxdeploy::plugin::qt;
+using namespace nlohmann;
+
+namespace {
+    // mksquashfs' default block size and gzip compression level, which appimagetool doesn't change
+    const size_t squashfsBlockSize = 128 * 1024;
+    const int squashfsCompressionLevel = 9;
+
+    bool isSharedObject(const bf::path& path) {
+        const auto fileName = path.filename().string();
+        const auto soPos = fileName.find(".so");
+
+        return soPos != std::string::npos &&
+               (soPos + 3 == fileName.size() || fileName[soPos + 3] == '.');
+    }
+
+    std::string formatSize(uintmax_t bytes) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1);
+
+        // most plugins are smaller than a MiB
+        if (bytes < 1024 * 1024)
+            oss << bytes / 1024.0 << " KiB";
+        else
+            oss << bytes / (1024.0 * 1024) << " MiB";
+
+        return oss.str();
+    }
+
+    /**
+     * Follows DT_NEEDED entries to the libraries in the AppDir. Each file is parsed only once.
+     */
+    class ClosureResolver {
+    private:
+        // file name -> canonical path, for all libraries in usr/lib
+        std::map<std::string, bf::path> libraries;
+
+        std::map<bf::path, std::vector<bf::path>> directDependencies;
+
+        const std::vector<bf::path>& getDirectDependencies(const bf::path& path) {
+            const auto it = directDependencies.find(path);
+
+            if (it != directDependencies.end())
+                return it->second;
+
+            std::vector<bf::path> dependencies;
+
+            try {
+                for (const auto& needed : readElfDynamicInfo(path).needed) {
+                    const auto library = libraries.find(needed);
+
+                    // libraries which aren't in the AppDir are provided by the system
+                    if (library != libraries.end())
+                        dependencies.push_back(library->second);
+                }
+            } catch (const std::exception&) {
+                // not an ELF file, e.g., a linker script, so there's nothing to follow
+            }
+
+            return directDependencies[path] = dependencies;
+        }
+
+    public:
+        explicit ClosureResolver(const bf::path& libraryDirectory) {
+            if (!bf::is_directory(libraryDirectory))
+                return;
+
+            for (bf::recursive_directory_iterator i(libraryDirectory); i != bf::recursive_directory_iterator(); ++i) {
+                if (!isSharedObject(i->path()) || !bf::is_regular_file(i->status()))
+                    continue;
+
+                // symlinks like libfoo.so.1 -> libfoo.so.1.2.3 resolve to the file they point to
+                libraries.emplace(i->path().filename().string(), bf::canonical(i->path()));
+            }
+        }
+
+        // returns the canonical paths of all libraries the file needs, directly or indirectly
+        std::set<bf::path> closure(const bf::path& path) {
+            std::set<bf::path> rv;
+            std::vector<bf::path> queue = {path};
+
+            while (!queue.empty()) {
+                const auto current = queue.back();
+                queue.pop_back();
+
+                for (const auto& dependency : getDirectDependencies(current)) {
+                    if (rv.insert(dependency).second)
+                        queue.push_back(dependency);
+                }
+            }
+
+            return rv;
+        }
+    };
+
+    // lists the shared objects below the given directories of the AppDir
+    std::vector<bf::path> findSharedObjects(const bf::path& appDirPath, const std::vector<std::string>& directories) {
+        std::vector<bf::path> rv;
+
+        for (const auto& directory : directories) {
+            if (!bf::is_directory(appDirPath / directory))
+                continue;
+
+            for (bf::recursive_directory_iterator i(appDirPath / directory);
+                 i != bf::recursive_directory_iterator(); ++i) {
+                if (isSharedObject(i->path()) && i->symlink_status().type() == bf::regular_file)
+                    rv.push_back(i->path());
+            }
+        }
+
+        std::sort(rv.begin(), rv.end());
+        return rv;
+    }
+
+    json librariesToJson(const std::vector<LibraryCost>& libraries) {
+        auto rv = json::array();
+
+        for (const auto& library : libraries) {
+            rv.push_back({
+                {"path", library.path.string()},
+                {"bytes", library.bytes},
+                {"estimatedCompressedBytes", library.compressedBytes},
+                {"users", library.users},
+            });
+        }
+
+        return rv;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            uintmax_t estimateCompressedSize(const bf::path& path, size_t maxSampleBlocks) {
+                const auto size = bf::file_size(path);
+
+                if (size == 0)
+                    return 0;
+
+                const auto blocks = (size + squashfsBlockSize - 1) / squashfsBlockSize;
+                const auto step = std::max<uintmax_t>(1, blocks / std::max<size_t>(1, maxSampleBlocks));
+
+                std::ifstream ifs(path.string(), std::ios::binary);
+                std::vector<char> input(squashfsBlockSize);
+                std::vector<Bytef> output(compressBound(squashfsBlockSize));
+
+                uintmax_t sampledBytes = 0;
+                uintmax_t sampledCompressedBytes = 0;
+
+                for (uintmax_t block = 0; block < blocks; block += step) {
+                    ifs.seekg(static_cast<std::streamoff>(block * squashfsBlockSize));
+                    ifs.read(input.data(), input.size());
+
+                    const auto bytesRead = static_cast<uLong>(ifs.gcount());
+                    ifs.clear();
+
+                    if (bytesRead == 0)
+                        break;
+
+                    auto compressedSize = static_cast<uLongf>(output.size());
+
+                    if (compress2(output.data(), &compressedSize, reinterpret_cast<const Bytef*>(input.data()),
+                                  bytesRead, squashfsCompressionLevel) != Z_OK) {
+                        compressedSize = bytesRead;
+                    }
+
+                    sampledBytes += bytesRead;
+                    sampledCompressedBytes += std::min<uintmax_t>(compressedSize, bytesRead);
+                }
+
+                if (sampledBytes == 0)
+                    return size;
+
+                if (sampledBytes == size)
+                    return sampledCompressedBytes;
+
+                return static_cast<uintmax_t>(static_cast<double>(sampledCompressedBytes) * size / sampledBytes);
+            }
+
+            std::vector<PluginCost> computePluginCosts(const bf::path& appDirPath) {
+                const auto canonicalAppDirPath = bf::canonical(appDirPath);
+
+                ClosureResolver resolver(appDirPath / "usr/lib");
+
+                // everything the executables need is deployed regardless of the plugins
+                std::set<bf::path> applicationLibraries;
+
+                if (bf::is_directory(appDirPath / "usr/bin")) {
+                    for (bf::directory_iterator i(appDirPath / "usr/bin"); i != bf::directory_iterator(); ++i) {
+                        if (!bf::is_regular_file(i->status()))
+                            continue;
+
+                        const auto closure = resolver.closure(bf::canonical(i->path()));
+                        applicationLibraries.insert(closure.begin(), closure.end());
+                    }
+                }
+
+                const auto pluginPaths = findSharedObjects(appDirPath, {"usr/plugins", "usr/qml"});
+
+                std::vector<std::set<bf::path>> closures;
+                std::map<bf::path, size_t> users;
+
+                for (const auto& pluginPath : pluginPaths) {
+                    std::set<bf::path> closure;
+
+                    for (const auto& library : resolver.closure(bf::canonical(pluginPath))) {
+                        if (applicationLibraries.count(library) == 0) {
+                            closure.insert(library);
+                            ++users[library];
+                        }
+                    }
+
+                    closures.push_back(closure);
+                }
+
+                std::map<bf::path, LibraryCost> libraryCosts;
+
+                for (const auto& user : users) {
+                    const auto& library = user.first;
+
+                    libraryCosts[library] = {bf::relative(library, canonicalAppDirPath), bf::file_size(library),
+                                             estimateCompressedSize(library), user.second};
+                }
+
+                std::vector<PluginCost> costs;
+
+                for (size_t i = 0; i < pluginPaths.size(); ++i) {
+                    PluginCost cost;
+                    cost.path = bf::relative(pluginPaths[i], appDirPath);
+                    cost.bytes = bf::file_size(pluginPaths[i]);
+                    cost.compressedBytes = estimateCompressedSize(pluginPaths[i]);
+                    cost.exclusiveBytes = cost.bytes;
+                    cost.exclusiveCompressedBytes = cost.compressedBytes;
+
+                    for (const auto& library : closures[i]) {
+                        const auto& libraryCost = libraryCosts[library];
+
+                        if (libraryCost.users == 1) {
+                            cost.exclusiveLibraries.push_back(libraryCost);
+                            cost.exclusiveBytes += libraryCost.bytes;
+                            cost.exclusiveCompressedBytes += libraryCost.compressedBytes;
+                        } else {
+                            cost.sharedLibraries.push_back(libraryCost);
+                            cost.sharedBytes += libraryCost.bytes / libraryCost.users;
+                            cost.sharedCompressedBytes += libraryCost.compressedBytes / libraryCost.users;
+                        }
+                    }
+
+                    costs.push_back(cost);
+                }
+
+                std::stable_sort(costs.begin(), costs.end(), [](const PluginCost& a, const PluginCost& b) {
+                    if (a.exclusiveBytes != b.exclusiveBytes)
+                        return a.exclusiveBytes > b.exclusiveBytes;
+
+                    return a.sharedBytes > b.sharedBytes;
+                });
+
+                return costs;
+            }
+
+            json makePluginCostReport(const std::vector<PluginCost>& costs) {
+                auto plugins = json::array();
+
+                for (const auto& cost : costs) {
+                    plugins.push_back({
+                        {"path", cost.path.string()},
+                        {"bytes", cost.bytes},
+                        {"estimatedCompressedBytes", cost.compressedBytes},
+                        {"exclusiveBytes", cost.exclusiveBytes},
+                        {"exclusiveEstimatedCompressedBytes", cost.exclusiveCompressedBytes},
+                        {"sharedBytes", cost.sharedBytes},
+                        {"sharedEstimatedCompressedBytes", cost.sharedCompressedBytes},
+                        {"exclusiveLibraries", librariesToJson(cost.exclusiveLibraries)},
+                        {"sharedLibraries", librariesToJson(cost.sharedLibraries)},
+                    });
+                }
+
+                json report;
+                report["formatVersion"] = 1;
+                report["plugins"] = plugins;
+                return report;
+            }
+
+            bool writePluginCostReport(const bf::path& appDirPath, const std::string& reportPath) {
+                const auto costs = computePluginCosts(appDirPath);
+
+                for (const auto& cost : costs) {
+                    ldLog() << cost.path.string() << LD_NO_SPACE << ":" << formatSize(cost.exclusiveBytes)
+                            << "exclusive (" << LD_NO_SPACE << formatSize(cost.exclusiveCompressedBytes)
+                            << "compressed)," << formatSize(cost.sharedBytes) << "shared (" << LD_NO_SPACE
+                            << formatSize(cost.sharedCompressedBytes) << "compressed)" << std::endl;
+
+                    for (const auto& library : cost.exclusiveLibraries)
+                        ldLog() << "  needs" << library.path.string() << "(" << LD_NO_SPACE << formatSize(library.bytes)
+                                << LD_NO_SPACE << ")" << std::endl;
+
+                    for (const auto& library : cost.sharedLibraries)
+                        ldLog() << "  shares" << library.path.string() << "with" << library.users - 1 << "other(s) ("
+                                << LD_NO_SPACE << formatSize(library.bytes) << LD_NO_SPACE << ")" << std::endl;
+                }
+
+                std::ofstream ofs(reportPath);
+                ofs << makePluginCostReport(costs).dump(4) << std::endl;
+
+                if (!ofs) {
+                    ldLog() << LD_ERROR << "Failed to write plugin cost report to" << reportPath << std::endl;
+                    return false;
+                }
+
+                ldLog() << "Wrote plugin cost report to" << reportPath << std::endl;
+                return true;
+            }
+        }
+    }
+}
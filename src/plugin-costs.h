@@ -0,0 +1,77 @@
+// system includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <json.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Estimates the size of a file in a squashfs image, as created by appimagetool: the file is compressed
+             * with zlib in 128 KiB blocks, blocks which don't get smaller are stored uncompressed.
+             *
+             * Large files are estimated from up to maxSampleBlocks blocks spread evenly over the file.
+             */
+            uintmax_t estimateCompressedSize(const boost::filesystem::path& path, size_t maxSampleBlocks = 16);
+
+            struct LibraryCost {
+                // relative to the AppDir
+                boost::filesystem::path path;
+
+                uintmax_t bytes;
+                uintmax_t compressedBytes;
+
+                // number of plugins whose dependency closure contains the library
+                size_t users;
+            };
+
+            /**
+             * What a plugin costs in the AppDir: the plugin itself, the libraries only it needs, and its share of
+             * the libraries it needs along with other plugins. Libraries the application's executables need aren't
+             * attributed to plugins, they'd be deployed anyway.
+             */
+            struct PluginCost {
+                // relative to the AppDir
+                boost::filesystem::path path;
+
+                uintmax_t bytes = 0;
+                uintmax_t compressedBytes = 0;
+
+                std::vector<LibraryCost> exclusiveLibraries;
+                std::vector<LibraryCost> sharedLibraries;
+
+                // the plugin and its exclusive libraries, i.e., what excluding the plugin saves
+                uintmax_t exclusiveBytes = 0;
+                uintmax_t exclusiveCompressedBytes = 0;
+
+                // the sizes of the shared libraries divided by their number of users
+                uintmax_t sharedBytes = 0;
+                uintmax_t sharedCompressedBytes = 0;
+            };
+
+            /**
+             * Computes the dependency closure of every plugin in usr/plugins and usr/qml, following DT_NEEDED to the
+             * libraries in usr/lib, and attributes the libraries to the plugins needing them. Libraries outside the
+             * AppDir aren't deployed, so they don't cost anything.
+             *
+             * @return plugins sorted by what excluding them would save, most expensive first
+             */
+            std::vector<PluginCost> computePluginCosts(const boost::filesystem::path& appDirPath);
+
+            nlohmann::json makePluginCostReport(const std::vector<PluginCost>& costs);
+
+            /**
+             * Computes the plugin costs of an AppDir, logs them and writes the report to reportPath.
+             *
+             * @return false if the report couldn't be written
+             */
+            bool writePluginCostReport(const boost::filesystem::path& appDirPath, const std::string& reportPath);
+        }
+    }
+}
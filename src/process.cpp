@@ -0,0 +1,202 @@
+// system includes
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// local includes
+#include "process.h"
+#include "progress.h"
+#include "timeline.h"
+
+extern char** environ;
+
+namespace {
+    /**
+     * Pipe whose ends are closed on destruction. Both ends are close-on-exec, so processes spawned concurrently by
+     * other threads don't inherit them.
+     */
+    class Pipe {
+    public:
+        int fds[2] = {-1, -1};
+
+        Pipe() {
+            if (pipe2(fds, O_CLOEXEC) != 0)
+                throw ProcessError(std::string("Failed to create pipe: ") + strerror(errno));
+        }
+
+        Pipe(const Pipe&) = delete;
+        Pipe& operator=(const Pipe&) = delete;
+
+        ~Pipe() {
+            closeEnd(0);
+            closeEnd(1);
+        }
+
+        void closeEnd(int end) {
+            if (fds[end] >= 0) {
+                close(fds[end]);
+                fds[end] = -1;
+            }
+        }
+    };
+
+    // reads from both pipes until both have been closed by the process
+    void drainOutput(Pipe& stdoutPipe, Pipe& stderrPipe, const OutputCallback& onStdout,
+                     const OutputCallback& onStderr) {
+        pollfd fds[2] = {{stdoutPipe.fds[0], POLLIN, 0}, {stderrPipe.fds[0], POLLIN, 0}};
+        const OutputCallback* callbacks[2] = {&onStdout, &onStderr};
+
+        int openStreams = 2;
+        char buffer[64 * 1024];
+
+        while (openStreams > 0) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                throw ProcessError(std::string("Failed to read process output: ") + strerror(errno));
+            }
+
+            for (int i = 0; i < 2; ++i) {
+                if (fds[i].fd < 0 || fds[i].revents == 0)
+                    continue;
+
+                const auto bytesRead = read(fds[i].fd, buffer, sizeof(buffer));
+
+                if (bytesRead < 0 && errno == EINTR)
+                    continue;
+
+                const auto& callback = *callbacks[i];
+
+                if (bytesRead <= 0) {
+                    // negative descriptors are ignored by poll, the pipe itself is closed by its owner
+                    fds[i].fd = -1;
+                    --openStreams;
+
+                    if (callback)
+                        callback(buffer, 0);
+
+                    continue;
+                }
+
+                if (callback)
+                    callback(buffer, static_cast<size_t>(bytesRead));
+            }
+        }
+    }
+
+    int waitForExit(pid_t pid, ProcessResources* resources = nullptr) {
+        int status = 0;
+        rusage usage{};
+
+        while (wait4(pid, &status, 0, &usage) < 0) {
+            if (errno != EINTR)
+                throw ProcessError(std::string("Failed to wait for process: ") + strerror(errno));
+        }
+
+        if (resources != nullptr) {
+            resources->maxResidentSetKb = usage.ru_maxrss;
+            resources->userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+            resources->systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        }
+
+        if (WIFSIGNALED(status))
+            return 128 + WTERMSIG(status);
+
+        return WEXITSTATUS(status);
+    }
+}
+
+int runProcess(const std::vector<std::string>& args, const OutputCallback& onStdout, const OutputCallback& onStderr,
+               ProcessResources* resources) {
+    if (args.empty())
+        throw ProcessError("No command given");
+
+    std::string commandLine;
+    for (const auto& arg : args)
+        commandLine += (commandLine.empty() ? "" : " ") + arg;
+
+    using namespace linuxdeploy::plugin::qt;
+
+    TimelineSpan span(args[0].substr(args[0].find_last_of('/') + 1), "process", commandLine);
+
+    Pipe stdoutPipe;
+    Pipe stderrPipe;
+
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&fileActions, stdoutPipe.fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&fileActions, stderrPipe.fds[1], STDERR_FILENO);
+
+    std::vector<char*> argv;
+    for (const auto& arg : args)
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    const auto error = posix_spawnp(&pid, argv[0], &fileActions, nullptr, argv.data(), environ);
+
+    posix_spawn_file_actions_destroy(&fileActions);
+
+    if (error != 0)
+        throw ProcessError("Failed to run " + args[0] + ": " + strerror(error));
+
+    const auto start = Timeline::Clock::now();
+    auto& progressEvents = ProgressEvents::instance();
+    progressEvents.processStarted(pid, commandLine);
+
+    const auto exited = [&](int exitCode) {
+        const auto seconds = std::chrono::duration<double>(Timeline::Clock::now() - start).count();
+        progressEvents.processExited(pid, commandLine, exitCode, seconds);
+        return exitCode;
+    };
+
+    // the process holds the write ends now, the pipes are closed once it exits
+    stdoutPipe.closeEnd(1);
+    stderrPipe.closeEnd(1);
+
+    try {
+        drainOutput(stdoutPipe, stderrPipe, onStdout, onStderr);
+    } catch (...) {
+        // don't leave a zombie behind, closing the pipes makes the process fail on its next write
+        stdoutPipe.closeEnd(0);
+        stderrPipe.closeEnd(0);
+        exited(waitForExit(pid));
+        throw;
+    }
+
+    return exited(waitForExit(pid, resources));
+}
+
+OutputCallback forEachLine(std::function<void(const std::string& line)> callback) {
+    auto pending = std::make_shared<std::string>();
+
+    return [callback, pending](const char* data, size_t size) {
+        if (size == 0) {
+            if (!pending->empty())
+                callback(*pending);
+
+            pending->clear();
+            return;
+        }
+
+        pending->append(data, size);
+
+        size_t lineStart = 0;
+        size_t newlinePos;
+
+        while ((newlinePos = pending->find('\n', lineStart)) != std::string::npos) {
+            callback(pending->substr(lineStart, newlinePos - lineStart));
+            lineStart = newlinePos + 1;
+        }
+
+        pending->erase(0, lineStart);
+    };
+}
@@ -0,0 +1,49 @@
+// system includes
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#pragma once
+
+struct ProcessError : public std::runtime_error {
+    explicit ProcessError(const std::string& message) : runtime_error(message) {}
+};
+
+/**
+ * Receives a process' output in chunks while the process is running.
+ * Called with size 0 once the stream has been closed.
+ */
+typedef std::function<void(const char* data, size_t size)> OutputCallback;
+
+/**
+ * Resources used by a process, as reported by the kernel when it exits.
+ */
+struct ProcessResources {
+    // peak resident set size in KiB
+    long maxResidentSetKb = 0;
+
+    double userSeconds = 0;
+    double systemSeconds = 0;
+};
+
+/**
+ * Runs a process without a shell, and waits for it to exit.
+ *
+ * The arguments are passed to the process as they are, args[0] is looked up in $PATH if it doesn't contain a slash.
+ * stdin is connected to /dev/null. stdout and stderr are drained concurrently and passed to the callbacks as soon as
+ * data is available, so neither stream can fill up and block the process. Output of streams without a callback is
+ * discarded.
+ *
+ * @param resources if not null, receives the resources used by the process
+ * @return exit code of the process, or 128 + signal number if it has been killed by a signal
+ * @throws ProcessError if the process cannot be started
+ */
+int runProcess(const std::vector<std::string>& args, const OutputCallback& onStdout, const OutputCallback& onStderr,
+               ProcessResources* resources = nullptr);
+
+/**
+ * Adapts a callback handling single lines (without the line break) to an OutputCallback.
+ * A trailing line without a line break is passed to the callback when the stream is closed.
+ */
+OutputCallback forEachLine(std::function<void(const std::string& line)> callback);
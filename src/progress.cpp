@@ -0,0 +1,225 @@
+// system includes
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "progress.h"
+#include "fs.h"
+#include "timeline.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace nlohmann;
+
+namespace {
+    // millisecond resolution is enough to show progress, and keeps the events short
+    double roundSeconds(double seconds) {
+        return std::round(seconds * 1e3) / 1e3;
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            ProgressEvents::ProgressEvents() : fd(-1) {}
+
+            ProgressEvents& ProgressEvents::instance() {
+                static ProgressEvents progressEvents;
+                return progressEvents;
+            }
+
+            bool ProgressEvents::open(int fd) {
+                if (fd < 0)
+                    return false;
+
+                const auto flags = fcntl(fd, F_GETFD);
+
+                if (flags < 0)
+                    return false;
+
+                fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+
+                this->fd = fd;
+                return true;
+            }
+
+            void ProgressEvents::close() {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                fd = -1;
+                pendingFiles.clear();
+                plannedFiles = 0;
+                plannedBytes = 0;
+                pendingBytes = 0;
+            }
+
+            bool ProgressEvents::enabled() const {
+                return fd >= 0;
+            }
+
+            void ProgressEvents::write(json event) {
+                if (fd < 0)
+                    return;
+
+                event["time"] = roundSeconds(
+                    std::chrono::duration<double>(Timeline::Clock::now() - Timeline::instance().start()).count()
+                );
+
+                const auto line = event.dump() + "\n";
+                size_t written = 0;
+
+                while (written < line.size()) {
+                    const auto result = ::write(fd, line.data() + written, line.size() - written);
+
+                    if (result < 0) {
+                        if (errno == EINTR)
+                            continue;
+
+                        // the reader is gone, there's no point in keeping on writing
+                        ldLog() << LD_WARNING << "Failed to write progress event, disabling progress events:"
+                                << strerror(errno) << std::endl;
+                        fd = -1;
+                        return;
+                    }
+
+                    written += static_cast<size_t>(result);
+                }
+            }
+
+            void ProgressEvents::phaseStarted(const std::string& name) {
+                if (!enabled())
+                    return;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                write({{"type", "phaseStart"}, {"phase", name}});
+            }
+
+            void ProgressEvents::phaseFinished(const std::string& name, double seconds) {
+                if (!enabled())
+                    return;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                write({{"type", "phaseEnd"}, {"phase", name}, {"seconds", roundSeconds(seconds)}});
+            }
+
+            void ProgressEvents::processStarted(int pid, const std::string& command) {
+                if (!enabled())
+                    return;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                write({{"type", "processStart"}, {"pid", pid}, {"command", command}});
+            }
+
+            void ProgressEvents::processExited(int pid, const std::string& command, int exitCode, double seconds) {
+                if (!enabled())
+                    return;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                write({{"type", "processExit"}, {"pid", pid}, {"command", command}, {"exitCode", exitCode},
+                       {"seconds", roundSeconds(seconds)}});
+            }
+
+            void ProgressEvents::fileQueued(const bf::path& source, const bf::path& destination, bool isSymlink) {
+                if (!enabled())
+                    return;
+
+                // the size of the source is what will be copied, the destination doesn't exist yet
+                uintmax_t bytes = 0;
+
+                try {
+                    if (!isSymlink && fs::isRegularFile(source, FS_HERE))
+                        bytes = fs::fileSize(source, FS_HERE);
+                } catch (const bf::filesystem_error&) {}
+
+                std::lock_guard<std::mutex> lock(mutex);
+
+                pendingFiles[plannedFiles] = {destination, bytes};
+                ++plannedFiles;
+                plannedBytes += bytes;
+                pendingBytes += bytes;
+
+                write({{"type", "fileQueued"}, {"source", source.string()}, {"destination", destination.string()},
+                       {"bytes", bytes}, {"plannedFiles", plannedFiles}, {"plannedBytes", plannedBytes}});
+            }
+
+            void ProgressEvents::fileDone(const QueuedFile& file, const std::string& type) {
+                pendingBytes -= file.bytes;
+
+                write({{"type", type}, {"destination", file.destination.string()}, {"bytes", file.bytes},
+                       {"remainingFiles", pendingFiles.size()}, {"remainingBytes", pendingBytes}});
+            }
+
+            void ProgressEvents::checkPendingFiles(bool final) {
+                if (!enabled())
+                    return;
+
+                std::map<size_t, QueuedFile> candidates;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    candidates = pendingFiles;
+                }
+
+                // the destinations are checked without holding the lock, so files can be queued meanwhile
+                std::map<size_t, bool> deployed;
+
+                for (const auto& candidate : candidates)
+                    deployed[candidate.first] = fs::symlinkExists(candidate.second.destination, FS_HERE);
+
+                std::lock_guard<std::mutex> lock(mutex);
+
+                for (const auto& entry : deployed) {
+                    if (!entry.second && !final)
+                        continue;
+
+                    const auto it = pendingFiles.find(entry.first);
+
+                    if (it == pendingFiles.end())
+                        continue;
+
+                    const auto file = it->second;
+                    pendingFiles.erase(it);
+
+                    fileDone(file, entry.second ? "fileDeployed" : "fileSkipped");
+                }
+            }
+
+            DeferredOperationsProgress::DeferredOperationsProgress(std::chrono::milliseconds interval) {
+                if (!ProgressEvents::instance().enabled())
+                    return;
+
+                thread = std::thread([this, interval]() {
+                    std::unique_lock<std::mutex> lock(mutex);
+
+                    while (!stopped.wait_for(lock, interval, [this]() { return stopRequested; })) {
+                        lock.unlock();
+                        ProgressEvents::instance().checkPendingFiles(false);
+                        lock.lock();
+                    }
+                });
+            }
+
+            DeferredOperationsProgress::~DeferredOperationsProgress() {
+                if (!thread.joinable())
+                    return;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopRequested = true;
+                }
+
+                stopped.notify_all();
+                thread.join();
+
+                ProgressEvents::instance().checkPendingFiles(true);
+            }
+        }
+    }
+}
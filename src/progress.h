@@ -0,0 +1,120 @@
+// system includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <json.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Writes progress events as newline-delimited JSON to a file descriptor, meant to be read by the tool
+             * calling the plugin. Every event is a single line with a "type" and the seconds since the start of the
+             * timeline in "time":
+             *
+             *  - phaseStart, phaseEnd: "phase", the name as shown by --timings, and "seconds" for phaseEnd
+             *  - processStart, processExit: "pid" and "command", "exitCode" and "seconds" for processExit
+             *  - fileQueued: a file was handed to linuxdeploy, with "source", "destination" and "bytes", and the
+             *    totals planned so far in "plannedFiles" and "plannedBytes"
+             *  - fileDeployed, fileSkipped: a queued file showed up in the AppDir, or didn't show up although the
+             *    deferred operations have been executed, with "destination", "bytes", "remainingFiles" and
+             *    "remainingBytes"
+             *
+             * The remaining work is estimated from the files queued so far, files linuxdeploy deploys on its own, e.g.,
+             * the dependencies of libraries, aren't known to the plugin.
+             *
+             * All functions are thread-safe, and do nothing unless a file descriptor has been opened.
+             */
+            class ProgressEvents {
+            private:
+                struct QueuedFile {
+                    boost::filesystem::path destination;
+                    uintmax_t bytes;
+                };
+
+                mutable std::mutex mutex;
+                std::atomic<int> fd;
+
+                // queued files whose destination hasn't been seen yet, by the order they were queued in
+                std::map<size_t, QueuedFile> pendingFiles;
+                size_t plannedFiles = 0;
+                uintmax_t plannedBytes = 0;
+                uintmax_t pendingBytes = 0;
+
+                ProgressEvents();
+
+                // requires the mutex to be locked
+                void write(nlohmann::json event);
+
+                void fileDone(const QueuedFile& file, const std::string& type);
+
+            public:
+                static ProgressEvents& instance();
+
+                /**
+                 * Starts writing events to the given file descriptor, which is inherited from the calling tool. The
+                 * descriptor is marked close-on-exec, so subprocesses don't keep it open.
+                 *
+                 * @return false if fd isn't an open file descriptor
+                 */
+                bool open(int fd);
+
+                /**
+                 * Stops writing events and forgets about the files queued so far. Doesn't close the descriptor.
+                 */
+                void close();
+
+                bool enabled() const;
+
+                void phaseStarted(const std::string& name);
+                void phaseFinished(const std::string& name, double seconds);
+
+                void processStarted(int pid, const std::string& command);
+                void processExited(int pid, const std::string& command, int exitCode, double seconds);
+
+                // destination is the path the file will have in the AppDir, symlinks count as 0 bytes
+                void fileQueued(const boost::filesystem::path& source, const boost::filesystem::path& destination,
+                                bool isSymlink = false);
+
+                /**
+                 * Reports the pending files which showed up in the AppDir. If final is set, the other pending files
+                 * are reported as skipped.
+                 */
+                void checkPendingFiles(bool final);
+            };
+
+            /**
+             * Checks for deployed files periodically while linuxdeploy executes the deferred operations, which is
+             * where the files are actually copied. When destroyed, the remaining files are checked a last time.
+             *
+             * Does nothing if no progress events are written.
+             */
+            class DeferredOperationsProgress {
+            private:
+                std::mutex mutex;
+                std::condition_variable stopped;
+                bool stopRequested = false;
+                std::thread thread;
+
+            public:
+                explicit DeferredOperationsProgress(
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(250)
+                );
+                ~DeferredOperationsProgress();
+
+                DeferredOperationsProgress(const DeferredOperationsProgress&) = delete;
+                DeferredOperationsProgress& operator=(const DeferredOperationsProgress&) = delete;
+            };
+        }
+    }
+}
@@ -0,0 +1,279 @@
+// system includes
+#include <algorithm>
+#include <tuple>
+
+// local includes
+#include "provenance.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::plugin::qt;
+using namespace nlohmann;
+
+namespace {
+    // nodes with more reasons are abbreviated by explain()
+    const size_t maxReasonsExplained = 3;
+
+    // chains are a handful of nodes long, this only guards against runaway output
+    const size_t maxExplainDepth = 12;
+
+    // the scopes of the calling thread, innermost last
+    thread_local std::vector<Provenance::Node> scopes;
+
+    std::string escapeDot(const std::string& value) {
+        std::string rv;
+
+        for (const auto c : value) {
+            if (c == '"' || c == '\\')
+                rv += '\\';
+
+            rv += c;
+        }
+
+        return rv;
+    }
+
+    void explainNode(const Provenance& provenance, const Provenance::Node& node, const std::string& relation,
+                     size_t depth, std::vector<Provenance::Node>& chain, std::ostream& os) {
+        const std::string indent(depth * 2, ' ');
+
+        os << indent;
+
+        if (depth > 0)
+            os << "← " << (relation.empty() ? "" : relation + " ");
+
+        os << node.toString() << std::endl;
+
+        if (depth >= maxExplainDepth)
+            return;
+
+        chain.push_back(node);
+
+        // reasons already on the chain would lead in circles
+        std::vector<Provenance::Reason> reasons;
+
+        for (const auto& reason : provenance.reasonsFor(node)) {
+            if (std::find(chain.begin(), chain.end(), reason.node) == chain.end())
+                reasons.push_back(reason);
+        }
+
+        for (size_t i = 0; i < reasons.size(); ++i) {
+            if (i == maxReasonsExplained) {
+                os << indent << "  ← ... and " << reasons.size() - maxReasonsExplained << " more" << std::endl;
+                break;
+            }
+
+            explainNode(provenance, reasons[i].node, reasons[i].relation, depth + 1, chain, os);
+        }
+
+        chain.pop_back();
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            bool Provenance::Node::operator<(const Node& other) const {
+                return std::tie(kind, name) < std::tie(other.kind, other.name);
+            }
+
+            bool Provenance::Node::operator==(const Node& other) const {
+                return kind == other.kind && name == other.name;
+            }
+
+            std::string Provenance::Node::toString() const {
+                return kind + " " + name;
+            }
+
+            bool Provenance::Reason::operator<(const Reason& other) const {
+                return std::tie(node, relation) < std::tie(other.node, other.relation);
+            }
+
+            Provenance::Provenance() : isEnabled(false) {}
+
+            Provenance& Provenance::instance() {
+                static Provenance provenance;
+                return provenance;
+            }
+
+            void Provenance::enable(const bf::path& appDirPath) {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                this->appDirPath = appDirPath;
+                isEnabled = true;
+            }
+
+            bool Provenance::enabled() const {
+                return isEnabled;
+            }
+
+            Provenance::Node Provenance::fileNode(const bf::path& path) const {
+                bf::path root;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    root = appDirPath;
+                }
+
+                auto name = path.string();
+
+                // deployers use paths below the AppDir path they were given, users may pass either kind of path
+                for (const auto& prefix : {root.string(), bf::absolute(root).string()}) {
+                    if (!prefix.empty() && name.compare(0, prefix.size() + 1, prefix + "/") == 0) {
+                        name = name.substr(prefix.size() + 1);
+                        break;
+                    }
+                }
+
+                while (name.compare(0, 2, "./") == 0)
+                    name = name.substr(2);
+
+                // directories are passed with a trailing slash sometimes
+                while (name.size() > 1 && name.back() == '/')
+                    name.pop_back();
+
+                return {"file", name};
+            }
+
+            void Provenance::addReason(const Node& node, const Node& reason, const std::string& relation) {
+                if (!enabled())
+                    return;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                reasons[node].insert({reason, relation});
+            }
+
+            void Provenance::fileDeployed(const bf::path& destination) {
+                if (!enabled() || scopes.empty())
+                    return;
+
+                addReason(fileNode(destination), scopes.back(), "deployed by");
+            }
+
+            std::string Provenance::describeCurrentScopes() const {
+                std::string rv;
+
+                for (auto it = scopes.rbegin(); it != scopes.rend(); ++it)
+                    rv += (rv.empty() ? "" : " ← ") + it->toString();
+
+                return rv;
+            }
+
+            std::set<Provenance::Reason> Provenance::reasonsFor(const Node& node) const {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                const auto it = reasons.find(node);
+
+                if (it == reasons.end())
+                    return {};
+
+                return it->second;
+            }
+
+            void Provenance::explain(const bf::path& path, std::ostream& os) const {
+                const auto node = fileNode(path);
+                std::vector<Node> chain;
+
+                if (!reasonsFor(node).empty()) {
+                    explainNode(*this, node, "", 0, chain, os);
+                    return;
+                }
+
+                // libraries linuxdeploy deployed may have been seen while tracing the AppDir
+                const Node library{"library", bf::path(node.name).filename().string()};
+
+                if (!reasonsFor(library).empty()) {
+                    os << node.toString() << std::endl;
+
+                    // the library was found as the file itself, which needn't be repeated
+                    chain.push_back(node);
+                    explainNode(*this, library, "is", 1, chain, os);
+                    return;
+                }
+
+                os << node.toString() << ": no reasons recorded, the file was either in the AppDir before, or "
+                   << "deployed by linuxdeploy as a dependency of another file" << std::endl;
+            }
+
+            json Provenance::toJson() const {
+                std::map<Node, std::set<Reason>> reasons;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    reasons = this->reasons;
+                }
+
+                std::map<Node, size_t> indices;
+
+                for (const auto& entry : reasons) {
+                    indices.emplace(entry.first, 0);
+
+                    for (const auto& reason : entry.second)
+                        indices.emplace(reason.node, 0);
+                }
+
+                auto nodes = json::array();
+
+                for (auto& entry : indices) {
+                    entry.second = nodes.size();
+                    nodes.push_back({{"kind", entry.first.kind}, {"name", entry.first.name}});
+                }
+
+                auto edges = json::array();
+
+                for (const auto& entry : reasons) {
+                    for (const auto& reason : entry.second) {
+                        edges.push_back({
+                            {"from", indices[entry.first]},
+                            {"to", indices[reason.node]},
+                            {"relation", reason.relation},
+                        });
+                    }
+                }
+
+                json rv;
+                rv["formatVersion"] = 1;
+                rv["nodes"] = nodes;
+                rv["edges"] = edges;
+                return rv;
+            }
+
+            void Provenance::writeDot(std::ostream& os) const {
+                const auto graph = toJson();
+
+                os << "digraph provenance {" << std::endl;
+                os << "    rankdir=LR;" << std::endl;
+
+                for (size_t i = 0; i < graph["nodes"].size(); ++i) {
+                    const auto& node = graph["nodes"][i];
+
+                    os << "    n" << i << " [label=\"" << escapeDot(node["kind"].get<std::string>()) << "\\n"
+                       << escapeDot(node["name"].get<std::string>()) << "\"];" << std::endl;
+                }
+
+                for (const auto& edge : graph["edges"]) {
+                    os << "    n" << edge["from"].get<size_t>() << " -> n" << edge["to"].get<size_t>()
+                       << " [label=\"" << escapeDot(edge["relation"].get<std::string>()) << "\"];" << std::endl;
+                }
+
+                os << "}" << std::endl;
+            }
+
+            ProvenanceScope::ProvenanceScope(const Provenance::Node& node, const std::string& relation)
+                : active(Provenance::instance().enabled()) {
+                if (!active)
+                    return;
+
+                if (!scopes.empty())
+                    Provenance::instance().addReason(node, scopes.back(), relation);
+
+                scopes.push_back(node);
+            }
+
+            ProvenanceScope::~ProvenanceScope() {
+                if (active)
+                    scopes.pop_back();
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+// system includes
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <json.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Records why files end up in the AppDir, as a graph whose edges point from a thing to the reason it was
+             * deployed, e.g.:
+             *
+             *   file usr/plugins/sqldrivers/libqsqlpsql.so -> deployer SqlPluginsDeployer -> module sql
+             *     -> library libQt5Sql.so.5 -> file usr/bin/app
+             *
+             * Reasons are established with ProvenanceScope, files handed to linuxdeploy by AppDirProxy point to the
+             * innermost scope of the thread deploying them. Files linuxdeploy deploys on its own, i.e., the
+             * dependencies of libraries, aren't known to the plugin, unless they were already found while tracing the
+             * AppDir's libraries.
+             *
+             * Nothing is recorded until enable() has been called. All functions are thread-safe.
+             */
+            class Provenance {
+            public:
+                struct Node {
+                    // file, library, module, deployer, import, argument or step
+                    std::string kind;
+
+                    // files are named by their path relative to the AppDir
+                    std::string name;
+
+                    bool operator<(const Node& other) const;
+                    bool operator==(const Node& other) const;
+
+                    std::string toString() const;
+                };
+
+                struct Reason {
+                    Node node;
+
+                    // how the reason relates to the node, e.g., "needed by"
+                    std::string relation;
+
+                    bool operator<(const Reason& other) const;
+                };
+
+            private:
+                mutable std::mutex mutex;
+                std::atomic<bool> isEnabled;
+                boost::filesystem::path appDirPath;
+
+                std::map<Node, std::set<Reason>> reasons;
+
+                Provenance();
+
+            public:
+                static Provenance& instance();
+
+                void enable(const boost::filesystem::path& appDirPath);
+
+                bool enabled() const;
+
+                /**
+                 * Returns the node of a file, named by its path relative to the AppDir if it's in there.
+                 */
+                Node fileNode(const boost::filesystem::path& path) const;
+
+                void addReason(const Node& node, const Node& reason, const std::string& relation);
+
+                /**
+                 * Records the innermost scope of the calling thread as the reason a file was deployed.
+                 */
+                void fileDeployed(const boost::filesystem::path& destination);
+
+                /**
+                 * Describes the scopes of the calling thread, innermost first, e.g.,
+                 * "deployer SqlPluginsDeployer ← module sql". Empty if there are none.
+                 */
+                std::string describeCurrentScopes() const;
+
+                std::set<Reason> reasonsFor(const Node& node) const;
+
+                /**
+                 * Writes the chains of reasons which led to the file being deployed, as a tree. Nodes with many
+                 * reasons, e.g., libraries needed by most files, list only the first few.
+                 */
+                void explain(const boost::filesystem::path& path, std::ostream& os) const;
+
+                /**
+                 * Exports the graph as JSON: a list of nodes with kind and name, and a list of edges with the indices
+                 * of the nodes, pointing from a node to its reason.
+                 */
+                nlohmann::json toJson() const;
+
+                /**
+                 * Exports the graph in Graphviz' DOT format.
+                 */
+                void writeDot(std::ostream& os) const;
+            };
+
+            /**
+             * Makes a node the reason for everything deployed by the calling thread until the scope is destroyed.
+             * Scopes nest, a scope's node is recorded as being caused by the enclosing scope's node.
+             */
+            class ProvenanceScope {
+            private:
+                bool active;
+
+            public:
+                /**
+                 * @param relation how the enclosing scope relates to the node, e.g., "run for"
+                 */
+                explicit ProvenanceScope(const Provenance::Node& node, const std::string& relation = "");
+                ~ProvenanceScope();
+
+                ProvenanceScope(const ProvenanceScope&) = delete;
+                ProvenanceScope& operator=(const ProvenanceScope&) = delete;
+            };
+        }
+    }
+}
@@ -1,4 +1,12 @@
 // system includes
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <boost/filesystem.hpp>
 
 // library includes
@@ -10,15 +18,57 @@
 
 // local includes
 #include "util.h"
+#include "fs.h"
+#include "pipeline.h"
+#include "process.h"
+#include "provenance.h"
 #include "qml.h"
+#include "task-pool.h"
+#include "timeline.h"
 
 namespace bf = boost::filesystem;
 using namespace linuxdeploy::core;
 using namespace linuxdeploy::core::log;
 using namespace linuxdeploy::util;
 using namespace nlohmann;
+using namespace linuxdeploy::plugin::qt;
+
+namespace {
+    // lookup started by prefetchQmlImportScanner()
+    std::shared_future<bf::path> qmlImportScannerLookup;
+
+    // set by setQmlImports()
+    bool haveGivenQmlImports = false;
+    std::vector<QmlModuleImport> givenQmlImports;
+
+    struct QmlModuleFile {
+        // position in the order the files are listed and deployed in
+        size_t sequence;
+
+        size_t importIndex;
+        bf::path path;
+        bool isElfFile;
+    };
+}
+
+void setQmlImports(const std::vector<QmlModuleImport>& imports) {
+    haveGivenQmlImports = true;
+    givenQmlImports = imports;
+}
+
+void prefetchQmlImportScanner() {
+    qmlImportScannerLookup = std::async(std::launch::async, []() {
+        TimelineSpan span("find qmlimportscanner", "background");
+        return which("qmlimportscanner");
+    }).share();
+}
 
 bf::path findQmlImportScanner() {
+    if (qmlImportScannerLookup.valid()) {
+        TimelineSpan span("wait for qmlimportscanner", "wait");
+        return qmlImportScannerLookup.get();
+    }
+
     return which("qmlimportscanner");
 }
 
@@ -44,14 +94,31 @@ std::string runQmlImportScanner(const std::vector<boost::filesystem::path> &sour
         ldLog() << LD_INFO << string << " ";
     ldLog() << LD_INFO << std::endl;
 
-    auto output = check_command(command);
+    // the output can grow to several megabytes for large QML trees, it's collected in place while the scanner runs,
+    // stderr is passed on to the debug log as it comes in
+    std::string output;
+    std::string errorOutput;
 
-    if (output.retcode != 0) {
-        ldLog() << LD_ERROR << output.stderrOutput << std::endl;
+    int returnCode;
+
+    try {
+        returnCode = runProcess(command, [&output](const char* data, size_t size) {
+            output.append(data, size);
+        }, forEachLine([&errorOutput](const std::string& line) {
+            ldLog() << LD_DEBUG << "qmlimportscanner:" << line << std::endl;
+            errorOutput += line + "\n";
+        }));
+    } catch (const ProcessError& e) {
+        ldLog() << LD_ERROR << e.what() << std::endl;
+        throw QmlImportScannerError("Failed to run qmlimportscanner");
+    }
+
+    if (returnCode != 0) {
+        ldLog() << LD_ERROR << errorOutput << std::endl;
         throw QmlImportScannerError("Failed to run qmlimportscanner");
     }
 
-    return output.stdoutOutput;
+    return output;
 }
 
 std::vector<QmlModuleImport> parseQmlImportScannerOutput(const std::string &output) {
@@ -73,6 +140,9 @@ std::vector<QmlModuleImport> parseQmlImportScannerOutput(const std::string &outp
             if (qmlModuleImportJson.find("relativePath") != qmlModuleImportJson.end())
                 moduleImport.relativePath = qmlModuleImportJson.at("relativePath").get<std::string>();
 
+            if (qmlModuleImportJson.find("version") != qmlModuleImportJson.end())
+                moduleImport.version = qmlModuleImportJson.at("version").get<std::string>();
+
             imports.push_back(moduleImport);
         }
     }
@@ -162,28 +232,224 @@ boost::filesystem::path getQmlModuleRelativePath(const std::vector<boost::filesy
     return relativePath;
 }
 
-void deployQml(appdir::AppDir &appDir, const boost::filesystem::path &installQmlPath) {
-    auto qmlImports = getQmlImports(appDir.path(), installQmlPath);
+std::map<std::string, std::vector<bf::path>> findQmlImportStatements(const std::vector<bf::path>& sourcesPaths) {
+    std::map<std::string, std::vector<bf::path>> rv;
+
+    for (const auto& sourcesPath : sourcesPaths) {
+        if (!fs::isDirectory(sourcesPath, FS_HERE))
+            continue;
+
+        fs::forEachEntryRecursive(sourcesPath, FS_HERE, [&rv](const bf::directory_entry& entry) {
+            if (entry.path().extension() != ".qml" || !fs::isRegularFile(entry, FS_HERE))
+                return;
+
+            std::ifstream ifs(entry.path().string());
+            std::string line;
+
+            while (std::getline(ifs, line)) {
+                std::istringstream iss(line);
+                std::string keyword, name;
+
+                // directory imports are quoted, they don't refer to modules
+                if (iss >> keyword >> name && keyword == "import" && name[0] != '"') {
+                    auto& files = rv[name];
+
+                    if (files.empty() || files.back() != entry.path())
+                        files.push_back(entry.path());
+                }
+            }
+        });
+    }
+
+    return rv;
+}
+
+void deployQml(AppDirProxy &appDir, const boost::filesystem::path &installQmlPath) {
+    TimelineSpan span("deployQml");
+
+    std::vector<QmlModuleImport> qmlImports;
+
+    if (haveGivenQmlImports) {
+        ldLog() << "Deploying" << givenQmlImports.size() << "QML imports found before" << std::endl;
+        qmlImports = givenQmlImports;
+    } else {
+        qmlImports = getQmlImports(appDir.path(), installQmlPath);
+    }
+
     bf::path targetQmlModulesPath = appDir.path().string() + "/usr/qml/";
 
-    for (const auto &qmlImport: qmlImports) {
-        if (!qmlImport.path.empty()) {
-            if (bf::is_directory(qmlImport.path)) {
-                for (bf::recursive_directory_iterator i(qmlImport.path); i != bf::recursive_directory_iterator(); ++i) {
-                    const auto &entry = *i;
-
-                    if (!bf::is_directory(entry)) {
-                        auto relativeFilePath = qmlImport.relativePath / bf::relative(entry.path(), qmlImport.path);
-                        try {
-                            elf::ElfFile file(entry.path());
-                            appDir.deployLibrary(entry.path(), targetQmlModulesPath / relativeFilePath);
-                        } catch (const elf::ElfFileParseError &) {
-                            appDir.deployFile(entry.path(), targetQmlModulesPath / relativeFilePath);
-                        }
-                    }
+    auto& provenance = Provenance::instance();
+    std::map<std::string, std::vector<bf::path>> importStatements;
+
+    if (provenance.enabled()) {
+        auto qmlSourcesPaths = getExtraQmlSourcesPaths();
+        qmlSourcesPaths.emplace_back(appDir.path());
+        importStatements = findQmlImportStatements(qmlSourcesPaths);
+    }
+
+    // the files are deployed in a pipeline: a thread lists the modules' files, tracer threads check which of them are
+    // ELF files, and this thread hands them to the AppDir in the order they were listed, copying them in batches
+    // this way, listing and parsing overlap with linuxdeploy's work and the copying
+    const auto queueCapacity = pipelineQueueCapacity();
+
+    BoundedQueue<QmlModuleFile> listedFiles("qml listed files", queueCapacity);
+    BoundedQueue<QmlModuleFile> tracedFiles("qml traced files", queueCapacity);
+
+    // the tracers finish out of order, and don't run further ahead of this thread than the queue's capacity, so that
+    // no more files wait to be put back in order
+    SequenceWindow tracedWindow(queueCapacity);
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto recordError = [&errorMutex, &error]() {
+        std::lock_guard<std::mutex> lock(errorMutex);
+
+        if (!error)
+            error = std::current_exception();
+    };
+
+    std::vector<std::thread> stages;
+
+    // the queues are aborted if this thread fails, so the stages don't block forever
+    struct StagesGuard {
+        std::vector<std::thread>& stages;
+        BoundedQueue<QmlModuleFile>& listedFiles;
+        BoundedQueue<QmlModuleFile>& tracedFiles;
+        SequenceWindow& tracedWindow;
+
+        ~StagesGuard() {
+            listedFiles.abort();
+            tracedFiles.abort();
+            tracedWindow.abort();
+
+            for (auto& stage : stages)
+                stage.join();
+        }
+    } stagesGuard{stages, listedFiles, tracedFiles, tracedWindow};
+
+    stages.emplace_back([&qmlImports, &listedFiles, &recordError]() {
+        TimelineSpan span("list QML module files", "pipeline");
+
+        try {
+            size_t sequence = 0;
+
+            for (size_t importIndex = 0; importIndex < qmlImports.size(); ++importIndex) {
+                const auto& importPath = qmlImports[importIndex].path;
+
+                if (importPath.empty() || !fs::isDirectory(importPath, FS_HERE))
+                    continue;
+
+                fs::forEachEntryRecursive(importPath, FS_HERE, [&](const bf::directory_entry &entry) {
+                    if (!fs::isDirectory(entry, FS_HERE))
+                        listedFiles.push({sequence++, importIndex, entry.path(), false});
+                });
+            }
+        } catch (...) {
+            recordError();
+        }
+
+        listedFiles.close();
+    });
+
+    const auto tracersCount = std::max(1u, TaskPool::instance().threadsCount() - 1);
+    std::atomic<unsigned int> runningTracers(tracersCount);
+
+    for (unsigned int i = 0; i < tracersCount; ++i) {
+        stages.emplace_back([&listedFiles, &tracedFiles, &tracedWindow, &runningTracers, &recordError]() {
+            TimelineSpan span("check QML module files", "pipeline");
+
+            try {
+                QmlModuleFile file;
+
+                while (listedFiles.pop(file)) {
+                    if (!tracedWindow.waitFor(file.sequence))
+                        break;
+
+                    try {
+                        elf::ElfFile elfFile(file.path);
+                        file.isElfFile = true;
+                    } catch (const elf::ElfFileParseError &) {}
+
+                    tracedFiles.push(std::move(file));
                 }
+            } catch (...) {
+                recordError();
+                listedFiles.abort();
             }
-        } else
+
+            if (--runningTracers == 0)
+                tracedFiles.close();
+        });
+    }
+
+    // the files are put back in order before handing them to the AppDir, there are at most queueCapacity of them
+    std::map<size_t, QmlModuleFile> tracedOutOfOrder;
+    size_t nextSequence = 0;
+
+    auto nextFile = [&tracedFiles, &tracedWindow, &tracedOutOfOrder, &nextSequence](QmlModuleFile& file) {
+        while (true) {
+            const auto it = tracedOutOfOrder.find(nextSequence);
+
+            if (it != tracedOutOfOrder.end()) {
+                file = std::move(it->second);
+                tracedOutOfOrder.erase(it);
+                ++nextSequence;
+                tracedWindow.advance();
+                return true;
+            }
+
+            QmlModuleFile tracedFile;
+
+            if (!tracedFiles.pop(tracedFile))
+                return false;
+
+            tracedOutOfOrder.emplace(tracedFile.sequence, std::move(tracedFile));
+        }
+    };
+
+    QmlModuleFile file;
+    bool haveFile = nextFile(file);
+    size_t filesSinceCopy = 0;
+
+    for (size_t importIndex = 0; importIndex < qmlImports.size(); ++importIndex) {
+        const auto& qmlImport = qmlImports[importIndex];
+        const Provenance::Node importNode{
+            "import", qmlImport.name + (qmlImport.version.empty() ? "" : " " + qmlImport.version)
+        };
+        ProvenanceScope importScope(importNode, "found by");
+
+        for (const auto& importStatement : importStatements[qmlImport.name])
+            provenance.addReason(importNode, provenance.fileNode(importStatement), "imported by");
+
+        if (qmlImport.path.empty()) {
             ldLog() << LD_ERROR << "Missing qml module: " << qmlImport.name << std::endl;
+            continue;
+        }
+
+        for (; haveFile && file.importIndex == importIndex; haveFile = nextFile(file)) {
+            auto relativeFilePath = qmlImport.relativePath / fs::relative(file.path, qmlImport.path, FS_HERE);
+
+            if (file.isElfFile)
+                appDir.deployLibrary(file.path, targetQmlModulesPath / relativeFilePath);
+            else
+                appDir.deployFile(file.path, targetQmlModulesPath / relativeFilePath);
+
+            if (++filesSinceCopy == queueCapacity) {
+                if (!appDir.executeDeferredOperations()) {
+                    ldLog() << LD_ERROR << "Failed to copy QML module files" << std::endl;
+                    throw QmlDeploymentError("Failed to copy QML module files");
+                }
+
+                filesSinceCopy = 0;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+
+        if (error)
+            std::rethrow_exception(error);
     }
 }
@@ -2,12 +2,16 @@
 #include <boost/filesystem.hpp>
 #include <linuxdeploy/core/appdir.h>
 
+// local includes
+#include "appdir-proxy.h"
+
 #pragma once
 
 typedef struct {
     std::string name;
     boost::filesystem::path path;
     boost::filesystem::path relativePath;
+    std::string version;
 } QmlModuleImport;
 
 static const char* const ENV_KEY_QML_MODULES_PATHS = "QML_MODULES_PATHS";
@@ -17,8 +21,20 @@ struct QmlImportScannerError : public std::runtime_error {
     explicit QmlImportScannerError(const std::string& message) : runtime_error(message) {}
 };
 
+struct QmlDeploymentError : public std::runtime_error {
+    explicit QmlDeploymentError(const std::string& message) : runtime_error(message) {}
+};
+
 // deploys QML files into AppDir
-void deployQml(linuxdeploy::core::appdir::AppDir &appDir, const boost::filesystem::path &installQmlPath);
+void deployQml(linuxdeploy::plugin::qt::AppDirProxy &appDir, const boost::filesystem::path &installQmlPath);
+
+// makes deployQml() deploy the given imports instead of running qmlimportscanner, e.g., a worker process's share of
+// the ones found by getQmlImports() in the parent process
+void setQmlImports(const std::vector<QmlModuleImport>& imports);
+
+// starts looking up qmlimportscanner in $PATH in the background, findQmlImportScanner() then waits for the result
+// $PATH must not change after calling this
+void prefetchQmlImportScanner();
 
 boost::filesystem::path findQmlImportScanner();
 
@@ -27,4 +43,13 @@ std::string runQmlImportScanner(const std::vector<boost::filesystem::path> &sour
 boost::filesystem::path getQmlModuleRelativePath(const std::vector<boost::filesystem::path>& qmlModulesImportPaths,
                                                  const boost::filesystem::path& qmlModulePath);
 
+// parses the JSON output of qmlimportscanner, only imports of type module are returned
+// throws the JSON library's exceptions if the output is malformed
+std::vector<QmlModuleImport> parseQmlImportScannerOutput(const std::string& output);
+
+// finds the .qml files below the given paths which import a module, by module name
+// only used to explain why modules are deployed, qmlimportscanner doesn't tell which file imports a module
+std::map<std::string, std::vector<boost::filesystem::path>> findQmlImportStatements(
+    const std::vector<boost::filesystem::path>& sourcesPaths);
+
 std::vector<QmlModuleImport> getQmlImports(const boost::filesystem::path& projectRootPath, const boost::filesystem::path& installQmlPath);
@@ -0,0 +1,356 @@
+// system includes
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// local includes
+#include "qt-install-paths.h"
+#include "util.h"
+
+namespace bf = boost::filesystem;
+
+namespace {
+    struct InstallLocation {
+        // name of the variable as reported by qmake -query
+        const char* variable;
+
+        // key in the [Paths] section of qt.conf
+        const char* confKey;
+
+        // default location relative to the prefix, as in Qt's default layout
+        const char* defaultPath;
+    };
+
+    const InstallLocation installLocations[] = {
+        {"QT_INSTALL_DOCS", "Documentation", "doc"},
+        {"QT_INSTALL_HEADERS", "Headers", "include"},
+        {"QT_INSTALL_LIBS", "Libraries", "lib"},
+        {"QT_INSTALL_LIBEXECS", "LibraryExecutables", "libexec"},
+        {"QT_INSTALL_BINS", "Binaries", "bin"},
+        {"QT_INSTALL_PLUGINS", "Plugins", "plugins"},
+        {"QT_INSTALL_IMPORTS", "Imports", "imports"},
+        {"QT_INSTALL_QML", "Qml2Imports", "qml"},
+        {"QT_INSTALL_ARCHDATA", "ArchData", "."},
+        {"QT_INSTALL_DATA", "Data", "."},
+        {"QT_INSTALL_TRANSLATIONS", "Translations", "translations"},
+        {"QT_INSTALL_EXAMPLES", "Examples", "examples"},
+        {"QT_INSTALL_TESTS", "Tests", "tests"},
+    };
+
+    std::string trim(const std::string& str) {
+        const auto begin = str.find_first_not_of(" \t\r");
+
+        if (begin == std::string::npos)
+            return "";
+
+        return str.substr(begin, str.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    // removes . and .. components lexically, like qmake does for the paths it reports
+    std::string cleanPath(const bf::path& path) {
+        std::vector<std::string> parts;
+
+        for (const auto& part : path) {
+            const auto partString = part.string();
+
+            if (partString == "/" || partString == "." || partString.empty())
+                continue;
+
+            if (partString == "..") {
+                if (!parts.empty())
+                    parts.pop_back();
+                continue;
+            }
+
+            parts.push_back(partString);
+        }
+
+        std::string rv;
+
+        for (const auto& part : parts)
+            rv += "/" + part;
+
+        return rv.empty() ? "/" : rv;
+    }
+
+    /**
+     * Reads the [Paths] section of a qt.conf file.
+     * Returns false if the file uses features which would require reimplementing more of Qt's logic, e.g., escape
+     * sequences or environment variable references in values, or keys other locations' defaults are derived from.
+     */
+    bool readQtConf(const bf::path& path, std::map<std::string, std::string>& paths) {
+        std::ifstream ifs(path.string());
+
+        if (!ifs)
+            return false;
+
+        std::string line;
+        std::string section;
+
+        while (std::getline(ifs, line)) {
+            line = trim(line);
+
+            if (line.empty() || line[0] == ';' || line[0] == '#')
+                continue;
+
+            if (line[0] == '[') {
+                section = line;
+                continue;
+            }
+
+            if (section != "[Paths]")
+                continue;
+
+            const auto separatorPos = line.find('=');
+
+            if (separatorPos == std::string::npos)
+                continue;
+
+            auto value = trim(line.substr(separatorPos + 1));
+
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                value = value.substr(1, value.size() - 2);
+
+            if (value.find('\\') != std::string::npos || value.find('$') != std::string::npos)
+                return false;
+
+            paths[trim(line.substr(0, separatorPos))] = value;
+        }
+
+        // Qt derives some defaults from the data directories, and prepends the sysroot to all paths
+        for (const auto* key : {"ArchData", "Data", "Sysroot"}) {
+            const auto it = paths.find(key);
+
+            if (it != paths.end() && !it->second.empty())
+                return false;
+        }
+
+        return true;
+    }
+
+    std::map<std::string, std::string> resolveLocations(const bf::path& prefix,
+                                                        const std::map<std::string, std::string>& paths) {
+        std::map<std::string, std::string> rv;
+
+        rv["QT_INSTALL_PREFIX"] = cleanPath(prefix);
+
+        for (const auto& location : installLocations) {
+            const auto it = paths.find(location.confKey);
+            const bf::path path = it != paths.end() ? it->second : location.defaultPath;
+
+            rv[location.variable] = cleanPath(path.is_absolute() ? path : prefix / path);
+        }
+
+        return rv;
+    }
+
+    bf::path findQtCoreLibrary(const bf::path& libsPath) {
+        boost::system::error_code ec;
+
+        for (bf::directory_iterator it(libsPath, ec), end; !ec && it != end; it.increment(ec)) {
+            const auto filename = it->path().filename().string();
+
+            if (filename.compare(0, 13, "libQt5Core.so") == 0 && bf::is_regular_file(it->path(), ec))
+                return it->path();
+        }
+
+        return {};
+    }
+
+    // returns the prefix QtCore was configured with, stored as qt_prfxpath=<prefix> in the library
+    // the library is several megabytes large, it's mapped and searched in place rather than read into memory
+    std::string readCompiledPrefix(const bf::path& libraryPath) {
+        const int fd = open(libraryPath.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0)
+            return "";
+
+        struct stat st{};
+
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+            close(fd);
+            return "";
+        }
+
+        const auto size = static_cast<size_t>(st.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (mapping == MAP_FAILED)
+            return "";
+
+        const auto* const data = static_cast<const char*>(mapping);
+
+        static const char marker[] = "qt_prfxpath=";
+        static const size_t markerSize = sizeof(marker) - 1;
+
+        std::string rv;
+
+        const auto* const markerPos = static_cast<const char*>(memmem(data, size, marker, markerSize));
+
+        if (markerPos != nullptr) {
+            const auto* const begin = markerPos + markerSize;
+            const auto* const end = static_cast<const char*>(memchr(begin, '\0', data + size - begin));
+
+            if (end != nullptr)
+                rv.assign(begin, end);
+        }
+
+        munmap(mapping, size);
+        return rv;
+    }
+
+    // the locations must describe the installation qmake belongs to, and contain what is needed for deployment
+    bool isPlausible(const std::map<std::string, std::string>& paths, const bf::path& qmakeDir) {
+        boost::system::error_code ec;
+
+        return bf::equivalent(paths.at("QT_INSTALL_BINS"), qmakeDir, ec) && !ec &&
+               bf::is_directory(paths.at("QT_INSTALL_LIBS"), ec) &&
+               bf::is_directory(paths.at("QT_INSTALL_PLUGINS"), ec);
+    }
+
+    // the locations derived from a compiled prefix are only right if the installation uses Qt's default layout, a build
+    // configured with, e.g., a custom -qmldir would have the deployers search the wrong directories
+    bool hasDefaultLayout(const std::map<std::string, std::string>& paths) {
+        boost::system::error_code ec;
+
+        for (const auto* variable : {"QT_INSTALL_QML", "QT_INSTALL_TRANSLATIONS", "QT_INSTALL_LIBEXECS",
+                                     "QT_INSTALL_DATA"}) {
+            if (!bf::is_directory(paths.at(variable), ec))
+                return false;
+        }
+
+        return true;
+    }
+
+    // identifies the QtCore library qmake -query results belong to, stat() follows the SONAME symlink to the actual
+    // file, so in-place updates are detected as well
+    std::string qtCoreIdentity(const std::map<std::string, std::string>& qmakeVars) {
+        const auto libsPathIt = qmakeVars.find("QT_INSTALL_LIBS");
+
+        if (libsPathIt == qmakeVars.end())
+            return "qtcore:";
+
+        return "qtcore:" + linuxdeploy::plugin::qt::fileIdentity(bf::path(libsPathIt->second) / "libQt5Core.so.5");
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            std::map<std::string, std::string> readQtInstallPaths(const bf::path& qmakePath, bf::path& source) {
+                boost::system::error_code ec;
+
+                // whether qmake looks for qt.conf next to a symlink or its target depends on how it was called, leave
+                // that to qmake
+                if (bf::is_symlink(qmakePath, ec) || !bf::is_regular_file(qmakePath, ec))
+                    return {};
+
+                const auto qmakeDir = bf::absolute(qmakePath).parent_path();
+                const auto qtConfPath = qmakeDir / "qt.conf";
+
+                std::map<std::string, std::string> rv;
+                bf::path rvSource;
+
+                if (bf::exists(qtConfPath, ec)) {
+                    std::map<std::string, std::string> paths;
+
+                    if (!readQtConf(qtConfPath, paths))
+                        return {};
+
+                    // a relative prefix is relative to the directory containing qt.conf
+                    const auto prefixIt = paths.find("Prefix");
+                    const bf::path prefix = prefixIt != paths.end() ? prefixIt->second : ".";
+
+                    rv = resolveLocations(prefix.is_absolute() ? prefix : qmakeDir / prefix, paths);
+                    rvSource = qtConfPath;
+                } else {
+                    const auto qtCorePath = findQtCoreLibrary(cleanPath(qmakeDir / ".." / "lib"));
+
+                    if (qtCorePath.empty())
+                        return {};
+
+                    const auto prefix = readCompiledPrefix(qtCorePath);
+
+                    if (prefix.empty() || !bf::path(prefix).is_absolute())
+                        return {};
+
+                    // the other locations are compiled in as well, but can't be located reliably, so this only
+                    // works for installations using Qt's default layout, other ones are left to qmake
+                    rv = resolveLocations(prefix, {});
+                    rvSource = qtCorePath;
+
+                    if (!hasDefaultLayout(rv))
+                        return {};
+                }
+
+                if (!isPlausible(rv, qmakeDir))
+                    return {};
+
+                source = rvSource;
+                return rv;
+            }
+
+            std::map<std::string, std::string> queryQmakeCached(const bf::path& qmakePath, DiskCache& cache,
+                                                                bool& fromCache, std::vector<std::string>* warnings) {
+                fromCache = false;
+
+                const auto qmakeIdentity = fileIdentity(qmakePath);
+
+                if (!cache.enabled() || qmakeIdentity.empty())
+                    return queryQmake(qmakePath, warnings);
+
+                const auto* const qtSelect = getenv("QT_SELECT");
+
+                // qmake reads the qt.conf next to it, the ones readQtInstallPaths() rejected end up here, qmake may
+                // look next to the symlink it was called through or next to its target
+                boost::system::error_code ec;
+                const auto qmakeDir = bf::absolute(qmakePath).parent_path();
+                const auto resolvedQmakeDir = bf::canonical(qmakePath, ec).parent_path();
+
+                auto qtConfIdentities = fileIdentity(qmakeDir / "qt.conf");
+
+                if (!ec && resolvedQmakeDir != qmakeDir)
+                    qtConfIdentities += "," + fileIdentity(resolvedQmakeDir / "qt.conf");
+
+                const auto key = "qmake-query-v2|" + qmakePath.string() + "|" + qmakeIdentity + "|" +
+                                 (qtSelect != nullptr ? qtSelect : "") + "|" + qtConfIdentities;
+
+                // entries consist of the QtCore identity, followed by the output in qmake -query's format
+                std::string cachedValue;
+
+                if (cache.lookup(key, cachedValue)) {
+                    const auto newlinePos = cachedValue.find('\n');
+
+                    if (newlinePos != std::string::npos) {
+                        auto vars = parseQmakeQueryOutput(cachedValue.substr(newlinePos + 1), warnings);
+
+                        if (!vars.empty() && cachedValue.compare(0, newlinePos, qtCoreIdentity(vars)) == 0) {
+                            fromCache = true;
+                            return vars;
+                        }
+                    }
+                }
+
+                auto vars = queryQmake(qmakePath, warnings);
+
+                if (!vars.empty()) {
+                    std::ostringstream value;
+                    value << qtCoreIdentity(vars) << "\n";
+
+                    for (const auto& var : vars)
+                        value << var.first << ":" << var.second << "\n";
+
+                    cache.store(key, value.str(), warnings);
+                }
+
+                return vars;
+            }
+        }
+    }
+}
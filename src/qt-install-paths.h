@@ -0,0 +1,53 @@
+// system includes
+#include <map>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+// local includes
+#include "cache.h"
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Determines the Qt install paths qmake -query would report without running qmake, by reading them from
+             * the Qt installation qmake belongs to.
+             *
+             * Two sources are supported:
+             *   - a qt.conf next to qmake, as shipped by the official installers and most relocatable builds
+             *   - the prefix compiled into libQt5Core in ../lib, if the installation uses Qt's default layout below
+             *     that prefix, i.e., the QML, translations, libexec and data directories exist where Qt puts them by
+             *     default
+             *
+             * Setups this function cannot handle reliably (symlinked qmake, sysroots, custom layouts, ...) are
+             * rejected rather than guessed, the caller should fall back to queryQmake() then.
+             *
+             * @param qmakePath path to qmake
+             * @param source set to the file the paths were read from
+             * @return the QT_INSTALL_* paths as returned by queryQmake(), or an empty map if they couldn't be determined
+             */
+            std::map<std::string, std::string> readQtInstallPaths(const boost::filesystem::path& qmakePath,
+                                                                  boost::filesystem::path& source);
+
+            /**
+             * Calls queryQmake(), reusing the results of previous calls stored in the given cache.
+             *
+             * Entries are keyed by qmake's path and identity (inode, size, modification time), the identity of the
+             * qt.conf next to qmake, if any, as well as $QT_SELECT, which qtchooser's qmake wrapper evaluates. An entry
+             * is discarded if libQt5Core in the QT_INSTALL_LIBS directory it contains has changed since, e.g., because
+             * Qt has been updated in place.
+             *
+             * @param fromCache set to true if the result was taken from the cache
+             * @param warnings if given, problems are added to it instead of being logged
+             */
+            std::map<std::string, std::string> queryQmakeCached(const boost::filesystem::path& qmakePath,
+                                                                DiskCache& cache, bool& fromCache,
+                                                                std::vector<std::string>* warnings = nullptr);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+// library includes
+#include <boost/filesystem.hpp>
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "fs.h"
+#include "qt-module-matcher.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace linuxdeploy::plugin::qt;
+
+QtModuleId matchQtModule(const std::string& name) {
+    // as prefixes don't contain dots, everything up to the first dot has to match a prefix exactly
+    const auto dotPos = name.find('.');
+
+    if (dotPos != std::string::npos) {
+        const auto id = findQtModuleByLibraryPrefix(name.c_str(), dotPos);
+
+        if (id < QtModulesCount) {
+            ldLog() << LD_DEBUG << "-> matches library filename, found module:" << QtModules[id].name << std::endl;
+            return id;
+        }
+    }
+
+    const auto id = findQtModuleByName(name.c_str(), name.size());
+
+    if (id < QtModulesCount)
+        ldLog() << LD_DEBUG << "-> matches module name, found module:" << QtModules[id].name << std::endl;
+
+    return id;
+}
+
+QtModuleSet findQtModules(const std::set<std::string>& libraryNames) {
+    QtModuleSet modules;
+
+    for (const auto& libraryName : libraryNames) {
+        const auto id = matchQtModule(libraryName);
+
+        if (id < QtModulesCount)
+            modules.set(id);
+    }
+
+    return modules;
+}
+
+QtModuleSet findQtModulesForArguments(const std::vector<std::string>& arguments) {
+    QtModuleSet modules;
+
+    for (auto argument : arguments) {
+        // extract filename if argument is path
+        if (argument.find('/') != std::string::npos && fs::isRegularFile(argument, FS_HERE))
+            argument = bf::path(argument).filename().string();
+
+        const auto id = matchQtModule(argument);
+
+        if (id < QtModulesCount)
+            modules.set(id);
+    }
+
+    return modules;
+}
+
+std::vector<std::string> qtModuleNames(const QtModuleSet& modules) {
+    std::vector<std::string> names;
+
+    for (QtModuleId id = 0; id < QtModulesCount; ++id) {
+        if (modules.test(id))
+            names.emplace_back(QtModules[id].name);
+    }
+
+    return names;
+}
@@ -0,0 +1,34 @@
+// system includes
+#include <set>
+#include <string>
+#include <vector>
+
+// local includes
+#include "qt-modules.h"
+
+#pragma once
+
+/**
+ * Matches a library filename (e.g., libQt5Core.so.5) or a module name (e.g., core) to a Qt module.
+ * Library filenames must continue with a dot after the prefix, so that e.g., libQt5WebEngineCore won't be matched as
+ * webengine.
+ *
+ * @return ID of the matching module, or QtModulesCount if the name doesn't belong to a known module
+ */
+QtModuleId matchQtModule(const std::string& name);
+
+/**
+ * Finds the modules the given library filenames belong to in a single pass over the names.
+ */
+QtModuleSet findQtModules(const std::set<std::string>& libraryNames);
+
+/**
+ * Like findQtModules, but for names specified by the user, which may also be paths to library files.
+ * Only arguments containing a slash are checked on the filesystem.
+ */
+QtModuleSet findQtModulesForArguments(const std::vector<std::string>& arguments);
+
+/**
+ * Returns the names of the modules in a set, in module ID order.
+ */
+std::vector<std::string> qtModuleNames(const QtModuleSet& modules);
@@ -1,23 +1,20 @@
 // system includes
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
-#include <tuple>
-#include <vector>
 
 #pragma once
 
-class QtModule {
-    public:
-        const std::string name;
-        const std::string libraryFilePrefix;
-        const std::string translationFilePrefix;
-
-    public:
-        QtModule(std::string name, std::string libraryFilePrefix, std::string pluginGroup) :
-            name(std::move(name)), libraryFilePrefix(std::move(libraryFilePrefix)), translationFilePrefix(std::move(pluginGroup)) {}
+struct QtModule {
+    const char* name;
+    const char* libraryFilePrefix;
+    const char* translationFilePrefix;
 };
 
 // TODO: the list of translation file prefixes is probably incomplete
-static const std::vector<QtModule> QtModules = {
+constexpr QtModule QtModules[] = {
     {"3danimation", "libQt53DAnimation", ""},
     {"3dcore", "libQt53DCore", ""},
     {"3dextras", "libQt53DExtras", ""},
@@ -79,3 +76,131 @@ static const std::vector<QtModule> QtModules = {
     {"xmlpatterns", "libQt5XmlPatterns", "qtxmlpatterns"},
     {"xml", "libQt5Xml", "qtbase"},
 };
+
+/**
+ * Stable integer ID of a Qt module, i.e., its index in QtModules. New modules must be appended to the table to keep the
+ * IDs stable.
+ */
+typedef size_t QtModuleId;
+
+constexpr size_t QtModulesCount = sizeof(QtModules) / sizeof(QtModules[0]);
+
+/**
+ * Set of Qt modules, indexed by their IDs.
+ */
+typedef std::bitset<QtModulesCount> QtModuleSet;
+
+namespace qtModulesDetail {
+    constexpr bool stringsEqual(const char* a, const char* b) {
+        return *a == *b && (*a == '\0' || stringsEqual(a + 1, b + 1));
+    }
+
+    constexpr size_t stringLength(const char* s) {
+        return *s == '\0' ? 0 : 1 + stringLength(s + 1);
+    }
+
+    // FNV-1a, can be evaluated at compile time as well as at runtime
+    constexpr uint32_t hash(const char* s, size_t length, uint32_t seed) {
+        return length == 0 ? seed : hash(s + 1, length - 1, (seed ^ static_cast<uint8_t>(*s)) * 16777619u);
+    }
+
+    constexpr size_t SlotsCount = 256;
+    constexpr uint8_t NoModule = 0xff;
+
+    static_assert(QtModulesCount < NoModule, "too many modules for the lookup tables");
+
+    constexpr size_t slot(uint32_t hash) {
+        return (hash ^ (hash >> 16)) & (SlotsCount - 1);
+    }
+
+    // the seeds have been chosen so that no two modules end up in the same slot
+    // if the static_asserts below fail after modifying the table, try other seeds until they pass
+    constexpr uint32_t NameSeed = 2166136493u;
+    constexpr uint32_t LibraryPrefixSeed = 2166139282u;
+
+    constexpr const char* key(QtModuleId id, bool byLibraryPrefix) {
+        return byLibraryPrefix ? QtModules[id].libraryFilePrefix : QtModules[id].name;
+    }
+
+    constexpr size_t slotOf(QtModuleId id, bool byLibraryPrefix) {
+        return slot(hash(key(id, byLibraryPrefix), stringLength(key(id, byLibraryPrefix)),
+                         byLibraryPrefix ? LibraryPrefixSeed : NameSeed));
+    }
+
+    // returns the first module which hashes to the given slot
+    constexpr uint8_t slotOwner(size_t slot, bool byLibraryPrefix, QtModuleId id = 0) {
+        return id >= QtModulesCount ? NoModule :
+               (slotOf(id, byLibraryPrefix) == slot ? static_cast<uint8_t>(id) :
+                slotOwner(slot, byLibraryPrefix, id + 1));
+    }
+
+    constexpr bool isPerfect(bool byLibraryPrefix, QtModuleId id = 0) {
+        return id >= QtModulesCount ||
+               (slotOwner(slotOf(id, byLibraryPrefix), byLibraryPrefix) == id && isPerfect(byLibraryPrefix, id + 1));
+    }
+
+    static_assert(isPerfect(false), "module names collide in the lookup table, choose another NameSeed");
+    static_assert(isPerfect(true), "library prefixes collide in the lookup table, choose another LibraryPrefixSeed");
+
+    struct SlotTable {
+        uint8_t owners[SlotsCount];
+    };
+
+    template<size_t... I>
+    struct IndexSequence {};
+
+    template<size_t N, size_t... I>
+    struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+
+    template<size_t... I>
+    struct MakeIndexSequence<0, I...> {
+        typedef IndexSequence<I...> type;
+    };
+
+    template<size_t... Slots>
+    constexpr SlotTable makeSlotTable(bool byLibraryPrefix, IndexSequence<Slots...>) {
+        return {{slotOwner(Slots, byLibraryPrefix)...}};
+    }
+
+    constexpr SlotTable NameSlots = makeSlotTable(false, MakeIndexSequence<SlotsCount>::type());
+    constexpr SlotTable LibraryPrefixSlots = makeSlotTable(true, MakeIndexSequence<SlotsCount>::type());
+
+    inline QtModuleId lookup(const SlotTable& table, bool byLibraryPrefix, const char* s, size_t length) {
+        const auto owner = table.owners[slot(hash(s, length, byLibraryPrefix ? LibraryPrefixSeed : NameSeed))];
+
+        if (owner == NoModule)
+            return QtModulesCount;
+
+        const auto* candidate = key(owner, byLibraryPrefix);
+
+        if (strncmp(candidate, s, length) != 0 || candidate[length] != '\0')
+            return QtModulesCount;
+
+        return owner;
+    }
+}
+
+/**
+ * Looks up a module ID by module name at compile time, e.g., to compare IDs with constants.
+ * Returns QtModulesCount if there is no such module.
+ */
+constexpr QtModuleId qtModuleId(const char* name, QtModuleId id = 0) {
+    return id >= QtModulesCount ? QtModulesCount :
+           (qtModulesDetail::stringsEqual(QtModules[id].name, name) ? id : qtModuleId(name, id + 1));
+}
+
+/**
+ * Looks up a module by name (e.g., "core") without allocating memory.
+ * Returns QtModulesCount if there is no such module.
+ */
+inline QtModuleId findQtModuleByName(const char* name, size_t length) {
+    return qtModulesDetail::lookup(qtModulesDetail::NameSlots, false, name, length);
+}
+
+/**
+ * Looks up a module by library filename prefix (e.g., "libQt5Core") without allocating memory.
+ * Returns QtModulesCount if there is no such module.
+ */
+inline QtModuleId findQtModuleByLibraryPrefix(const char* prefix, size_t length) {
+    return qtModulesDetail::lookup(qtModulesDetail::LibraryPrefixSlots, true, prefix, length);
+}
@@ -0,0 +1,135 @@
+// system includes
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "cache.h"
+#include "fs.h"
+#include "staging.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+
+namespace {
+    // content hash for messages, symlinks are described by their targets
+    std::string describeContents(const bf::path& path) {
+        if (bf::is_symlink(path))
+            return "symlink to " + bf::read_symlink(path).string();
+
+        std::ostringstream oss;
+        oss << "hash " << std::hex << std::setw(16) << std::setfill('0')
+            << linuxdeploy::plugin::qt::fnv1aHashFile(path);
+        return oss.str();
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            StagingMerge::StagingMerge(bf::path targetDirectory) : targetDirectory(std::move(targetDirectory)),
+                                                                   movedCount(0),
+                                                                   identicalCount(0),
+                                                                   conflictsCount(0) {}
+
+            bool StagingMerge::isIdentical(const bf::path& stagedPath, const bf::path& otherStagedPath) {
+                const auto stagedIsSymlink = bf::is_symlink(stagedPath);
+
+                if (stagedIsSymlink != bf::is_symlink(otherStagedPath))
+                    return false;
+
+                if (stagedIsSymlink)
+                    return bf::read_symlink(stagedPath) == bf::read_symlink(otherStagedPath);
+
+                // the size is cheaper to compare, and tells most different files apart already
+                if (fs::fileSize(stagedPath, FS_HERE) != fs::fileSize(otherStagedPath, FS_HERE))
+                    return false;
+
+                return fnv1aHashFile(stagedPath) == fnv1aHashFile(otherStagedPath);
+            }
+
+            void StagingMerge::addStagingDirectory(const bf::path& stagingDirectory) {
+                fs::forEachEntryRecursive(stagingDirectory, FS_HERE, [&](const bf::directory_entry& entry) {
+                    // relative() would resolve the staged symlinks
+                    if (entry.symlink_status().type() != bf::directory_file)
+                        stagedFiles[entry.path().lexically_relative(stagingDirectory)].push_back(entry.path());
+                });
+            }
+
+            bool StagingMerge::merge() {
+                // the copies are compared before anything is moved, so conflicts leave the AppDir untouched
+                // the map is sorted by path, which makes the log of conflicts reproducible
+                bool success = true;
+
+                for (const auto& stagedFile : stagedFiles) {
+                    const auto& copies = stagedFile.second;
+
+                    try {
+                        for (size_t i = 1; i < copies.size(); ++i) {
+                            if (isIdentical(copies[i], copies.front()))
+                                continue;
+
+                            ldLog() << LD_ERROR << "Conflicting contents for" << stagedFile.first << LD_NO_SPACE << ":"
+                                    << describeContents(copies.front()) << "in" << copies.front() << LD_NO_SPACE
+                                    << "," << describeContents(copies[i]) << "in" << copies[i] << std::endl;
+                            ++conflictsCount;
+                            success = false;
+                        }
+                    } catch (const std::exception& e) {
+                        ldLog() << LD_ERROR << "Failed to compare staged copies of" << stagedFile.first
+                                << LD_NO_SPACE << ":" << e.what() << std::endl;
+                        success = false;
+                    }
+                }
+
+                if (!success) {
+                    ldLog() << LD_ERROR << "Not merging staged files into AppDir" << std::endl;
+                    return false;
+                }
+
+                for (const auto& stagedFile : stagedFiles) {
+                    const auto& relativePath = stagedFile.first;
+                    const auto targetPath = targetDirectory / relativePath;
+
+                    try {
+                        if (fs::symlinkExists(targetPath, FS_HERE)) {
+                            ldLog() << LD_DEBUG << "File exists in AppDir already, skipping:" << relativePath
+                                    << std::endl;
+                            continue;
+                        }
+
+                        fs::createDirectories(targetPath.parent_path(), FS_HERE);
+                        bf::rename(stagedFile.second.front(), targetPath);
+                    } catch (const std::exception& e) {
+                        ldLog() << LD_ERROR << "Failed to merge" << stagedFile.second.front() << "into AppDir:"
+                                << e.what() << std::endl;
+                        success = false;
+                        continue;
+                    }
+
+                    ++movedCount;
+                    identicalCount += stagedFile.second.size() - 1;
+                }
+
+                return success;
+            }
+
+            size_t StagingMerge::movedFilesCount() const {
+                return movedCount;
+            }
+
+            size_t StagingMerge::identicalFilesCount() const {
+                return identicalCount;
+            }
+
+            size_t StagingMerge::conflictingFilesCount() const {
+                return conflictsCount;
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// system includes
+#include <map>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Moves the files deployed into staging directories, e.g., by worker processes, into the AppDir.
+             *
+             * Files and symlinks are moved with rename(), so the staging directories must be on the AppDir's
+             * filesystem. Files existing in the AppDir before the merge are left alone, just like linuxdeploy doesn't
+             * overwrite existing files.
+             *
+             * A file staged more than once is moved only once. The copies are compared by content hash (symlinks by
+             * target), differing copies are conflicts: which one ends up in the AppDir would depend on the order of
+             * the merge. All copies are compared before the first file is moved, so a merge with conflicts leaves the
+             * AppDir untouched.
+             */
+            class StagingMerge {
+            private:
+                const boost::filesystem::path targetDirectory;
+
+                // the staged copies of each file, by path relative to the target directory
+                std::map<boost::filesystem::path, std::vector<boost::filesystem::path>> stagedFiles;
+
+                size_t movedCount;
+                size_t identicalCount;
+                size_t conflictsCount;
+
+                // compares two staged copies of a file
+                bool isIdentical(const boost::filesystem::path& stagedPath,
+                                 const boost::filesystem::path& otherStagedPath);
+
+            public:
+                explicit StagingMerge(boost::filesystem::path targetDirectory);
+
+                /**
+                 * Collects the files in a staging directory, they are moved by merge().
+                 */
+                void addStagingDirectory(const boost::filesystem::path& stagingDirectory);
+
+                /**
+                 * Compares the copies of the files staged more than once, and moves the files into the target
+                 * directory unless there are conflicts. Conflicts are logged.
+                 *
+                 * @return false if there were conflicts, or a file couldn't be moved
+                 */
+                bool merge();
+
+                size_t movedFilesCount() const;
+
+                // staged files whose contents matched the ones of another copy
+                size_t identicalFilesCount() const;
+
+                size_t conflictingFilesCount() const;
+            };
+        }
+    }
+}
@@ -0,0 +1,232 @@
+// system includes
+#include <algorithm>
+#include <exception>
+
+// local includes
+#include "task-pool.h"
+
+using namespace linuxdeploy::plugin::qt;
+
+namespace {
+    // the pool and worker the calling thread belongs to, if any
+    thread_local const TaskPool* currentPool = nullptr;
+    thread_local size_t currentWorkerIndex = 0;
+
+    // collects the first exception thrown by a group of tasks, and waits for all of them to finish
+    struct TaskGroupState {
+        std::mutex mutex;
+        std::condition_variable finishedCondition;
+        size_t finishedCount = 0;
+        std::exception_ptr error;
+
+        void finished(std::exception_ptr taskError) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (taskError && !error)
+                error = taskError;
+
+            ++finishedCount;
+            finishedCondition.notify_all();
+        }
+
+        void waitAndRethrow(size_t count) {
+            std::unique_lock<std::mutex> lock(mutex);
+            finishedCondition.wait(lock, [this, count]() { return finishedCount == count; });
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            TaskPool::TaskPool() : pendingTasks(0), stopping(false), nextWorker(0) {}
+
+            TaskPool& TaskPool::instance() {
+                static TaskPool pool;
+                return pool;
+            }
+
+            TaskPool::~TaskPool() {
+                {
+                    std::lock_guard<std::mutex> lock(idleMutex);
+                    stopping = true;
+                }
+
+                idleCondition.notify_all();
+
+                for (auto& thread : threads)
+                    thread.join();
+            }
+
+            void TaskPool::start(unsigned int threadsCount) {
+                if (!workers.empty())
+                    return;
+
+                if (threadsCount == 0)
+                    threadsCount = std::max(1u, std::thread::hardware_concurrency());
+
+                // the calling thread is one of them
+                for (unsigned int i = 1; i < threadsCount; ++i)
+                    workers.emplace_back(new Worker);
+
+                for (size_t i = 0; i < workers.size(); ++i)
+                    threads.emplace_back(&TaskPool::workerLoop, this, i);
+            }
+
+            unsigned int TaskPool::threadsCount() const {
+                return static_cast<unsigned int>(workers.size() + 1);
+            }
+
+            void TaskPool::submit(std::function<void()> task) {
+                if (workers.empty()) {
+                    task();
+                    return;
+                }
+
+                // workers keep their own tasks close, everyone else spreads them
+                const auto workerIndex = currentPool == this ? currentWorkerIndex : nextWorker++ % workers.size();
+
+                {
+                    std::lock_guard<std::mutex> lock(idleMutex);
+                    ++pendingTasks;
+                }
+
+                {
+                    auto& worker = *workers[workerIndex];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    worker.tasks.push_back(std::move(task));
+                }
+
+                idleCondition.notify_one();
+            }
+
+            bool TaskPool::runPendingTask(size_t workerIndex) {
+                std::function<void()> task;
+
+                // the worker's own newest task first, then the oldest task of another worker
+                for (size_t i = 0; i < workers.size() && !task; ++i) {
+                    auto& worker = *workers[(workerIndex + i) % workers.size()];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+
+                    if (worker.tasks.empty())
+                        continue;
+
+                    if (i == 0) {
+                        task = std::move(worker.tasks.back());
+                        worker.tasks.pop_back();
+                    } else {
+                        task = std::move(worker.tasks.front());
+                        worker.tasks.pop_front();
+                    }
+                }
+
+                if (!task)
+                    return false;
+
+                {
+                    std::lock_guard<std::mutex> lock(idleMutex);
+                    --pendingTasks;
+                }
+
+                task();
+                return true;
+            }
+
+            void TaskPool::workerLoop(size_t workerIndex) {
+                currentPool = this;
+                currentWorkerIndex = workerIndex;
+
+                while (true) {
+                    if (runPendingTask(workerIndex))
+                        continue;
+
+                    std::unique_lock<std::mutex> lock(idleMutex);
+                    idleCondition.wait(lock, [this]() { return stopping || pendingTasks > 0; });
+
+                    if (stopping && pendingTasks == 0)
+                        return;
+
+                    // a task may be counted before it's pushed
+                    if (pendingTasks > 0) {
+                        lock.unlock();
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            void TaskPool::parallelFor(size_t count, const std::function<void(size_t)>& function) {
+                if (count == 0)
+                    return;
+
+                auto state = std::make_shared<TaskGroupState>();
+                auto nextIndex = std::make_shared<std::atomic<size_t>>(0);
+
+                // helpers starting after all indices have been claimed return without touching function, which
+                // may be gone by then
+                auto work = [state, nextIndex, count, &function]() {
+                    for (size_t i = (*nextIndex)++; i < count; i = (*nextIndex)++) {
+                        std::exception_ptr error;
+
+                        try {
+                            function(i);
+                        } catch (...) {
+                            error = std::current_exception();
+                        }
+
+                        state->finished(error);
+                    }
+                };
+
+                const auto helpersCount = std::min(workers.size(), count - 1);
+
+                for (size_t i = 0; i < helpersCount; ++i)
+                    submit(work);
+
+                work();
+                state->waitAndRethrow(count);
+            }
+
+            void TaskPool::runInOrder(const std::vector<std::function<void()>>& tasks) {
+                if (tasks.empty())
+                    return;
+
+                auto state = std::make_shared<TaskGroupState>();
+                auto claimed = std::make_shared<std::vector<std::atomic<bool>>>(tasks.size());
+
+                for (auto& flag : *claimed)
+                    flag = false;
+
+                // whoever claims a task first runs it, the others skip it
+                auto run = [state, claimed, &tasks](size_t index) {
+                    if ((*claimed)[index].exchange(true))
+                        return;
+
+                    std::exception_ptr error;
+
+                    try {
+                        tasks[index]();
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+
+                    state->finished(error);
+                };
+
+                // submitted backwards, so that the workers, which take their newest tasks first, start with the
+                // earliest ones
+                if (!workers.empty()) {
+                    for (size_t i = tasks.size(); i-- > 0;)
+                        submit(std::bind(run, i));
+                }
+
+                for (size_t i = 0; i < tasks.size(); ++i)
+                    run(i);
+
+                state->waitAndRethrow(tasks.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+// system includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Work-stealing thread pool. Every worker has a deque of its own, tasks submitted by a worker go to its
+             * own deque and are run last in, first out, idle workers steal the oldest tasks of the others.
+             *
+             * Waiting functions let the calling thread take part in the work instead of blocking, so the calling
+             * thread counts as one of the pool's threads. A pool with a single thread has no workers and runs
+             * everything on the calling thread, in order.
+             */
+            class TaskPool {
+            private:
+                struct Worker {
+                    std::mutex mutex;
+                    std::deque<std::function<void()>> tasks;
+                };
+
+                std::vector<std::unique_ptr<Worker>> workers;
+                std::vector<std::thread> threads;
+
+                std::mutex idleMutex;
+                std::condition_variable idleCondition;
+                size_t pendingTasks;
+                bool stopping;
+
+                std::atomic<size_t> nextWorker;
+
+                TaskPool();
+
+                bool runPendingTask(size_t workerIndex);
+
+                void workerLoop(size_t workerIndex);
+
+            public:
+                static TaskPool& instance();
+
+                ~TaskPool();
+
+                TaskPool(const TaskPool&) = delete;
+                TaskPool& operator=(const TaskPool&) = delete;
+
+                /**
+                 * Starts the workers. Must be called before the pool is used from more than one thread.
+                 *
+                 * @param threadsCount number of threads including the calling one, 0 for one per CPU
+                 */
+                void start(unsigned int threadsCount);
+
+                // including the calling thread
+                unsigned int threadsCount() const;
+
+                void submit(std::function<void()> task);
+
+                /**
+                 * Calls function for every index in [0, count), spread over the pool. Returns once all calls are done,
+                 * rethrowing the first exception thrown by them.
+                 *
+                 * The calling thread claims indices as well, so this never waits for other tasks to finish first.
+                 */
+                void parallelFor(size_t count, const std::function<void(size_t)>& function);
+
+                /**
+                 * Runs the tasks on the pool and returns once all of them are done, rethrowing the first exception
+                 * thrown by them.
+                 *
+                 * The calling thread goes through the tasks in order, runs every task no worker has started yet, and
+                 * waits for the others. So a task is always either running or finished by the time the calling thread
+                 * gets past it, which makes it safe for tasks to wait for the ones before them.
+                 */
+                void runInOrder(const std::vector<std::function<void()>>& tasks);
+            };
+        }
+    }
+}
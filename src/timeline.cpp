@@ -0,0 +1,194 @@
+// system includes
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <unistd.h>
+
+// library includes
+#include <json.hpp>
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "timeline.h"
+#include "pipeline.h"
+#include "progress.h"
+
+using namespace linuxdeploy::core::log;
+using namespace nlohmann;
+
+namespace {
+    double toMilliseconds(linuxdeploy::plugin::qt::Timeline::Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    double toMicroseconds(linuxdeploy::plugin::qt::Timeline::Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    std::string formatMilliseconds(double milliseconds) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1) << milliseconds << " ms";
+        return oss.str();
+    }
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            Timeline::Timeline() : startTime(Clock::now()) {}
+
+            Timeline& Timeline::instance() {
+                static Timeline timeline;
+                return timeline;
+            }
+
+            Timeline::Clock::time_point Timeline::start() const {
+                return startTime;
+            }
+
+            void Timeline::record(Span span) {
+                std::lock_guard<std::mutex> lock(mutex);
+                recordedSpans.emplace_back(std::move(span));
+            }
+
+            std::vector<Timeline::Span> Timeline::spans() const {
+                std::lock_guard<std::mutex> lock(mutex);
+                return recordedSpans;
+            }
+
+            void Timeline::writeChromeTrace(std::ostream& os) const {
+                const auto pid = static_cast<int>(getpid());
+
+                auto events = json::array();
+                std::set<unsigned int> threadIds;
+
+                for (const auto& span : spans()) {
+                    json event = {
+                        {"name", span.name},
+                        {"cat", span.category},
+                        {"ph", "X"},
+                        {"ts", toMicroseconds(span.start - startTime)},
+                        {"dur", toMicroseconds(span.end - span.start)},
+                        {"pid", pid},
+                        {"tid", span.threadId},
+                    };
+
+                    if (!span.detail.empty())
+                        event["args"] = {{"detail", span.detail}};
+
+                    events.push_back(event);
+                    threadIds.insert(span.threadId);
+                }
+
+                for (const auto threadId : threadIds) {
+                    const auto threadName = threadId == 0 ? std::string("main") : "worker " + std::to_string(threadId);
+
+                    events.push_back({
+                        {"name", "thread_name"},
+                        {"ph", "M"},
+                        {"pid", pid},
+                        {"tid", threadId},
+                        {"args", {{"name", threadName}}},
+                    });
+                }
+
+                const json trace = {
+                    {"traceEvents", events},
+                    {"displayTimeUnit", "ms"},
+                };
+
+                os << trace.dump() << std::endl;
+            }
+
+            unsigned int Timeline::currentThreadId() {
+                static std::atomic<unsigned int> nextThreadId(0);
+                static thread_local unsigned int threadId = nextThreadId++;
+
+                return threadId;
+            }
+
+            TimelineSpan::TimelineSpan(std::string name, std::string category, std::string detail)
+                : name(std::move(name)), category(std::move(category)), detail(std::move(detail)),
+                  start(Timeline::Clock::now()) {
+                if (this->category == "phase")
+                    ProgressEvents::instance().phaseStarted(this->name);
+            }
+
+            TimelineSpan::~TimelineSpan() {
+                const auto end = Timeline::Clock::now();
+
+                Timeline::instance().record({name, category, start, end, Timeline::currentThreadId(), detail});
+
+                if (category == "phase")
+                    ProgressEvents::instance().phaseFinished(name, std::chrono::duration<double>(end - start).count());
+            }
+
+            TimelineReport::TimelineReport(bool printTimings, std::string traceFilePath)
+                : printTimings(printTimings), traceFilePath(std::move(traceFilePath)) {
+                // the timeline starts on first use, and the main thread gets ID 0
+                Timeline::instance();
+                Timeline::currentThreadId();
+            }
+
+            TimelineReport::~TimelineReport() {
+                if (!traceFilePath.empty()) {
+                    std::ofstream ofs(traceFilePath);
+
+                    if (ofs) {
+                        Timeline::instance().writeChromeTrace(ofs);
+                        ldLog() << std::endl << "Wrote trace to" << traceFilePath << std::endl;
+                    } else {
+                        ldLog() << LD_ERROR << "Failed to open trace file for writing:" << traceFilePath << std::endl;
+                    }
+                }
+
+                if (!printTimings)
+                    return;
+
+                const auto& timeline = Timeline::instance();
+                const auto spans = timeline.spans();
+
+                double backgroundTotal = 0;
+                double waitTotal = 0;
+
+                ldLog() << std::endl << "-- Timings --" << std::endl;
+
+                for (const auto& category : {"phase", "background", "wait"}) {
+                    for (const auto& span : spans) {
+                        if (span.category != category)
+                            continue;
+
+                        const auto duration = toMilliseconds(span.end - span.start);
+
+                        if (span.category == "background")
+                            backgroundTotal += duration;
+                        else if (span.category == "wait")
+                            waitTotal += duration;
+
+                        ldLog() << "[" << LD_NO_SPACE << span.category << LD_NO_SPACE << "]" << span.name
+                                << LD_NO_SPACE << ":" << formatMilliseconds(duration) << std::endl;
+                    }
+                }
+
+                // full queues point to a slow consumer, empty ones to a slow producer
+                for (const auto& queue : PipelineStats::instance().queues()) {
+                    std::ostringstream averageDepth;
+                    averageDepth << std::fixed << std::setprecision(1) << queue.averageDepth;
+
+                    ldLog() << "[queue]" << queue.name << LD_NO_SPACE << ":" << queue.items << "items, depth"
+                            << averageDepth.str() << "on average," << queue.maxDepth << "at most of" << queue.capacity
+                            << LD_NO_SPACE << ", full for" << formatMilliseconds(queue.pushStallSeconds * 1000)
+                            << LD_NO_SPACE << ", empty for" << formatMilliseconds(queue.popStallSeconds * 1000)
+                            << std::endl;
+                }
+
+                ldLog() << "Latency hidden by background work:" << formatMilliseconds(backgroundTotal - waitTotal)
+                        << std::endl;
+                ldLog() << "Total:" << formatMilliseconds(toMilliseconds(Timeline::Clock::now() - timeline.start()))
+                        << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+// system includes
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * Process-wide record of the time spent in the different parts of a run.
+             *
+             * Spans are grouped by category:
+             *   - "phase": steps of the main thread
+             *   - "background": work run asynchronously while the main thread continues
+             *   - "wait": time the main thread spent blocked on background work
+             *   - "deployer", "process", "file": individual deployers, subprocesses and AppDir operations, nested in
+             *     the phases
+             *   - "pipeline": the stages of a pipeline running on threads of their own
+             *
+             * Recording is thread-safe.
+             */
+            class Timeline {
+            public:
+                typedef std::chrono::steady_clock Clock;
+
+                struct Span {
+                    std::string name;
+                    std::string category;
+                    Clock::time_point start;
+                    Clock::time_point end;
+
+                    // small sequential number identifying the thread the span was recorded on, 0 is the main thread
+                    unsigned int threadId;
+
+                    // optional additional information, e.g., the file a span belongs to
+                    std::string detail;
+                };
+
+            private:
+                mutable std::mutex mutex;
+                const Clock::time_point startTime;
+                std::vector<Span> recordedSpans;
+
+                Timeline();
+
+            public:
+                static Timeline& instance();
+
+                Clock::time_point start() const;
+
+                void record(Span span);
+
+                std::vector<Span> spans() const;
+
+                /**
+                 * Writes the recorded spans in Chrome's trace event format, which can be loaded in chrome://tracing,
+                 * Perfetto or Speedscope. Spans on the same thread nest by time, so nested spans show up as children.
+                 */
+                void writeChromeTrace(std::ostream& os) const;
+
+                /**
+                 * Returns the ID of the calling thread, as used in Span::threadId.
+                 */
+                static unsigned int currentThreadId();
+            };
+
+            /**
+             * Records a span on the timeline from its construction until its destruction.
+             */
+            class TimelineSpan {
+            private:
+                std::string name;
+                std::string category;
+                std::string detail;
+                Timeline::Clock::time_point start;
+
+            public:
+                explicit TimelineSpan(std::string name, std::string category = "phase", std::string detail = "");
+                ~TimelineSpan();
+
+                TimelineSpan(const TimelineSpan&) = delete;
+                TimelineSpan& operator=(const TimelineSpan&) = delete;
+            };
+
+            /**
+             * Reports the recorded timeline when destroyed, e.g., at the end of main(), regardless of whether the run
+             * succeeded.
+             *
+             * The timings summary lists the phases and background work, and shows how much latency was hidden by
+             * running work in the background, i.e., the time spent in background work minus the time the main thread
+             * had to wait for it. The trace file contains all spans, see Timeline::writeChromeTrace().
+             */
+            class TimelineReport {
+            private:
+                const bool printTimings;
+                const std::string traceFilePath;
+
+            public:
+                TimelineReport(bool printTimings, std::string traceFilePath);
+                ~TimelineReport();
+            };
+        }
+    }
+}
@@ -1,98 +1,157 @@
+// system headers
+#include <fcntl.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
 // local headers
+#include "process.h"
 #include "util.h"
 
+namespace {
+    // logs a warning, or adds it to the caller's list
+    void warn(std::vector<std::string>* warnings, const std::string& message) {
+        using namespace linuxdeploy::core::log;
+
+        if (warnings != nullptr)
+            warnings->push_back(message);
+        else
+            ldLog() << LD_WARNING << message << std::endl;
+    }
+
+    bool isExecutableFile(const std::string& path) {
+        struct stat st{};
+
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            return false;
+
+        return faccessat(AT_FDCWD, path.c_str(), X_OK, AT_EACCESS) == 0;
+    }
+}
+
 procOutput check_command(const std::vector<std::string> &args) {
-    auto command = subprocess::util::join(args);
-    subprocess::Popen proc(command, subprocess::bufsize{-1 /* stands for dynamically allocated buffer */},
-                           subprocess::output(subprocess::PIPE), subprocess::error(subprocess::PIPE));
-    auto outputs = proc.communicate();
+    std::string out;
+    std::string err;
 
-    const auto &outBuf = outputs.first.buf;
-    auto outBufEnd = std::find(outBuf.begin(), outBuf.end(), '\0');
-    std::string out(outBuf.begin(), outBufEnd);
+    auto appendTo = [](std::string& target) -> OutputCallback {
+        return [&target](const char* data, size_t size) {
+            target.append(data, size);
+        };
+    };
 
-    const auto &errBuf = outputs.second.buf;
-    auto errBufEnd = std::find(errBuf.begin(), errBuf.end(), '\0');
-    std::string err(errBuf.begin(),  errBufEnd);
+    int returnCode;
+
+    try {
+        returnCode = runProcess(args, appendTo(out), appendTo(err));
+    } catch (const ProcessError& e) {
+        return {false, -1, "", e.what()};
+    }
 
-    int returnCode = proc.retcode();
     return {returnCode == 0, returnCode, out, err};
 }
 
 boost::filesystem::path which(const std::string &name) {
-    subprocess::Popen proc({"which", name.c_str()}, subprocess::output(subprocess::PIPE));
-    auto output = proc.communicate();
+    // like which, names containing a slash aren't looked up in $PATH
+    if (name.find('/') != std::string::npos)
+        return isExecutableFile(name) ? name : "";
+
+    const auto* const pathEnv = getenv("PATH");
+    const std::string path = pathEnv != nullptr ? pathEnv : "";
 
-    using namespace linuxdeploy::core::log;
+    // lookups are memoized per $PATH value, as $PATH is modified while running
+    // tools may be looked up from background threads, too
+    static std::mutex mutex;
+    static std::map<std::pair<std::string, std::string>, boost::filesystem::path> lookups;
 
-    ldLog() << LD_DEBUG << "Calling 'which" << name << LD_NO_SPACE << "'" << std::endl;
+    const auto key = std::make_pair(path, name);
 
-    if (proc.retcode() != 0) {
-        ldLog() << LD_DEBUG << "which call failed, exit code:" << proc.retcode() << std::endl;
-        return "";
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const auto it = lookups.find(key);
+        if (it != lookups.end())
+            return it->second;
     }
 
-    std::string path = output.first.buf.data();
+    boost::filesystem::path rv;
+
+    // split by hand, std::getline() would drop a trailing empty entry
+    for (size_t begin = 0, end; begin <= path.size(); begin = end + 1) {
+        end = path.find(':', begin);
+
+        if (end == std::string::npos)
+            end = path.size();
+
+        auto dir = path.substr(begin, end - begin);
+
+        // empty entries, i.e., leading, trailing or doubled colons, refer to the current working directory
+        if (dir.empty())
+            dir = ".";
+
+        const auto candidate = dir + "/" + name;
 
-    while (path.back() == '\n') {
-        path.erase(path.end() - 1, path.end());
+        if (isExecutableFile(candidate)) {
+            rv = candidate;
+            break;
+        }
     }
 
-    return path;
+    std::lock_guard<std::mutex> lock(mutex);
+    lookups[key] = rv;
+
+    return rv;
 }
 
-std::map<std::string, std::string> queryQmake(const boost::filesystem::path& qmakePath) {
+std::map<std::string, std::string> queryQmake(const boost::filesystem::path& qmakePath,
+                                              std::vector<std::string>* warnings) {
     auto qmakeCall = check_command({qmakePath.string(), "-query"});
 
-    using namespace linuxdeploy::core::log;
-
     if (!qmakeCall.success) {
-        ldLog() << LD_ERROR << "Call to qmake failed:" << qmakeCall.stderrOutput << std::endl;
+        using namespace linuxdeploy::core::log;
+
+        if (warnings != nullptr)
+            warnings->push_back("Call to qmake failed: " + qmakeCall.stderrOutput);
+        else
+            ldLog() << LD_ERROR << "Call to qmake failed:" << qmakeCall.stderrOutput << std::endl;
+
         return {};
     }
 
+    return parseQmakeQueryOutput(qmakeCall.stdoutOutput, warnings);
+}
+
+std::map<std::string, std::string> parseQmakeQueryOutput(const std::string& output,
+                                                         std::vector<std::string>* warnings) {
     std::map<std::string, std::string> rv;
 
     std::stringstream ss;
-    ss << qmakeCall.stdoutOutput;
+    ss << output;
 
     std::string line;
 
-    auto stringSplit = [](const std::string& str, const char delim = ' ') {
-        std::stringstream ss;
-        ss << str;
-
-        std::string part;
-        std::vector<std::string> parts;
-
-        while (std::getline(ss, part, delim)) {
-            parts.push_back(part);
-        }
-
-        return parts;
-    };
-
     while (std::getline(ss, line)) {
-        auto parts = stringSplit(line, ':');
+        // values may contain colons themselves (e.g., URLs or Windows style paths), only the first one separates
+        // the key
+        const auto separatorPos = line.find(':');
 
-        if (parts.size() != 2)
+        if (separatorPos == std::string::npos || separatorPos == 0) {
+            if (!line.empty())
+                warn(warnings, "Ignoring malformed line in qmake -query output: " + line);
             continue;
+        }
 
-        rv[parts[0]] = parts[1];
+        rv[line.substr(0, separatorPos)] = line.substr(separatorPos + 1);
     }
 
     return rv;
-};
+}
 
 boost::filesystem::path findQmake() {
-    using namespace linuxdeploy::core::log;
-
     boost::filesystem::path qmakePath;
 
     // allow user to specify absolute path to qmake
     if (getenv("QMAKE")) {
         qmakePath = getenv("QMAKE");
-        ldLog() << "Using user specified qmake:" << qmakePath << std::endl;
     } else {
         // search for qmake
         qmakePath = which("qmake-qt5");
@@ -1,7 +1,11 @@
 #pragma once
 
 // system includes
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <set>
 #include <sstream>
 #include <tuple>
@@ -9,7 +13,6 @@
 
 // library includes
 #include <boost/filesystem.hpp>
-#include <subprocess.hpp>
 #include <args.hxx>
 #include <linuxdeploy/core/log.h>
 
@@ -20,8 +23,12 @@ typedef struct {
     std::string stderrOutput;
 } procOutput;
 
+// runs a command without a shell and collects its output, see runProcess() for details
+// a command which can't be started is reported as failed, with the reason in stderrOutput
 procOutput check_command(const std::vector<std::string> &args);
 
+// looks up an executable in $PATH like which does, without spawning a process
+// results are memoized per $PATH value, returns an empty path if the executable can't be found
 boost::filesystem::path which(const std::string &name);
 
 template<typename Iter>
@@ -39,8 +46,16 @@ std::string join(Iter beg, Iter end) {
     return rv.str();
 }
 
-std::map<std::string, std::string> queryQmake(const boost::filesystem::path& qmakePath);
+// if warnings is given, problems are added to it instead of being logged, so that the function can run in the
+// background without its messages interleaving with the main thread's
+std::map<std::string, std::string> queryQmake(const boost::filesystem::path& qmakePath,
+                                              std::vector<std::string>* warnings = nullptr);
 
+// parses KEY:value lines as printed by qmake -query, malformed lines are reported like by queryQmake()
+std::map<std::string, std::string> parseQmakeQueryOutput(const std::string& output,
+                                                         std::vector<std::string>* warnings = nullptr);
+
+// returns $QMAKE if set, otherwise searches $PATH; doesn't log, so it can run in the background
 boost::filesystem::path findQmake();
 
 bool pathContainsFile(boost::filesystem::path dir, boost::filesystem::path file);
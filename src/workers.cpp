@@ -0,0 +1,261 @@
+// system includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// library includes
+#include <linuxdeploy/core/log.h>
+
+// local includes
+#include "process.h"
+#include "staging.h"
+#include "timeline.h"
+#include "workers.h"
+
+namespace bf = boost::filesystem;
+
+using namespace linuxdeploy::core::log;
+using namespace nlohmann;
+
+namespace {
+    // removes the staging directories, whether the deployment succeeded or not
+    struct StagingDirectoryGuard {
+        bf::path path;
+
+        ~StagingDirectoryGuard() {
+            boost::system::error_code ec;
+            bf::remove_all(path, ec);
+
+            if (ec)
+                ldLog() << LD_WARNING << "Failed to remove staging directory" << path << LD_NO_SPACE << ":"
+                        << ec.message() << std::endl;
+        }
+    };
+
+    struct WorkerResult {
+        std::mutex mutex;
+        std::vector<std::string> outputLines;
+        int exitCode = -1;
+        std::string error;
+    };
+}
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            json workerJobToJson(const WorkerJob& job) {
+                json deployers = json::array();
+
+                for (const auto& deployer : job.deployers)
+                    deployers.push_back({{"module", deployer.first}, {"index", deployer.second}});
+
+                json qmlImports = json::array();
+
+                for (const auto& qmlImport : job.qmlImports) {
+                    qmlImports.push_back({
+                        {"name", qmlImport.name},
+                        {"path", qmlImport.path.string()},
+                        {"relativePath", qmlImport.relativePath.string()},
+                        {"version", qmlImport.version},
+                    });
+                }
+
+                json rv;
+                rv["stagingAppDir"] = job.stagingAppDir.string();
+                rv["qtPaths"] = job.qtPaths;
+                rv["deployers"] = deployers;
+                rv["qmlImports"] = qmlImports;
+                return rv;
+            }
+
+            WorkerJob workerJobFromJson(const json& json) {
+                WorkerJob job;
+                job.stagingAppDir = json.at("stagingAppDir").get<std::string>();
+
+                const auto& qtPaths = json.at("qtPaths");
+
+                for (auto it = qtPaths.begin(); it != qtPaths.end(); ++it)
+                    job.qtPaths[it.key()] = it.value().get<std::string>();
+
+                for (const auto& deployer : json.at("deployers")) {
+                    job.deployers.emplace_back(deployer.at("module").get<std::string>(),
+                                               deployer.at("index").get<size_t>());
+                }
+
+                for (const auto& qmlImportJson : json.at("qmlImports")) {
+                    QmlModuleImport qmlImport;
+                    qmlImport.name = qmlImportJson.at("name").get<std::string>();
+                    qmlImport.path = qmlImportJson.at("path").get<std::string>();
+                    qmlImport.relativePath = qmlImportJson.at("relativePath").get<std::string>();
+                    qmlImport.version = qmlImportJson.at("version").get<std::string>();
+                    job.qmlImports.push_back(std::move(qmlImport));
+                }
+
+                return job;
+            }
+
+            bool readWorkerJob(const bf::path& path, WorkerJob& job) {
+                try {
+                    std::ifstream ifs(path.string());
+
+                    if (!ifs)
+                        throw std::invalid_argument("cannot open file");
+
+                    job = workerJobFromJson(json::parse(ifs));
+                } catch (const std::exception& e) {
+                    ldLog() << LD_ERROR << "Failed to read worker job" << path << LD_NO_SPACE << ":" << e.what()
+                            << std::endl;
+                    return false;
+                }
+
+                return true;
+            }
+
+            std::vector<WorkerJob> planWorkerJobs(const std::vector<WorkerDeployer>& deployers, size_t workersCount,
+                                                  const std::vector<QmlModuleImport>& qmlImports) {
+                const bool haveShardedDeployers = std::any_of(deployers.begin(), deployers.end(),
+                                                              [](const WorkerDeployer& deployer) {
+                                                                  return deployer.sharded;
+                                                              });
+
+                // without sharded deployers, there's no work for more workers than deployers
+                if (!haveShardedDeployers)
+                    workersCount = std::min(workersCount, deployers.size());
+
+                std::vector<WorkerJob> jobs(std::max<size_t>(workersCount, 1));
+                size_t nextJob = 0;
+
+                for (const auto& deployer : deployers) {
+                    if (deployer.sharded) {
+                        for (auto& job : jobs)
+                            job.deployers.emplace_back(deployer.module, deployer.index);
+                    } else {
+                        jobs[nextJob++ % jobs.size()].deployers.emplace_back(deployer.module, deployer.index);
+                    }
+                }
+
+                if (haveShardedDeployers) {
+                    for (size_t i = 0; i < qmlImports.size(); ++i)
+                        jobs[i % jobs.size()].qmlImports.push_back(qmlImports[i]);
+                }
+
+                return jobs;
+            }
+
+            bool deployInWorkerProcesses(const bf::path& appDirPath, const std::map<std::string, std::string>& qtPaths,
+                                         const std::vector<WorkerDeployer>& deployers, size_t workersCount,
+                                         const std::vector<QmlModuleImport>& qmlImports) {
+                auto jobs = planWorkerJobs(deployers, workersCount, qmlImports);
+
+                const auto absoluteAppDirPath = bf::absolute(appDirPath);
+
+                // next to the AppDir, so the workers' files can be renamed into it, but not inside it, where leftovers
+                // would end up in the AppImage
+                auto stagingTemplate = (absoluteAppDirPath.parent_path() /
+                                        ("." + absoluteAppDirPath.filename().string() + "-qt-workers-XXXXXX")).string();
+
+                if (mkdtemp(&stagingTemplate[0]) == nullptr) {
+                    ldLog() << LD_ERROR << "Failed to create staging directory next to AppDir:"
+                            << stagingTemplate << std::endl;
+                    return false;
+                }
+
+                StagingDirectoryGuard stagingGuard{stagingTemplate};
+
+                for (size_t i = 0; i < jobs.size(); ++i) {
+                    auto& job = jobs[i];
+                    job.stagingAppDir = stagingGuard.path / ("worker-" + std::to_string(i));
+                    job.qtPaths = qtPaths;
+
+                    bf::create_directories(job.stagingAppDir);
+
+                    std::ofstream ofs((stagingGuard.path / ("worker-" + std::to_string(i) + ".json")).string());
+                    ofs << workerJobToJson(job).dump(4) << std::endl;
+
+                    if (!ofs) {
+                        ldLog() << LD_ERROR << "Failed to write job of worker" << i << std::endl;
+                        return false;
+                    }
+                }
+
+                const auto executablePath = bf::read_symlink("/proc/self/exe");
+
+                std::vector<WorkerResult> results(jobs.size());
+
+                {
+                    TimelineSpan span("run worker processes");
+
+                    std::vector<std::thread> threads;
+
+                    for (size_t i = 0; i < jobs.size(); ++i) {
+                        threads.emplace_back([&executablePath, &stagingGuard, &results, i]() {
+                            auto& result = results[i];
+
+                            auto collectLine = forEachLine([&result](const std::string& line) {
+                                std::lock_guard<std::mutex> lock(result.mutex);
+                                result.outputLines.push_back(line);
+                            });
+
+                            const auto jobPath = stagingGuard.path / ("worker-" + std::to_string(i) + ".json");
+
+                            try {
+                                result.exitCode = runProcess({executablePath.string(), "--worker-job", jobPath.string()},
+                                                             collectLine, collectLine);
+                            } catch (const ProcessError& e) {
+                                result.error = e.what();
+                            }
+                        });
+                    }
+
+                    for (auto& thread : threads)
+                        thread.join();
+                }
+
+                bool success = true;
+
+                for (size_t i = 0; i < jobs.size(); ++i) {
+                    const auto& result = results[i];
+                    const auto prefix = "[worker " + std::to_string(i) + "]";
+
+                    for (const auto& line : result.outputLines)
+                        ldLog() << prefix << line << std::endl;
+
+                    if (!result.error.empty()) {
+                        ldLog() << LD_ERROR << "Failed to start worker" << i << LD_NO_SPACE << ":" << result.error
+                                << std::endl;
+                        success = false;
+                    } else if (result.exitCode != 0) {
+                        ldLog() << LD_ERROR << "Worker" << i << "failed with exit code" << result.exitCode
+                                << std::endl;
+                        success = false;
+                    }
+                }
+
+                if (!success)
+                    return false;
+
+                TimelineSpan span("merge staging AppDirs");
+
+                StagingMerge merge(absoluteAppDirPath);
+
+                for (const auto& job : jobs)
+                    merge.addStagingDirectory(job.stagingAppDir);
+
+                success = merge.merge();
+
+                ldLog() << "Merged" << merge.movedFilesCount() << "files from" << jobs.size()
+                        << "staging AppDirs, skipped" << merge.identicalFilesCount() << "identical copies" << std::endl;
+
+                if (merge.conflictingFilesCount() > 0) {
+                    ldLog() << LD_ERROR << merge.conflictingFilesCount()
+                            << "files were deployed with different contents by different workers" << std::endl;
+                }
+
+                return success;
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// system includes
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <json.hpp>
+
+// local includes
+#include "qml.h"
+
+#pragma once
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            /**
+             * The share of the deployment a worker process started by --worker-processes runs. Workers deploy into
+             * staging AppDirs of their own, which are merged into the real AppDir once all of them have finished.
+             */
+            struct WorkerJob {
+                // the AppDir the worker deploys into
+                boost::filesystem::path stagingAppDir;
+
+                // as reported by qmake -query
+                std::map<std::string, std::string> qtPaths;
+
+                // by module name and position in the module's list of deployers, in the order of a serial run
+                std::vector<std::pair<std::string, size_t>> deployers;
+
+                // the worker's share of the QML imports found by the parent process, see setQmlImports()
+                std::vector<QmlModuleImport> qmlImports;
+            };
+
+            nlohmann::json workerJobToJson(const WorkerJob& job);
+
+            // throws the JSON library's exceptions if the job is malformed
+            WorkerJob workerJobFromJson(const nlohmann::json& json);
+
+            // reads a job file written by deployInWorkerProcesses(), errors are logged
+            bool readWorkerJob(const boost::filesystem::path& path, WorkerJob& job);
+
+            /**
+             * A deployer to be run by the workers.
+             */
+            struct WorkerDeployer {
+                std::string module;
+                size_t index;
+
+                // the deployer's work can be split, every worker runs it on its share of the QML imports
+                bool sharded;
+            };
+
+            /**
+             * Spreads the deployers over at most workersCount jobs, round-robin, keeping their order within each job.
+             * Sharded deployers are run by every job, the QML imports are spread over the jobs the same way. The
+             * staging AppDir paths aren't set.
+             */
+            std::vector<WorkerJob> planWorkerJobs(const std::vector<WorkerDeployer>& deployers, size_t workersCount,
+                                                  const std::vector<QmlModuleImport>& qmlImports = {});
+
+            /**
+             * Runs the deployers in worker processes, and merges their staging AppDirs into the AppDir.
+             *
+             * qmlimportscanner is run once, by the caller, the QML imports it found are split between the workers.
+             *
+             * The staging AppDirs are created next to the AppDir, so that the files can be renamed into it, and are
+             * removed afterwards. The workers' output is logged once all of them have finished, worker by worker.
+             *
+             * @return false if a worker failed, or the staging AppDirs couldn't be merged
+             */
+            bool deployInWorkerProcesses(const boost::filesystem::path& appDirPath,
+                                         const std::map<std::string, std::string>& qtPaths,
+                                         const std::vector<WorkerDeployer>& deployers, size_t workersCount,
+                                         const std::vector<QmlModuleImport>& qmlImports);
+        }
+    }
+}
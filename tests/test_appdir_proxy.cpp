@@ -0,0 +1,141 @@
+// system includes
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <linuxdeploy/core/appdir.h>
+
+// local includes
+#include "../src/appdir-proxy.h"
+#include "../src/plan.h"
+#include "../src/task-pool.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestAppDirProxy : public testing::Test {
+                public:
+                    bf::path tempDir;
+                    bf::path appDirPath;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-appdir-proxy-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+                        appDirPath = tempDir / "AppDir";
+
+                        bf::create_directories(appDirPath);
+                        std::ofstream((tempDir / "data.txt").string()) << "data";
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(tempDir);
+                    }
+                };
+
+                TEST_F(TestAppDirProxy, repeatedOperationsAreHandedOnOnce) {
+                    core::appdir::AppDir appDir(appDirPath);
+                    appDir.setDisableCopyrightFilesDeployment(true);
+
+                    AppDirProxy appDirProxy(appDir);
+
+                    ASSERT_TRUE(appDirProxy.deployFile(tempDir / "data.txt", appDirPath / "usr/share/data/"));
+                    ASSERT_TRUE(appDirProxy.deployFile(tempDir / "data.txt", appDirPath / "usr/share/data/"));
+                    ASSERT_EQ(appDirProxy.repeatedOperationsCount(), 1);
+
+                    // a different destination is a different operation
+                    ASSERT_TRUE(appDirProxy.deployFile(tempDir / "data.txt", appDirPath / "usr/share/other/"));
+                    ASSERT_EQ(appDirProxy.repeatedOperationsCount(), 1);
+
+                    ASSERT_TRUE(appDir.executeDeferredOperations());
+                    ASSERT_TRUE(bf::is_regular_file(appDirPath / "usr/share/data/data.txt"));
+                    ASSERT_TRUE(bf::is_regular_file(appDirPath / "usr/share/other/data.txt"));
+                }
+
+                TEST_F(TestAppDirProxy, slotsOrderOperationsLikeASerialRun) {
+                    TaskPool::instance().start(4);
+
+                    core::appdir::AppDir appDir(appDirPath);
+                    AppDirProxy appDirProxy(appDir);
+
+                    // the plan records the operations in the order they reach the proxy
+                    DeploymentPlan plan(appDirPath);
+                    appDirProxy.planInto(plan);
+
+                    const size_t count = 6;
+                    std::vector<std::function<void()>> tasks;
+
+                    for (size_t i = 0; i < count; ++i) {
+                        tasks.emplace_back([this, &appDirProxy, i]() {
+                            AppDirProxy::Slot slot(appDirProxy, i);
+
+                            // later slots are ready to deploy earlier
+                            std::this_thread::sleep_for(std::chrono::milliseconds(5 * (count - i)));
+
+                            const auto name = "file-" + std::to_string(i);
+                            appDirProxy.deployFile(tempDir / "data.txt", appDirPath / "usr/share" / name / "first");
+                            appDirProxy.deployFile(tempDir / "data.txt", appDirPath / "usr/share" / name / "second");
+                        });
+                    }
+
+                    appDirProxy.beginSequence(count);
+                    TaskPool::instance().runInOrder(tasks);
+
+                    ASSERT_EQ(plan.files().size(), 2 * count);
+
+                    for (size_t i = 0; i < count; ++i) {
+                        const auto directory = bf::path("usr/share") / ("file-" + std::to_string(i));
+                        ASSERT_EQ(plan.files()[2 * i].destination, directory / "first");
+                        ASSERT_EQ(plan.files()[2 * i + 1].destination, directory / "second");
+                    }
+                }
+
+                TEST_F(TestAppDirProxy, throwingSlotReleasesItsTurn) {
+                    TaskPool::instance().start(4);
+
+                    core::appdir::AppDir appDir(appDirPath);
+                    AppDirProxy appDirProxy(appDir);
+
+                    DeploymentPlan plan(appDirPath);
+                    appDirProxy.planInto(plan);
+
+                    const size_t count = 4;
+                    std::vector<std::function<void()>> tasks;
+
+                    for (size_t i = 0; i < count; ++i) {
+                        tasks.emplace_back([this, &appDirProxy, i]() {
+                            AppDirProxy::Slot slot(appDirProxy, i);
+
+                            if (i == 1) {
+                                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                                throw std::runtime_error("deployer failed");
+                            }
+
+                            appDirProxy.deployFile(tempDir / "data.txt",
+                                                   appDirPath / "usr/share" / ("file-" + std::to_string(i)));
+                        });
+                    }
+
+                    appDirProxy.beginSequence(count);
+
+                    // the slots after the throwing one would wait forever if it didn't release its turn
+                    ASSERT_THROW(TaskPool::instance().runInOrder(tasks), std::runtime_error);
+
+                    ASSERT_EQ(plan.files().size(), 3);
+                    ASSERT_EQ(plan.files()[0].destination, "usr/share/file-0");
+                    ASSERT_EQ(plan.files()[1].destination, "usr/share/file-2");
+                    ASSERT_EQ(plan.files()[2].destination, "usr/share/file-3");
+                }
+            }
+        }
+    }
+}
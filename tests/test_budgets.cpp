@@ -0,0 +1,143 @@
+// library includes
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/budgets.h"
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestBudgets : public testing::Test {
+                public:
+                    AppDirUsage usage;
+
+                    void SetUp() override {
+                        const std::vector<AppDirUsage::File> files = {
+                            {"usr/bin/app", 1024 * 1024},
+                            {"usr/lib/libQt5Core.so.5", 6 * 1024 * 1024},
+                            {"usr/lib/libQt5Gui.so.5", 5 * 1024 * 1024},
+                            {"usr/plugins/imageformats/libqjpeg.so", 512 * 1024},
+                            {"usr/plugins/imageformats/libqwebp.so", 3 * 1024 * 1024},
+                            {"usr/plugins/platforms/libqxcb.so", 1024 * 1024},
+                            {"usr/qml/QtQuick/Controls.2/libqtquickcontrols2plugin.so", 2 * 1024 * 1024},
+                            {"AppRun", 0},
+                        };
+
+                        for (const auto& file : files) {
+                            usage.files.push_back(file);
+                            usage.totalBytes += file.bytes;
+                        }
+                    }
+                };
+
+                TEST_F(TestBudgets, parseBudget) {
+                    DeploymentBudgets budgets;
+                    ASSERT_TRUE(budgets.empty());
+
+                    parseBudget("total-bytes=1.5M", budgets);
+                    parseBudget("files=2000", budgets);
+                    parseBudget("seconds=30", budgets);
+                    parseBudget("plugin-bytes=20m", budgets);
+                    parseBudget("plugin-bytes:imageformats=512K", budgets);
+
+                    ASSERT_FALSE(budgets.empty());
+                    ASSERT_EQ(budgets.totalBytes, 1536 * 1024);
+                    ASSERT_EQ(budgets.files, 2000);
+                    ASSERT_DOUBLE_EQ(budgets.seconds, 30);
+                    ASSERT_EQ(budgets.pluginCategoryBytes, 20 * 1024 * 1024);
+                    ASSERT_EQ(budgets.pluginCategoryBytesByName.at("imageformats"), 512 * 1024);
+
+                    for (const auto& invalid : {"total-bytes", "total-bytes=", "total-bytes=12X", "total-bytes=1MB",
+                                                "files=-1", "seconds=1s", "plugin-bytes:=1M", "size=1M"}) {
+                        ASSERT_THROW(parseBudget(invalid, budgets), BudgetError) << invalid;
+                    }
+                }
+
+                TEST_F(TestBudgets, checkBudgets_met) {
+                    DeploymentBudgets budgets;
+                    budgets.totalBytes = 20 * 1024 * 1024;
+                    budgets.files = 8;
+                    budgets.seconds = 10;
+                    budgets.pluginCategoryBytes = 4 * 1024 * 1024;
+
+                    ASSERT_TRUE(checkBudgets(budgets, usage, 5, {}).empty());
+                }
+
+                TEST_F(TestBudgets, checkBudgets_totalBytes) {
+                    DeploymentBudgets budgets;
+                    budgets.totalBytes = 10 * 1024 * 1024;
+
+                    const auto violations = checkBudgets(budgets, usage, 0, {});
+
+                    ASSERT_EQ(violations.size(), 1);
+                    ASSERT_EQ(violations[0].budget, "total-bytes");
+                    ASSERT_EQ(violations[0].limit, "10.0 MiB");
+                    ASSERT_EQ(violations[0].actual, "18.5 MiB");
+
+                    // the largest directories come first, then the largest files
+                    ASSERT_EQ(violations[0].contributors.size(), 10);
+                    ASSERT_EQ(violations[0].contributors[0], "usr/lib/: 11.0 MiB");
+                    ASSERT_EQ(violations[0].contributors[1], "usr/plugins/imageformats/: 3.5 MiB");
+                    ASSERT_EQ(violations[0].contributors[2], "usr/qml/QtQuick/: 2.0 MiB");
+                    ASSERT_EQ(violations[0].contributors[5], "usr/lib/libQt5Core.so.5: 6.0 MiB");
+                }
+
+                TEST_F(TestBudgets, checkBudgets_files) {
+                    DeploymentBudgets budgets;
+                    budgets.files = 4;
+
+                    const auto violations = checkBudgets(budgets, usage, 0, {});
+
+                    ASSERT_EQ(violations.size(), 1);
+                    ASSERT_EQ(violations[0].actual, "8");
+                    ASSERT_EQ(violations[0].contributors[0], "usr/lib/: 2 files");
+                    ASSERT_EQ(violations[0].contributors[1], "usr/plugins/imageformats/: 2 files");
+                }
+
+                TEST_F(TestBudgets, checkBudgets_pluginCategories) {
+                    DeploymentBudgets budgets;
+                    budgets.pluginCategoryBytes = 2 * 1024 * 1024;
+                    budgets.pluginCategoryBytesByName["platforms"] = 512 * 1024;
+
+                    const auto violations = checkBudgets(budgets, usage, 0, {});
+
+                    ASSERT_EQ(violations.size(), 2);
+                    ASSERT_EQ(violations[0].budget, "plugin-bytes:imageformats");
+                    ASSERT_EQ(violations[0].contributors.size(), 2);
+                    ASSERT_EQ(violations[0].contributors[0], "usr/plugins/imageformats/libqwebp.so: 3.0 MiB");
+                    ASSERT_EQ(violations[1].budget, "plugin-bytes:platforms");
+                    ASSERT_EQ(violations[1].limit, "0.5 MiB");
+                }
+
+                TEST_F(TestBudgets, checkBudgets_seconds) {
+                    const auto start = Timeline::Clock::time_point(std::chrono::seconds(100));
+                    const auto span = [&start](const std::string& name, const std::string& category, int startMs,
+                                               int endMs, unsigned int threadId) -> Timeline::Span {
+                        return {name, category, start + std::chrono::milliseconds(startMs),
+                                start + std::chrono::milliseconds(endMs), threadId, ""};
+                    };
+
+                    const std::vector<Timeline::Span> spans = {
+                        span("deploy Qt modules", "phase", 0, 3000, 0),
+                        span("QmlPluginsDeployer", "deployer", 0, 2000, 0),
+                        span("trace dependencies", "phase", 0, 5000, 1),
+                        span("libqxcb.so", "file", 2000, 2100, 0),
+                    };
+
+                    DeploymentBudgets budgets;
+                    budgets.seconds = 2;
+
+                    const auto violations = checkBudgets(budgets, usage, 3.5, spans);
+
+                    // phases of worker threads overlap with the main thread's and aren't listed
+                    ASSERT_EQ(violations.size(), 1);
+                    ASSERT_EQ(violations[0].actual, "3.50 s");
+                    ASSERT_EQ(violations[0].contributors.size(), 2);
+                    ASSERT_EQ(violations[0].contributors[0], "deploy Qt modules: 3.00 s");
+                    ASSERT_EQ(violations[0].contributors[1], "QmlPluginsDeployer: 2.00 s");
+                }
+            }
+        }
+    }
+}
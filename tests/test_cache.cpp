@@ -0,0 +1,81 @@
+// system includes
+#include <ctime>
+#include <fstream>
+#include <string>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/cache.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestDiskCache : public testing::Test {
+                public:
+                    bf::path tempDir;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-cache-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(tempDir);
+                    }
+                };
+
+                TEST_F(TestDiskCache, storeAndLookup) {
+                    DiskCache cache(tempDir / "cache");
+
+                    std::string value;
+                    ASSERT_FALSE(cache.lookup("key", value));
+
+                    cache.store("key", "value\nwith lines\n");
+                    ASSERT_TRUE(cache.lookup("key", value));
+                    ASSERT_EQ(value, "value\nwith lines\n");
+
+                    ASSERT_EQ(cache.hits(), 1);
+                    ASSERT_EQ(cache.misses(), 1);
+                }
+
+                TEST_F(TestDiskCache, oldEntriesAreEvicted) {
+                    const auto now = std::time(nullptr);
+
+                    {
+                        DiskCache cache(tempDir / "cache");
+
+                        for (int i = 0; i < 5; ++i)
+                            cache.store("key " + std::to_string(i), "value");
+                    }
+
+                    // pretend the entries were stored one after another
+                    for (int i = 0; i < 5; ++i) {
+                        for (bf::directory_iterator it(tempDir / "cache"), end; it != end; ++it) {
+                            std::string key;
+                            std::ifstream ifs(it->path().string());
+                            std::getline(ifs, key);
+
+                            if (key == "key " + std::to_string(i))
+                                bf::last_write_time(it->path(), now - 100 + i);
+                        }
+                    }
+
+                    DiskCache cache(tempDir / "cache", 3);
+
+                    std::string value;
+                    ASSERT_FALSE(cache.lookup("key 0", value));
+                    ASSERT_FALSE(cache.lookup("key 1", value));
+
+                    for (int i = 2; i < 5; ++i)
+                        ASSERT_TRUE(cache.lookup("key " + std::to_string(i), value));
+                }
+            }
+        }
+    }
+}
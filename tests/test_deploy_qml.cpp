@@ -18,8 +18,14 @@ namespace linuxdeploy {
                     boost::filesystem::path appDirPath;
                     boost::filesystem::path projectQmlRoot;
                     boost::filesystem::path defaultQmlImportPath;
+                    std::string originalPath;
 
                     void SetUp() override {
+                        // use the qmake and qmlimportscanner stand-ins instead of whatever Qt is installed
+                        originalPath = getenv("PATH");
+                        setenv("PATH", (FAKE_QT_BIN_DIR ":" + originalPath).c_str(), 1);
+                        setenv("QMAKE", FAKE_QT_BIN_DIR "/qmake", 1);
+
                         appDirPath = getTempDirName();
                         projectQmlRoot = appDirPath.string() + "/usr/qml";
 
@@ -43,6 +49,9 @@ namespace linuxdeploy {
                     void TearDown() override {
                         boost::filesystem::remove_all(appDirPath);
                         unsetenv(ENV_KEY_QML_MODULES_PATHS);
+                        unsetenv("FAKE_QMLIMPORTSCANNER_PADDING");
+                        unsetenv("QMAKE");
+                        setenv("PATH", originalPath.c_str(), 1);
                     }
 
                     bf::path getQmlImportPath() {
@@ -53,7 +62,7 @@ namespace linuxdeploy {
 
                 TEST_F(TestDeployQml, find_qmlimporter_path) {
                     auto result = findQmlImportScanner();
-                    boost::filesystem::path expected = "/usr/bin/qmlimportscanner";
+                    boost::filesystem::path expected = FAKE_QT_BIN_DIR "/qmlimportscanner";
 
                     ASSERT_FALSE(result.empty());
                     ASSERT_EQ(result.string(), expected.string());
@@ -84,13 +93,22 @@ namespace linuxdeploy {
                     }
                 }
 
+                TEST_F(TestDeployQml, getQmlImports_large_import_list) {
+                    // a few megabytes of imports of modules which don't exist, in addition to the real ones
+                    setenv("FAKE_QMLIMPORTSCANNER_PADDING", "20000", 1);
+
+                    auto results = getQmlImports(projectQmlRoot, defaultQmlImportPath);
+                    ASSERT_EQ(results.size(), 20002);
+                }
+
                 TEST_F(TestDeployQml, deploy_qml_imports) {
                     linuxdeploy::core::appdir::AppDir appDir(appDirPath);
 
                     // speed up test runs; we don't check for the copyright files anyway
                     appDir.setDisableCopyrightFilesDeployment(true);
 
-                    deployQml(appDir, defaultQmlImportPath);
+                    AppDirProxy appDirProxy(appDir);
+                    deployQml(appDirProxy, defaultQmlImportPath);
                     appDir.executeDeferredOperations();
 
                     ASSERT_TRUE(boost::filesystem::exists(projectQmlRoot.string() + "/QtQuick.2"));
@@ -0,0 +1,83 @@
+// system includes
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <linuxdeploy/core/elf.h>
+
+// local includes
+#include "../src/elf-resolver.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestElfResolver : public testing::Test {
+                public:
+                    // the test binary itself is a dynamically linked ELF file with a couple of dependencies
+                    bf::path selfPath = bf::read_symlink("/proc/self/exe");
+
+                    // returns the dependencies ldd finds as filename -> canonical path map
+                    std::map<std::string, std::string> callLdd(const bf::path& path) {
+                        std::map<std::string, std::string> rv;
+
+                        auto* pipe = popen(("ldd '" + path.string() + "'").c_str(), "r");
+                        EXPECT_NE(pipe, nullptr);
+
+                        char buffer[4096];
+                        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+                            const std::string line(buffer);
+
+                            // lines look like <tab>libfoo.so.1 => /path/to/libfoo.so.1 (0x...)
+                            const auto arrowPos = line.find(" => /");
+                            if (arrowPos == std::string::npos)
+                                continue;
+
+                            const auto name = line.substr(1, arrowPos - 1);
+                            const auto path = line.substr(arrowPos + 4, line.find(" (", arrowPos) - arrowPos - 4);
+                            rv[name] = bf::canonical(path).string();
+                        }
+
+                        pclose(pipe);
+                        return rv;
+                    }
+                };
+
+                TEST_F(TestElfResolver, readElfDynamicInfo) {
+                    const auto info = readElfDynamicInfo(selfPath);
+
+                    ASSERT_TRUE(info.elfClass == 1 || info.elfClass == 2);
+                    ASSERT_FALSE(info.needed.empty());
+                    ASSERT_NE(std::find(info.needed.begin(), info.needed.end(), "libc.so.6"), info.needed.end());
+                }
+
+                TEST_F(TestElfResolver, readElfDynamicInfo_non_elf_file) {
+                    ASSERT_THROW(readElfDynamicInfo(TESTS_DATA_DIR "/qml_project/file.qml"),
+                                 core::elf::ElfFileParseError);
+                }
+
+                TEST_F(TestElfResolver, traceDynamicDependencies_matches_ldd) {
+                    ElfDependencyResolver resolver(getenv("LD_LIBRARY_PATH") != nullptr ? getenv("LD_LIBRARY_PATH") : "");
+
+                    std::map<std::string, std::string> resolved;
+                    for (const auto& dependency : resolver.traceDynamicDependencies(selfPath)) {
+                        ASSERT_TRUE(bf::is_regular_file(dependency)) << dependency;
+
+                        // ldd shows the interpreter separately
+                        if (dependency.filename().string().find("ld-linux") == 0)
+                            continue;
+
+                        resolved[dependency.filename().string()] = bf::canonical(dependency).string();
+                    }
+
+                    ASSERT_EQ(resolved, callLdd(selfPath));
+                }
+            }
+        }
+    }
+}
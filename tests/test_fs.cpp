@@ -0,0 +1,73 @@
+// system includes
+#include <algorithm>
+#include <fstream>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/fs.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestFs : public testing::Test {
+                public:
+                    bf::path tempDir;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-fs-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+
+                        bf::create_directories(tempDir / "a" / "b");
+                        bf::create_directories(tempDir / "c");
+                        std::ofstream((tempDir / "a" / "b" / "file").string());
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(tempDir);
+                    }
+
+                    // returns the number of calls of an operation at the call site on the given line of this file
+                    static size_t countAt(const std::string& operation, int line) {
+                        const auto calls = fs::callCounts();
+                        const auto site = std::string("test_fs.cpp:") + std::to_string(line);
+
+                        const auto it = std::find_if(calls.begin(), calls.end(), [&](const fs::CallCount& call) {
+                            return call.operation == operation && call.site.size() >= site.size() &&
+                                   call.site.compare(call.site.size() - site.size(), site.size(), site) == 0;
+                        });
+
+                        return it == calls.end() ? 0 : it->count;
+                    }
+                };
+
+                TEST_F(TestFs, counts_calls_per_site) {
+                    for (int i = 0; i < 3; ++i) {
+                        ASSERT_TRUE(fs::isDirectory(tempDir, FS_HERE)); const auto line = __LINE__;
+                        ASSERT_EQ(countAt("is_directory", line), i + 1);
+                    }
+
+                    ASSERT_FALSE(fs::exists(tempDir / "missing", FS_HERE)); const auto line = __LINE__;
+                    ASSERT_EQ(countAt("exists", line), 1);
+                }
+
+                TEST_F(TestFs, forEachEntryRecursive) {
+                    size_t entries = 0;
+
+                    fs::forEachEntryRecursive(tempDir, FS_HERE, [&entries](const bf::directory_entry&) {
+                        ++entries;
+                    }); const auto line = __LINE__;
+
+                    // a, a/b, a/b/file and c; the root directory and the three subdirectories are opened
+                    ASSERT_EQ(entries, 4);
+                    ASSERT_EQ(countAt("recursive_directory_iterator", line - 2), 4);
+                }
+            }
+        }
+    }
+}
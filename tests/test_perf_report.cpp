@@ -0,0 +1,111 @@
+// library includes
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/perf-report.h"
+
+using namespace nlohmann;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestPerfReport : public testing::Test {
+                public:
+                    Timeline::Clock::time_point start = Timeline::Clock::time_point(std::chrono::seconds(100));
+
+                    Timeline::Span span(const std::string& name, const std::string& category, int startMs,
+                                        int endMs) const {
+                        return {name, category, start + std::chrono::milliseconds(startMs),
+                                start + std::chrono::milliseconds(endMs), 0, ""};
+                    }
+                };
+
+                TEST_F(TestPerfReport, makePerfReport) {
+                    const std::vector<Timeline::Span> spans = {
+                        span("trace AppDir libraries", "phase", 0, 100),
+                        span("find and query qmake", "background", 0, 300),
+                        span("wait for qmake", "wait", 100, 300),
+                        span("PlatformPluginsDeployer", "deployer", 300, 400),
+                        span("PlatformPluginsDeployer", "deployer", 400, 450),
+                        span("qmlimportscanner", "process", 450, 500),
+                        span("libqxcb.so", "file", 300, 310),
+                    };
+
+                    PerfCounters counters;
+                    counters.filesDeployed = 12;
+                    counters.bytesWritten = 3456;
+                    counters.elfCacheHits = 3;
+                    counters.elfCacheMisses = 1;
+
+                    QueueStats queue;
+                    queue.name = "qml listed files";
+                    queue.capacity = 64;
+                    queue.maxDepth = 64;
+                    counters.queues.push_back(queue);
+
+                    const auto report = makePerfReport(spans, start, start + std::chrono::seconds(1), counters);
+
+                    ASSERT_DOUBLE_EQ(report["totalSeconds"].get<double>(), 1.0);
+                    ASSERT_DOUBLE_EQ(report["phaseSeconds"]["trace AppDir libraries"].get<double>(), 0.1);
+                    ASSERT_DOUBLE_EQ(report["phaseSeconds"]["wait for qmake"].get<double>(), 0.2);
+                    ASSERT_EQ(report["phaseSeconds"].size(), 2);
+
+                    // deployers which are used for several modules are summed up
+                    ASSERT_DOUBLE_EQ(report["deployerSeconds"]["PlatformPluginsDeployer"].get<double>(), 0.15);
+
+                    ASSERT_EQ(report["subprocesses"]["count"].get<size_t>(), 1);
+                    ASSERT_EQ(report["files"]["deployed"].get<size_t>(), 12);
+                    ASSERT_EQ(report["files"]["bytes"].get<size_t>(), 3456);
+                    ASSERT_DOUBLE_EQ(report["caches"]["elfDependencies"]["hitRate"].get<double>(), 0.75);
+                    ASSERT_DOUBLE_EQ(report["caches"]["qmakeQuery"]["hitRate"].get<double>(), 0.0);
+                    ASSERT_EQ(report["queues"]["qml listed files"]["maxDepth"].get<size_t>(), 64);
+                }
+
+                TEST_F(TestPerfReport, comparePerfReports) {
+                    const auto baseline = json::parse(R"({
+                        "formatVersion": 1,
+                        "totalSeconds": 2.0,
+                        "phaseSeconds": {"slower": 1.0, "jitter": 0.01, "faster": 0.5, "removed": 1.0},
+                        "files": {"deployed": 100, "bytes": 1000},
+                        "subprocesses": {"count": 0, "totalSeconds": 0.0},
+                        "caches": {"elfDependencies": {"hits": 10, "misses": 0, "hitRate": 1.0}},
+                        "queues": {"qml listed files": {"pushStallSeconds": 0.1}}
+                    })");
+
+                    const auto current = json::parse(R"({
+                        "formatVersion": 1,
+                        "totalSeconds": 2.1,
+                        "phaseSeconds": {"slower": 1.5, "jitter": 0.03, "faster": 0.1, "added": 5.0},
+                        "files": {"deployed": 100, "bytes": 1200},
+                        "subprocesses": {"count": 1, "totalSeconds": 0.5},
+                        "caches": {"elfDependencies": {"hits": 0, "misses": 20, "hitRate": 0.0}},
+                        "queues": {"qml listed files": {"pushStallSeconds": 1.0}}
+                    })");
+
+                    const auto regressions = comparePerfReports(baseline, current, 0.1);
+
+                    // short phases need to grow by more than 50 ms, caches, queues and new or removed phases are ignored,
+                    // so is the qmake -query a cold cache spawns
+                    ASSERT_EQ(regressions.size(), 2);
+                    ASSERT_EQ(regressions[0].metric, "files/bytes");
+                    ASSERT_EQ(regressions[1].metric, "phaseSeconds/slower");
+                    ASSERT_DOUBLE_EQ(regressions[1].baseline, 1.0);
+                    ASSERT_DOUBLE_EQ(regressions[1].current, 1.5);
+
+                    ASSERT_TRUE(comparePerfReports(baseline, current, 0.6).empty());
+                }
+
+                TEST_F(TestPerfReport, comparePerfReportsCountsExtraSubprocesses) {
+                    const auto baseline = json::parse(R"({"subprocesses": {"count": 1, "totalSeconds": 0.1}})");
+                    const auto current = json::parse(R"({"subprocesses": {"count": 3, "totalSeconds": 2.0}})");
+
+                    const auto regressions = comparePerfReports(baseline, current, 0.1);
+
+                    ASSERT_EQ(regressions.size(), 1);
+                    ASSERT_EQ(regressions[0].metric, "subprocesses/count");
+                }
+            }
+        }
+    }
+}
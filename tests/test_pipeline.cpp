@@ -0,0 +1,122 @@
+// system includes
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// library includes
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/pipeline.h"
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                static QueueStats findQueueStats(const std::string& name) {
+                    for (const auto& queue : PipelineStats::instance().queues()) {
+                        if (queue.name == name)
+                            return queue;
+                    }
+
+                    return {};
+                }
+
+                TEST(TestPipeline, boundedQueue) {
+                    {
+                        BoundedQueue<int> queue("test bounded queue", 4);
+
+                        std::thread producer([&queue]() {
+                            for (int i = 0; i < 1000; ++i)
+                                ASSERT_TRUE(queue.push(i));
+
+                            queue.close();
+                        });
+
+                        int expected = 0;
+                        int item;
+
+                        // a single producer's items arrive in order
+                        while (queue.pop(item))
+                            ASSERT_EQ(item, expected++);
+
+                        producer.join();
+
+                        ASSERT_EQ(expected, 1000);
+                        ASSERT_FALSE(queue.push(1000));
+
+                        const auto stats = queue.currentStats();
+                        ASSERT_EQ(stats.items, 1000);
+                        ASSERT_LE(stats.maxDepth, 4);
+                        ASSERT_GT(stats.averageDepth, 0);
+                    }
+
+                    // the stats are recorded when the queue is destroyed
+                    ASSERT_EQ(findQueueStats("test bounded queue").items, 1000);
+                }
+
+                TEST(TestPipeline, abortUnblocksProducers) {
+                    BoundedQueue<int> queue("test aborted queue", 1);
+                    ASSERT_TRUE(queue.push(0));
+
+                    std::thread producer([&queue]() {
+                        // blocks until the queue is aborted
+                        ASSERT_FALSE(queue.push(1));
+                    });
+
+                    queue.abort();
+                    producer.join();
+
+                    int item;
+                    ASSERT_FALSE(queue.pop(item));
+                }
+
+                TEST(TestPipeline, statsOfQueuesWithTheSameNameAreSummedUp) {
+                    for (size_t i = 1; i <= 2; ++i) {
+                        BoundedQueue<int> queue("test summed up queue", 8);
+
+                        for (size_t j = 0; j < i * 2; ++j)
+                            queue.push(0);
+                    }
+
+                    const auto stats = findQueueStats("test summed up queue");
+                    ASSERT_EQ(stats.items, 6);
+                    ASSERT_EQ(stats.maxDepth, 4);
+
+                    // depths 1, 2 and 1, 2, 3, 4
+                    ASSERT_DOUBLE_EQ(stats.averageDepth, 13.0 / 6);
+                }
+
+                TEST(TestPipeline, sequenceWindow) {
+                    SequenceWindow window(2);
+
+                    ASSERT_TRUE(window.waitFor(0));
+                    ASSERT_TRUE(window.waitFor(1));
+
+                    std::atomic<bool> started(false);
+
+                    std::thread worker([&window, &started]() {
+                        // blocks until the first item has been put back in order
+                        ASSERT_TRUE(window.waitFor(2));
+                        started = true;
+                    });
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    ASSERT_FALSE(started);
+
+                    window.advance();
+                    worker.join();
+                    ASSERT_TRUE(started);
+
+                    std::thread abortedWorker([&window]() {
+                        ASSERT_FALSE(window.waitFor(5));
+                    });
+
+                    window.abort();
+                    abortedWorker.join();
+                }
+            }
+        }
+    }
+}
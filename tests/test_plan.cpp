@@ -0,0 +1,196 @@
+// system includes
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <linuxdeploy/core/appdir.h>
+
+// local includes
+#include "../src/appdir-proxy.h"
+#include "../src/plan.h"
+#include "../src/provenance.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestDeploymentPlan : public testing::Test {
+                public:
+                    bf::path tempDir;
+                    bf::path appDirPath;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-plan-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+                        appDirPath = tempDir / "AppDir";
+
+                        bf::create_directories(appDirPath / "usr/lib");
+                        bf::create_directories(tempDir / "qt/lib");
+                        std::ofstream((tempDir / "data.txt").string()) << "data";
+                        std::ofstream((tempDir / "qt/lib/libQt5Core.so.5").string()) << "core";
+                        std::ofstream((tempDir / "qt/lib/libQt5Gui.so.5").string()) << "gui";
+                        std::ofstream((appDirPath / "usr/lib/libexisting.so").string()) << "existing";
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(tempDir);
+                    }
+                };
+
+                TEST_F(TestDeploymentPlan, addStoresPathsRelativeToAppDir) {
+                    DeploymentPlan plan(appDirPath);
+                    plan.add("deployFile", tempDir / "data.txt", appDirPath / "usr/share/data.txt",
+                             appDirPath / "usr/share/", "step test");
+
+                    ASSERT_EQ(plan.files().size(), 1);
+
+                    const auto& file = plan.files().front();
+                    ASSERT_EQ(file.source, tempDir / "data.txt");
+                    ASSERT_EQ(file.destination, "usr/share/data.txt");
+                    ASSERT_EQ(file.passedDestination.string(), "usr/share/");
+                    ASSERT_EQ(file.bytes, 4);
+                    ASSERT_EQ(file.reason, "step test");
+                    ASSERT_EQ(plan.totalBytes(), 4);
+                }
+
+                TEST_F(TestDeploymentPlan, addDependencies) {
+                    DeploymentPlan plan(appDirPath);
+                    plan.add("deployLibrary", tempDir / "data.txt", appDirPath / "usr/plugins/libplugin.so", "", "");
+                    plan.add("deployFile", tempDir / "data.txt", appDirPath / "usr/share/data.txt", "", "");
+
+                    plan.addDependencies([this](const bf::path& path) -> std::vector<bf::path> {
+                        if (path.filename() != "data.txt")
+                            throw std::runtime_error("unexpected file traced");
+
+                        return {
+                            tempDir / "qt/lib/libQt5Core.so.5",
+                            tempDir / "qt/lib/libQt5Gui.so.5",
+                            tempDir / "qt/lib/libQt5Core.so.5",
+                            "/usr/lib/libexisting.so",
+                            "libnotfound.so",
+                        };
+                    });
+
+                    // only the library's dependencies which aren't there yet are added, once
+                    ASSERT_EQ(plan.files().size(), 4);
+                    ASSERT_EQ(plan.files()[2].operation, "dependency");
+                    ASSERT_EQ(plan.files()[2].destination, "usr/lib/libQt5Core.so.5");
+                    ASSERT_EQ(plan.files()[2].reason, "needed by file usr/plugins/libplugin.so");
+                    ASSERT_EQ(plan.files()[3].destination, "usr/lib/libQt5Gui.so.5");
+                    ASSERT_EQ(plan.totalBytes(), 4 + 4 + 4 + 3);
+                }
+
+                TEST_F(TestDeploymentPlan, jsonRoundTrip) {
+                    DeploymentPlan plan(appDirPath);
+                    plan.add("deployLibrary", tempDir / "qt/lib/libQt5Core.so.5",
+                             appDirPath / "usr/lib/libQt5Core.so.5", "", "module core");
+                    plan.add("createRelativeSymlink", appDirPath / "usr/qml/a.qm", appDirPath / "usr/translations/a.qm",
+                             appDirPath / "usr/translations/a.qm", "step deploy translations");
+                    plan.setLdLibraryPath("/opt/qt/lib");
+
+                    const auto json = plan.toJson();
+                    ASSERT_EQ(json["totals"]["files"].get<size_t>(), 2);
+                    ASSERT_EQ(json["totals"]["bytes"].get<size_t>(), 4);
+
+                    const auto parsed = DeploymentPlan::fromJson(json);
+                    ASSERT_EQ(parsed.ldLibraryPath(), "/opt/qt/lib");
+                    ASSERT_EQ(parsed.files().size(), 2);
+                    ASSERT_TRUE(parsed.files()[0].passedDestination.empty());
+                    ASSERT_EQ(parsed.files()[1].operation, "createRelativeSymlink");
+                    ASSERT_EQ(parsed.files()[1].source, "usr/qml/a.qm");
+                    ASSERT_EQ(parsed.files()[1].destination, "usr/translations/a.qm");
+                    ASSERT_EQ(parsed.files()[1].passedDestination, "usr/translations/a.qm");
+                    ASSERT_EQ(parsed.files()[1].reason, "step deploy translations");
+                }
+
+                TEST_F(TestDeploymentPlan, proxyRecordsOperationsWithoutDeploying) {
+                    core::appdir::AppDir appDir(appDirPath);
+                    AppDirProxy appDirProxy(appDir);
+
+                    DeploymentPlan plan(appDirPath);
+                    appDirProxy.planInto(plan);
+
+                    Provenance::instance().enable(appDirPath);
+
+                    {
+                        ProvenanceScope moduleScope({"module", "core"});
+                        ProvenanceScope stepScope({"step", "test"}, "run for");
+
+                        ASSERT_TRUE(appDirProxy.deployFile(tempDir / "data.txt", appDirPath / "usr/share/data/"));
+                        ASSERT_TRUE(appDirProxy.executeDeferredOperations());
+                    }
+
+                    ASSERT_FALSE(bf::exists(appDirPath / "usr/share/data/data.txt"));
+
+                    ASSERT_EQ(plan.files().size(), 1);
+                    ASSERT_EQ(plan.files().front().destination, "usr/share/data/data.txt");
+                    ASSERT_EQ(plan.files().front().passedDestination.string(), "usr/share/data/");
+                    ASSERT_EQ(plan.files().front().reason, "step test ← module core");
+                }
+
+                TEST_F(TestDeploymentPlan, filesWrittenByDeployersArePlannedAndApplied) {
+                    const std::string qtConf = "[Paths]\nPrefix = ../\n";
+
+                    DeploymentPlan plan(appDirPath);
+
+                    {
+                        core::appdir::AppDir appDir(appDirPath);
+                        AppDirProxy appDirProxy(appDir);
+                        appDirProxy.planInto(plan);
+
+                        // like WebEnginePluginsDeployer's qt.conf
+                        ASSERT_TRUE(appDirProxy.writeFile(appDirPath / "usr/libexec/qt.conf", qtConf));
+                    }
+
+                    ASSERT_FALSE(bf::exists(appDirPath / "usr/libexec"));
+
+                    const auto parsed = DeploymentPlan::fromJson(plan.toJson());
+                    ASSERT_EQ(parsed.files().size(), 1);
+                    ASSERT_EQ(parsed.files().front().operation, "writeFile");
+                    ASSERT_EQ(parsed.files().front().destination, "usr/libexec/qt.conf");
+                    ASSERT_EQ(parsed.files().front().contents, qtConf);
+                    ASSERT_EQ(parsed.totalBytes(), qtConf.size());
+
+                    const auto otherAppDirPath = tempDir / "OtherAppDir";
+                    core::appdir::AppDir otherAppDir(otherAppDirPath);
+                    AppDirProxy otherAppDirProxy(otherAppDir);
+
+                    ASSERT_TRUE(applyDeploymentPlan(otherAppDirProxy, parsed));
+
+                    std::ifstream ifs((otherAppDirPath / "usr/libexec/qt.conf").string());
+                    const std::string contents(std::istreambuf_iterator<char>(ifs), {});
+                    ASSERT_EQ(contents, qtConf);
+                }
+
+                TEST_F(TestDeploymentPlan, applyDeploymentPlan) {
+                    DeploymentPlan plan(tempDir / "PlannedAppDir");
+                    plan.add("deployFile", tempDir / "data.txt", tempDir / "PlannedAppDir/usr/share/data.txt",
+                             tempDir / "PlannedAppDir/usr/share/", "");
+                    plan.add("createRelativeSymlink", tempDir / "PlannedAppDir/usr/share/data.txt",
+                             tempDir / "PlannedAppDir/usr/share/link.txt", tempDir / "PlannedAppDir/usr/share/link.txt",
+                             "");
+                    plan.add("dependency", tempDir / "qt/lib/libQt5Core.so.5", "usr/lib/libQt5Core.so.5", "", "");
+
+                    core::appdir::AppDir appDir(appDirPath);
+                    appDir.setDisableCopyrightFilesDeployment(true);
+                    AppDirProxy appDirProxy(appDir);
+
+                    ASSERT_TRUE(applyDeploymentPlan(appDirProxy, plan));
+                    ASSERT_TRUE(appDir.executeDeferredOperations());
+
+                    // the plan's paths are relative to the AppDir it was made for, dependencies are left to linuxdeploy
+                    ASSERT_TRUE(bf::is_regular_file(appDirPath / "usr/share/data.txt"));
+                    ASSERT_TRUE(bf::is_symlink(appDirPath / "usr/share/link.txt"));
+                    ASSERT_FALSE(bf::exists(appDirPath / "usr/lib/libQt5Core.so.5"));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+// system includes
+#include <algorithm>
+#include <fstream>
+#include <random>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/plugin-costs.h"
+#include "../bench/stub-elf.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestPluginCosts : public testing::Test {
+                public:
+                    bf::path appDir;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-plugin-costs-XXXXXX";
+                        appDir = mkdtemp(tmpl);
+
+                        for (const auto& directory : {"usr/bin", "usr/lib", "usr/plugins/sqldrivers",
+                                                      "usr/plugins/tls", "usr/qml/Bench"}) {
+                            bf::create_directories(appDir / directory);
+                        }
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(appDir);
+                    }
+
+                    void writeLibrary(const std::string& soname, const std::vector<std::string>& needed,
+                                      size_t padding) {
+                        bench::writeStubElf(appDir / "usr/lib" / soname, soname, needed, padding);
+                    }
+
+                    static const PluginCost& findCost(const std::vector<PluginCost>& costs, const std::string& path) {
+                        const auto it = std::find_if(costs.begin(), costs.end(), [&path](const PluginCost& cost) {
+                            return cost.path == path;
+                        });
+
+                        EXPECT_NE(it, costs.end()) << path;
+                        return *it;
+                    }
+                };
+
+                TEST_F(TestPluginCosts, estimateCompressedSize) {
+                    const auto zeros = appDir / "zeros";
+                    const auto random = appDir / "random";
+
+                    std::ofstream(zeros.string()) << std::string(1024 * 1024, '\0');
+
+                    {
+                        std::mt19937 generator(42);
+                        std::string data(1024 * 1024, '\0');
+
+                        for (auto& c : data)
+                            c = static_cast<char>(generator());
+
+                        std::ofstream(random.string()) << data;
+                    }
+
+                    ASSERT_LT(estimateCompressedSize(zeros), 16 * 1024);
+
+                    // incompressible blocks are stored as they are
+                    ASSERT_EQ(estimateCompressedSize(random), 1024 * 1024);
+
+                    // sampling a single block of a uniform file gives the same estimate as compressing all of them
+                    ASSERT_NEAR(estimateCompressedSize(zeros, 1), estimateCompressedSize(zeros), 16);
+                }
+
+                TEST_F(TestPluginCosts, computePluginCosts) {
+                    writeLibrary("libQt5Core.so.5", {"libc.so.6"}, 4096);
+                    writeLibrary("libQt5Sql.so.5", {"libQt5Core.so.5"}, 4096);
+                    writeLibrary("libpq.so.5", {"libssl.so.1.1"}, 8192);
+                    writeLibrary("libssl.so.1.1", {"libcrypto.so.1.1"}, 16384);
+                    writeLibrary("libcrypto.so.1.1", {}, 32768);
+                    writeLibrary("libmysqlclient.so.21", {"libssl.so.1.1"}, 4096);
+
+                    // a symlink resolves to the library it points to
+                    bf::create_symlink("libpq.so.5", appDir / "usr/lib/libpq.so");
+
+                    bench::writeStubElf(appDir / "usr/bin/app", "", {"libQt5Sql.so.5", "libQt5Core.so.5"});
+                    bench::writeStubElf(appDir / "usr/plugins/sqldrivers/libqsqlpsql.so", "",
+                                        {"libpq.so", "libQt5Sql.so.5"}, 1024);
+                    bench::writeStubElf(appDir / "usr/plugins/sqldrivers/libqsqlmysql.so", "",
+                                        {"libmysqlclient.so.21", "libQt5Sql.so.5"}, 1024);
+                    bench::writeStubElf(appDir / "usr/plugins/tls/libqopensslbackend.so", "",
+                                        {"libssl.so.1.1", "libQt5Core.so.5"}, 1024);
+                    bench::writeStubElf(appDir / "usr/qml/Bench/libbenchplugin.so", "", {"libQt5Core.so.5"});
+
+                    std::ofstream((appDir / "usr/qml/Bench/qmldir").string()) << "module Bench";
+
+                    const auto costs = computePluginCosts(appDir);
+
+                    ASSERT_EQ(costs.size(), 4);
+
+                    const auto& psql = findCost(costs, "usr/plugins/sqldrivers/libqsqlpsql.so");
+                    ASSERT_EQ(psql.exclusiveLibraries.size(), 1);
+                    ASSERT_EQ(psql.exclusiveLibraries[0].path, "usr/lib/libpq.so.5");
+                    ASSERT_EQ(psql.exclusiveBytes, psql.bytes + bf::file_size(appDir / "usr/lib/libpq.so.5"));
+
+                    // libssl and libcrypto are needed by three plugins, the Qt libraries by the application
+                    ASSERT_EQ(psql.sharedLibraries.size(), 2);
+                    ASSERT_EQ(psql.sharedLibraries[0].path, "usr/lib/libcrypto.so.1.1");
+                    ASSERT_EQ(psql.sharedLibraries[0].users, 3);
+                    ASSERT_EQ(psql.sharedBytes, (bf::file_size(appDir / "usr/lib/libcrypto.so.1.1") / 3) +
+                                                (bf::file_size(appDir / "usr/lib/libssl.so.1.1") / 3));
+
+                    const auto& tls = findCost(costs, "usr/plugins/tls/libqopensslbackend.so");
+                    ASSERT_TRUE(tls.exclusiveLibraries.empty());
+                    ASSERT_EQ(tls.exclusiveBytes, tls.bytes);
+                    ASSERT_EQ(tls.sharedBytes, psql.sharedBytes);
+
+                    const auto& qml = findCost(costs, "usr/qml/Bench/libbenchplugin.so");
+                    ASSERT_TRUE(qml.exclusiveLibraries.empty());
+                    ASSERT_TRUE(qml.sharedLibraries.empty());
+
+                    // sorted by what excluding the plugin saves
+                    ASSERT_EQ(costs[0].path, "usr/plugins/sqldrivers/libqsqlpsql.so");
+                    ASSERT_EQ(costs[3].path, "usr/qml/Bench/libbenchplugin.so");
+
+                    const auto report = makePluginCostReport(costs);
+                    ASSERT_EQ(report["plugins"].size(), 4);
+                    ASSERT_EQ(report["plugins"][0]["exclusiveLibraries"][0]["path"], "usr/lib/libpq.so.5");
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,158 @@
+// system includes
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/process.h"
+#include "../src/progress.h"
+#include "../src/timeline.h"
+
+namespace bf = boost::filesystem;
+
+using namespace nlohmann;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestProgress : public testing::Test {
+                public:
+                    bf::path tempDir;
+                    int fds[2] = {-1, -1};
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-progress-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+
+                        ASSERT_EQ(pipe2(fds, O_NONBLOCK), 0);
+                        ASSERT_TRUE(ProgressEvents::instance().open(fds[1]));
+                    }
+
+                    void TearDown() override {
+                        ProgressEvents::instance().close();
+                        close(fds[0]);
+                        close(fds[1]);
+                        bf::remove_all(tempDir);
+                    }
+
+                    // returns the events written since the last call
+                    std::vector<json> readEvents() {
+                        std::string data;
+                        char buffer[4096];
+                        ssize_t bytesRead;
+
+                        while ((bytesRead = read(fds[0], buffer, sizeof(buffer))) > 0)
+                            data.append(buffer, static_cast<size_t>(bytesRead));
+
+                        std::vector<json> events;
+                        std::istringstream iss(data);
+                        std::string line;
+
+                        while (std::getline(iss, line))
+                            events.push_back(json::parse(line));
+
+                        return events;
+                    }
+                };
+
+                TEST_F(TestProgress, open_invalidFd) {
+                    ASSERT_FALSE(ProgressEvents::instance().open(-1));
+
+                    const auto fd = dup(fds[1]);
+                    close(fd);
+                    ASSERT_FALSE(ProgressEvents::instance().open(fd));
+                }
+
+                TEST_F(TestProgress, phasesAndProcesses) {
+                    {
+                        TimelineSpan span("test phase");
+                        TimelineSpan deployerSpan("TestDeployer", "deployer");
+                        ASSERT_EQ(runProcess({"true"}, nullptr, nullptr), 0);
+                    }
+
+                    const auto events = readEvents();
+
+                    // only phases are reported, other spans aren't
+                    ASSERT_EQ(events.size(), 4);
+                    ASSERT_EQ(events[0]["type"], "phaseStart");
+                    ASSERT_EQ(events[0]["phase"], "test phase");
+                    ASSERT_EQ(events[1]["type"], "processStart");
+                    ASSERT_EQ(events[1]["command"], "true");
+                    ASSERT_EQ(events[2]["type"], "processExit");
+                    ASSERT_EQ(events[2]["pid"], events[1]["pid"]);
+                    ASSERT_EQ(events[2]["exitCode"].get<int>(), 0);
+                    ASSERT_EQ(events[3]["type"], "phaseEnd");
+                    ASSERT_EQ(events[3]["phase"], "test phase");
+
+                    for (const auto& event : events)
+                        ASSERT_GE(event["time"].get<double>(), 0);
+                }
+
+                TEST_F(TestProgress, files) {
+                    const auto source = tempDir / "source";
+                    std::ofstream(source.string()) << std::string(100, 'x');
+
+                    auto& progressEvents = ProgressEvents::instance();
+                    progressEvents.fileQueued(source, tempDir / "deployed");
+                    progressEvents.fileQueued(source, tempDir / "skipped");
+                    progressEvents.fileQueued(source, tempDir / "link", true);
+
+                    auto events = readEvents();
+                    ASSERT_EQ(events.size(), 3);
+                    ASSERT_EQ(events[0]["type"], "fileQueued");
+                    ASSERT_EQ(events[0]["bytes"].get<uintmax_t>(), 100);
+                    ASSERT_EQ(events[2]["plannedFiles"].get<size_t>(), 3);
+                    ASSERT_EQ(events[2]["plannedBytes"].get<uintmax_t>(), 200);
+
+                    progressEvents.checkPendingFiles(false);
+                    ASSERT_TRUE(readEvents().empty());
+
+                    bf::copy_file(source, tempDir / "deployed");
+                    bf::create_symlink("nonexistent", tempDir / "link");
+                    progressEvents.checkPendingFiles(false);
+
+                    events = readEvents();
+                    ASSERT_EQ(events.size(), 2);
+                    ASSERT_EQ(events[0]["type"], "fileDeployed");
+                    ASSERT_EQ(events[0]["destination"], (tempDir / "deployed").string());
+                    ASSERT_EQ(events[0]["remainingFiles"].get<size_t>(), 2);
+                    ASSERT_EQ(events[0]["remainingBytes"].get<uintmax_t>(), 100);
+                    ASSERT_EQ(events[1]["destination"], (tempDir / "link").string());
+                    ASSERT_EQ(events[1]["remainingFiles"].get<size_t>(), 1);
+
+                    progressEvents.checkPendingFiles(true);
+
+                    events = readEvents();
+                    ASSERT_EQ(events.size(), 1);
+                    ASSERT_EQ(events[0]["type"], "fileSkipped");
+                    ASSERT_EQ(events[0]["remainingFiles"].get<size_t>(), 0);
+                    ASSERT_EQ(events[0]["remainingBytes"].get<uintmax_t>(), 0);
+                }
+
+                TEST_F(TestProgress, deferredOperations) {
+                    const auto source = tempDir / "source";
+                    std::ofstream(source.string()) << "x";
+
+                    ProgressEvents::instance().fileQueued(source, tempDir / "deployed");
+                    readEvents();
+
+                    {
+                        DeferredOperationsProgress progress(std::chrono::milliseconds(1));
+                        bf::copy_file(source, tempDir / "deployed");
+                    }
+
+                    // the file is reported by either the watcher or the final check, but only once
+                    const auto events = readEvents();
+                    ASSERT_EQ(events.size(), 1);
+                    ASSERT_EQ(events[0]["type"], "fileDeployed");
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+// system includes
+#include <sstream>
+#include <thread>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/provenance.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestProvenance : public testing::Test {
+                public:
+                    const bf::path appDir = "/tmp/linuxdeploy-plugin-qt-unit-tests-provenance/AppDir";
+
+                    void SetUp() override {
+                        Provenance::instance().enable(appDir);
+                    }
+
+                    static std::string explain(const bf::path& path) {
+                        std::ostringstream oss;
+                        Provenance::instance().explain(path, oss);
+                        return oss.str();
+                    }
+                };
+
+                TEST_F(TestProvenance, fileNode) {
+                    auto& provenance = Provenance::instance();
+
+                    ASSERT_EQ(provenance.fileNode(appDir / "usr/lib/libfoo.so").name, "usr/lib/libfoo.so");
+                    ASSERT_EQ(provenance.fileNode("./usr/plugins/platforms/").name, "usr/plugins/platforms");
+                    ASSERT_EQ(provenance.fileNode("/usr/lib/libfoo.so").name, "/usr/lib/libfoo.so");
+                }
+
+                TEST_F(TestProvenance, scopes) {
+                    auto& provenance = Provenance::instance();
+
+                    provenance.addReason({"module", "scopes-sql"}, {"library", "libQt5Sql.so.5"}, "detected from");
+                    provenance.addReason({"library", "libQt5Sql.so.5"}, {"file", "usr/bin/app"}, "needed by");
+
+                    {
+                        ProvenanceScope moduleScope({"module", "scopes-sql"});
+                        ProvenanceScope deployerScope({"deployer", "SqlPluginsDeployer"}, "run for");
+
+                        provenance.fileDeployed(appDir / "usr/plugins/sqldrivers/libqsqlite.so");
+                    }
+
+                    // outside of any scope, there's no reason to record
+                    provenance.fileDeployed(appDir / "usr/plugins/sqldrivers/libqsqlpsql.so");
+                    ASSERT_TRUE(provenance.reasonsFor({"file", "usr/plugins/sqldrivers/libqsqlpsql.so"}).empty());
+
+                    const auto reasons = provenance.reasonsFor({"file", "usr/plugins/sqldrivers/libqsqlite.so"});
+                    ASSERT_EQ(reasons.size(), 1);
+                    ASSERT_EQ(reasons.begin()->node.kind, "deployer");
+                    ASSERT_EQ(reasons.begin()->relation, "deployed by");
+
+                    const auto explanation = explain("usr/plugins/sqldrivers/libqsqlite.so");
+                    ASSERT_NE(explanation.find("← deployed by deployer SqlPluginsDeployer"), std::string::npos);
+                    ASSERT_NE(explanation.find("← run for module scopes-sql"), std::string::npos);
+                    ASSERT_NE(explanation.find("← detected from library libQt5Sql.so.5"), std::string::npos);
+                    ASSERT_NE(explanation.find("← needed by file usr/bin/app"), std::string::npos);
+                }
+
+                TEST_F(TestProvenance, scopesArePerThread) {
+                    auto& provenance = Provenance::instance();
+
+                    ProvenanceScope scope({"step", "main thread step"});
+
+                    std::thread([&provenance, this]() {
+                        provenance.fileDeployed(appDir / "usr/translations/qt_de.qm");
+                    }).join();
+
+                    ASSERT_TRUE(provenance.reasonsFor({"file", "usr/translations/qt_de.qm"}).empty());
+                }
+
+                TEST_F(TestProvenance, explainLibraryAndUnknownFiles) {
+                    auto& provenance = Provenance::instance();
+
+                    provenance.addReason({"library", "libicudata.so.60"}, {"file", "usr/lib/libQt5Core.so.5"},
+                                         "needed by");
+
+                    // linuxdeploy deployed the library, which was found while tracing the AppDir
+                    const auto explanation = explain(appDir / "usr/lib/libicudata.so.60");
+                    ASSERT_NE(explanation.find("← is library libicudata.so.60"), std::string::npos);
+                    ASSERT_NE(explanation.find("← needed by file usr/lib/libQt5Core.so.5"), std::string::npos);
+
+                    ASSERT_NE(explain("usr/share/unknown.txt").find("no reasons recorded"), std::string::npos);
+                }
+
+                TEST_F(TestProvenance, explainAbbreviatesAndStopsAtCycles) {
+                    auto& provenance = Provenance::instance();
+
+                    for (const auto& user : {"a", "b", "c", "d", "e"})
+                        provenance.addReason({"library", "libcycle.so"}, {"file", user}, "needed by");
+
+                    provenance.addReason({"file", "a"}, {"library", "libcycle.so"}, "deployed by");
+
+                    const auto explanation = explain("usr/lib/libcycle.so");
+                    ASSERT_NE(explanation.find("... and 2 more"), std::string::npos);
+                    ASSERT_EQ(explanation.find("file e"), std::string::npos);
+                }
+
+                TEST_F(TestProvenance, export) {
+                    auto& provenance = Provenance::instance();
+
+                    provenance.addReason({"file", "usr/qml/Export/qmldir"}, {"import", "Export 1.0"}, "deployed by");
+
+                    const auto graph = provenance.toJson();
+                    ASSERT_EQ(graph["formatVersion"], 1);
+
+                    bool found = false;
+
+                    for (const auto& edge : graph["edges"]) {
+                        const auto& from = graph["nodes"][edge["from"].get<size_t>()];
+                        const auto& to = graph["nodes"][edge["to"].get<size_t>()];
+
+                        if (from["name"] == "usr/qml/Export/qmldir") {
+                            ASSERT_EQ(to["kind"], "import");
+                            ASSERT_EQ(to["name"], "Export 1.0");
+                            ASSERT_EQ(edge["relation"], "deployed by");
+                            found = true;
+                        }
+                    }
+
+                    ASSERT_TRUE(found);
+
+                    std::ostringstream dot;
+                    provenance.writeDot(dot);
+                    ASSERT_EQ(dot.str().find("digraph provenance {"), 0);
+                    ASSERT_NE(dot.str().find("[label=\"import\\nExport 1.0\"]"), std::string::npos);
+                    ASSERT_NE(dot.str().find("[label=\"deployed by\"]"), std::string::npos);
+                }
+            }
+        }
+    }
+}
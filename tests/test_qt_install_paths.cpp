@@ -0,0 +1,187 @@
+// system includes
+#include <algorithm>
+#include <fstream>
+#include <sys/stat.h>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/qt-install-paths.h"
+#include "../src/util.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestQtInstallPaths : public testing::Test {
+                public:
+                    bf::path prefix;
+                    bf::path qmakePath;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-qt-XXXXXX";
+                        prefix = mkdtemp(tmpl);
+
+                        for (const auto& dir : {"bin", "lib", "plugins"})
+                            bf::create_directories(prefix / dir);
+
+                        qmakePath = prefix / "bin" / "qmake";
+                        writeFile(qmakePath, "");
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(prefix);
+                    }
+
+                    static void writeFile(const bf::path& path, const std::string& contents) {
+                        std::ofstream ofs(path.string(), std::ios::binary);
+                        ofs << contents;
+                    }
+                };
+
+                TEST_F(TestQtInstallPaths, qt_conf) {
+                    bf::create_directories(prefix / "lib" / "qt5" / "plugins");
+                    writeFile(prefix / "bin" / "qt.conf", "[Paths]\nPrefix = ..\nPlugins=lib/qt5/plugins\n");
+
+                    bf::path source;
+                    auto paths = readQtInstallPaths(qmakePath, source);
+
+                    ASSERT_EQ(source, prefix / "bin" / "qt.conf");
+                    ASSERT_EQ(paths["QT_INSTALL_PREFIX"], prefix.string());
+                    ASSERT_EQ(paths["QT_INSTALL_BINS"], (prefix / "bin").string());
+                    ASSERT_EQ(paths["QT_INSTALL_LIBS"], (prefix / "lib").string());
+                    ASSERT_EQ(paths["QT_INSTALL_PLUGINS"], (prefix / "lib" / "qt5" / "plugins").string());
+                    ASSERT_EQ(paths["QT_INSTALL_QML"], (prefix / "qml").string());
+                    ASSERT_EQ(paths["QT_INSTALL_DATA"], prefix.string());
+                    ASSERT_EQ(paths["QT_INSTALL_TRANSLATIONS"], (prefix / "translations").string());
+                }
+
+                TEST_F(TestQtInstallPaths, qt_conf_unsupported) {
+                    writeFile(prefix / "bin" / "qt.conf", "[Paths]\nPrefix=..\nSysroot=/opt/sysroot\n");
+
+                    bf::path source;
+                    ASSERT_TRUE(readQtInstallPaths(qmakePath, source).empty());
+                    ASSERT_TRUE(source.empty());
+                }
+
+                TEST_F(TestQtInstallPaths, compiled_prefix) {
+                    for (const auto& dir : {"qml", "translations", "libexec"})
+                        bf::create_directories(prefix / dir);
+
+                    writeFile(prefix / "lib" / "libQt5Core.so.5.15.2",
+                              std::string("\x7f" "ELF\0\0qt_prfxpath=", 18) + prefix.string() + std::string(16, '\0'));
+
+                    bf::path source;
+                    auto paths = readQtInstallPaths(qmakePath, source);
+
+                    ASSERT_EQ(source, prefix / "lib" / "libQt5Core.so.5.15.2");
+                    ASSERT_EQ(paths["QT_INSTALL_PLUGINS"], (prefix / "plugins").string());
+                    ASSERT_EQ(paths["QT_INSTALL_LIBEXECS"], (prefix / "libexec").string());
+                }
+
+                TEST_F(TestQtInstallPaths, compiled_prefix_with_custom_layout) {
+                    // e.g., configured with -qmldir /usr/lib/qt5/qml, there's no qml directory below the prefix
+                    for (const auto& dir : {"translations", "libexec"})
+                        bf::create_directories(prefix / dir);
+
+                    writeFile(prefix / "lib" / "libQt5Core.so.5",
+                              std::string("qt_prfxpath=", 12) + prefix.string() + std::string(16, '\0'));
+
+                    bf::path source;
+                    ASSERT_TRUE(readQtInstallPaths(qmakePath, source).empty());
+                    ASSERT_TRUE(source.empty());
+                }
+
+                TEST_F(TestQtInstallPaths, compiled_prefix_of_other_installation) {
+                    // e.g., an installation which has been moved after building
+                    writeFile(prefix / "lib" / "libQt5Core.so.5",
+                              std::string("qt_prfxpath=/nonexistent/qt", 27) + std::string(16, '\0'));
+
+                    bf::path source;
+                    ASSERT_TRUE(readQtInstallPaths(qmakePath, source).empty());
+                }
+
+                TEST_F(TestQtInstallPaths, no_qt_core) {
+                    bf::path source;
+                    ASSERT_TRUE(readQtInstallPaths(qmakePath, source).empty());
+                }
+
+                TEST_F(TestQtInstallPaths, parseQmakeQueryOutput) {
+                    auto vars = parseQmakeQueryOutput("QT_INSTALL_LIBS:/opt/qt/lib\n"
+                                                      "QT_HOST_DATA:C:/Qt/5.15.2\n"
+                                                      "QT_SYSROOT:\n"
+                                                      "malformed\n");
+
+                    ASSERT_EQ(vars.size(), 3);
+                    ASSERT_EQ(vars["QT_INSTALL_LIBS"], "/opt/qt/lib");
+                    ASSERT_EQ(vars["QT_HOST_DATA"], "C:/Qt/5.15.2");
+                    ASSERT_EQ(vars["QT_SYSROOT"], "");
+                }
+
+                TEST_F(TestQtInstallPaths, parseQmakeQueryOutputCollectsWarnings) {
+                    std::vector<std::string> warnings;
+                    auto vars = parseQmakeQueryOutput("QT_INSTALL_LIBS:/opt/qt/lib\nmalformed\n", &warnings);
+
+                    ASSERT_EQ(vars.size(), 1);
+                    ASSERT_EQ(warnings, std::vector<std::string>{
+                        "Ignoring malformed line in qmake -query output: malformed"
+                    });
+                }
+
+                TEST_F(TestQtInstallPaths, queryQmakeCached) {
+                    // qmake stand-in which counts its calls
+                    writeFile(qmakePath, "#!/bin/sh\n"
+                                         "echo called >> \"$(dirname \"$0\")/calls\"\n"
+                                         "echo QT_INSTALL_LIBS:" + (prefix / "lib").string() + "\n");
+                    chmod(qmakePath.c_str(), 0755);
+
+                    const auto qtCorePath = prefix / "lib" / "libQt5Core.so.5";
+                    writeFile(qtCorePath, "a");
+
+                    DiskCache cache(prefix / "cache");
+                    bool fromCache;
+
+                    auto countCalls = [this]() {
+                        std::ifstream ifs((prefix / "bin" / "calls").string());
+                        return std::count(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>(), '\n');
+                    };
+
+                    auto vars = queryQmakeCached(qmakePath, cache, fromCache);
+                    ASSERT_FALSE(fromCache);
+                    ASSERT_EQ(vars["QT_INSTALL_LIBS"], (prefix / "lib").string());
+
+                    ASSERT_EQ(queryQmakeCached(qmakePath, cache, fromCache), vars);
+                    ASSERT_TRUE(fromCache);
+                    ASSERT_EQ(countCalls(), 1);
+
+                    // updating QtCore invalidates the entry
+                    writeFile(qtCorePath, "ab");
+
+                    ASSERT_EQ(queryQmakeCached(qmakePath, cache, fromCache), vars);
+                    ASSERT_FALSE(fromCache);
+                    ASSERT_EQ(countCalls(), 2);
+
+                    // so does adding or editing qt.conf, which qmake reads
+                    writeFile(prefix / "bin" / "qt.conf", "[Paths]\nPrefix=$QT_PREFIX\n");
+
+                    ASSERT_EQ(queryQmakeCached(qmakePath, cache, fromCache), vars);
+                    ASSERT_FALSE(fromCache);
+                    ASSERT_EQ(countCalls(), 3);
+
+                    writeFile(prefix / "bin" / "qt.conf", "[Paths]\nPrefix=$OTHER_QT_PREFIX\n");
+
+                    ASSERT_EQ(queryQmakeCached(qmakePath, cache, fromCache), vars);
+                    ASSERT_FALSE(fromCache);
+                    ASSERT_EQ(countCalls(), 4);
+
+                    ASSERT_EQ(queryQmakeCached(qmakePath, cache, fromCache), vars);
+                    ASSERT_TRUE(fromCache);
+                }
+            }
+        }
+    }
+}
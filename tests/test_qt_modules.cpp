@@ -0,0 +1,88 @@
+// system includes
+#include <cstring>
+#include <fstream>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/qt-module-matcher.h"
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                TEST(TestQtModules, lookup_tables) {
+                    for (QtModuleId id = 0; id < QtModulesCount; ++id) {
+                        const auto& module = QtModules[id];
+
+                        ASSERT_EQ(findQtModuleByName(module.name, strlen(module.name)), id);
+                        ASSERT_EQ(findQtModuleByLibraryPrefix(module.libraryFilePrefix, strlen(module.libraryFilePrefix)), id);
+                    }
+
+                    // lookups must compare the whole key
+                    ASSERT_EQ(findQtModuleByName("cor", 3), QtModulesCount);
+                    ASSERT_EQ(findQtModuleByName("corex", 5), QtModulesCount);
+                    ASSERT_EQ(findQtModuleByLibraryPrefix("libQt5Core.so", 13), QtModulesCount);
+                }
+
+                TEST(TestQtModules, qtModuleId) {
+                    static_assert(qtModuleId("3danimation") == 0, "module IDs must be stable");
+                    static_assert(qtModuleId("nosuchmodule") == QtModulesCount, "unknown modules must not be found");
+
+                    ASSERT_STREQ(QtModules[qtModuleId("gui")].name, "gui");
+                }
+
+                TEST(TestQtModules, match_library_filename) {
+                    ASSERT_EQ(matchQtModule("libQt5Core.so.5"), qtModuleId("core"));
+
+                    // the prefix must be followed by a dot
+                    ASSERT_EQ(matchQtModule("libQt5WebEngineCore.so.5"), qtModuleId("webenginecore"));
+                    ASSERT_EQ(matchQtModule("libQt5WebEngine.so.5"), qtModuleId("webengine"));
+
+                    ASSERT_EQ(matchQtModule("libQt5Coreutils.so.5"), QtModulesCount);
+                    ASSERT_EQ(matchQtModule("libc.so.6"), QtModulesCount);
+                }
+
+                TEST(TestQtModules, match_module_name) {
+                    ASSERT_EQ(matchQtModule("sql"), qtModuleId("sql"));
+
+                    ASSERT_EQ(matchQtModule("libQt5Sql"), QtModulesCount);
+                    ASSERT_EQ(matchQtModule("nosuchmodule"), QtModulesCount);
+                }
+
+                TEST(TestQtModules, findQtModules) {
+                    const std::set<std::string> libraryNames{
+                        "libc.so.6", "libQt5Widgets.so.5", "libQt5Core.so.5", "libQt5Gui.so.5", "libQt5Core.so.5.12.3"
+                    };
+
+                    // no duplicates, in module table order
+                    const std::vector<std::string> expected{"core", "gui", "widgets"};
+                    ASSERT_EQ(qtModuleNames(findQtModules(libraryNames)), expected);
+                }
+
+                TEST(TestQtModules, findQtModulesForArguments) {
+                    const auto tempDir = boost::filesystem::temp_directory_path() /
+                                         boost::filesystem::unique_path("linuxdeploy-plugin-qt-unit-tests-%%%%-%%%%");
+                    const auto libraryPath = tempDir / "libQt5Svg.so.5";
+
+                    boost::filesystem::create_directories(tempDir);
+                    std::ofstream(libraryPath.string()) << "not really a library";
+
+                    // paths are only matched if they point to an existing file
+                    const std::vector<std::string> arguments{
+                        "sql", libraryPath.string(), "/no/such/dir/libQt5Xml.so.5", "libQt5Network.so", "sql"
+                    };
+
+                    const std::vector<std::string> expected{"network", "sql", "svg"};
+                    const auto modules = findQtModulesForArguments(arguments);
+
+                    boost::filesystem::remove_all(tempDir);
+
+                    ASSERT_EQ(qtModuleNames(modules), expected);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// system includes
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/staging.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestStagingMerge : public testing::Test {
+                public:
+                    bf::path tempDir;
+                    bf::path appDirPath;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-staging-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+                        appDirPath = tempDir / "AppDir";
+
+                        bf::create_directories(appDirPath);
+                    }
+
+                    void TearDown() override {
+                        bf::remove_all(tempDir);
+                    }
+
+                    void writeFile(const bf::path& path, const std::string& contents) {
+                        bf::create_directories(path.parent_path());
+                        std::ofstream(path.string()) << contents;
+                    }
+
+                    static std::string readFile(const bf::path& path) {
+                        std::ifstream ifs(path.string());
+                        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+                    }
+                };
+
+                TEST_F(TestStagingMerge, movesFilesAndSymlinks) {
+                    const auto staging = tempDir / "worker-0";
+                    writeFile(staging / "usr/plugins/platforms/libqxcb.so", "xcb");
+                    bf::create_symlink("libqxcb.so", staging / "usr/plugins/platforms/libqxcb.so.5");
+
+                    StagingMerge merge(appDirPath);
+                    merge.addStagingDirectory(staging);
+                    ASSERT_TRUE(merge.merge());
+
+                    ASSERT_EQ(readFile(appDirPath / "usr/plugins/platforms/libqxcb.so"), "xcb");
+                    ASSERT_EQ(bf::read_symlink(appDirPath / "usr/plugins/platforms/libqxcb.so.5"), "libqxcb.so");
+                    ASSERT_FALSE(bf::exists(staging / "usr/plugins/platforms/libqxcb.so"));
+                    ASSERT_EQ(merge.movedFilesCount(), 2);
+                }
+
+                TEST_F(TestStagingMerge, identicalCopiesAreMergedOnce) {
+                    writeFile(tempDir / "worker-0/usr/lib/libQt5Core.so.5", "core");
+                    writeFile(tempDir / "worker-1/usr/lib/libQt5Core.so.5", "core");
+
+                    StagingMerge merge(appDirPath);
+                    merge.addStagingDirectory(tempDir / "worker-0");
+                    merge.addStagingDirectory(tempDir / "worker-1");
+                    ASSERT_TRUE(merge.merge());
+
+                    ASSERT_EQ(readFile(appDirPath / "usr/lib/libQt5Core.so.5"), "core");
+
+                    ASSERT_EQ(merge.movedFilesCount(), 1);
+                    ASSERT_EQ(merge.identicalFilesCount(), 1);
+                    ASSERT_EQ(merge.conflictingFilesCount(), 0);
+                }
+
+                TEST_F(TestStagingMerge, differingCopiesConflict) {
+                    writeFile(tempDir / "worker-0/usr/qml/QtQuick/qmldir", "module QtQuick");
+                    writeFile(tempDir / "worker-1/usr/qml/QtQuick/qmldir", "module QtQuick.Other");
+                    writeFile(tempDir / "worker-1/usr/qml/QtQml/qmldir", "module QtQml");
+
+                    StagingMerge merge(appDirPath);
+                    merge.addStagingDirectory(tempDir / "worker-0");
+                    merge.addStagingDirectory(tempDir / "worker-1");
+                    ASSERT_FALSE(merge.merge());
+
+                    // nothing is moved, not even the files without conflicts
+                    ASSERT_TRUE(bf::is_empty(appDirPath));
+                    ASSERT_TRUE(bf::exists(tempDir / "worker-1/usr/qml/QtQml/qmldir"));
+                    ASSERT_EQ(merge.movedFilesCount(), 0);
+                    ASSERT_EQ(merge.conflictingFilesCount(), 1);
+                }
+
+                TEST_F(TestStagingMerge, existingFilesAreLeftAlone) {
+                    writeFile(appDirPath / "usr/lib/libQt5Gui.so.5", "deployed by linuxdeploy");
+                    writeFile(tempDir / "worker-0/usr/lib/libQt5Gui.so.5", "deployed by worker");
+
+                    StagingMerge merge(appDirPath);
+                    merge.addStagingDirectory(tempDir / "worker-0");
+                    ASSERT_TRUE(merge.merge());
+
+                    ASSERT_EQ(readFile(appDirPath / "usr/lib/libQt5Gui.so.5"), "deployed by linuxdeploy");
+                    ASSERT_EQ(merge.movedFilesCount(), 0);
+                    ASSERT_EQ(merge.conflictingFilesCount(), 0);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+// system includes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// library includes
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/task-pool.h"
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestTaskPool : public testing::Test {
+                public:
+                    void SetUp() override {
+                        // the pool is started once per process, the other tests run on it as well
+                        TaskPool::instance().start(4);
+                    }
+                };
+
+                TEST_F(TestTaskPool, parallelFor) {
+                    const size_t count = 1000;
+                    std::vector<std::atomic<int>> calls(count);
+
+                    for (auto& callsCount : calls)
+                        callsCount = 0;
+
+                    TaskPool::instance().parallelFor(count, [&calls](size_t i) {
+                        ++calls[i];
+                    });
+
+                    for (size_t i = 0; i < count; ++i)
+                        ASSERT_EQ(calls[i], 1) << i;
+
+                    // nothing to do
+                    TaskPool::instance().parallelFor(0, [](size_t) {
+                        FAIL();
+                    });
+                }
+
+                TEST_F(TestTaskPool, parallelForRethrows) {
+                    std::atomic<size_t> calls(0);
+
+                    ASSERT_THROW(TaskPool::instance().parallelFor(100, [&calls](size_t i) {
+                        ++calls;
+
+                        if (i == 42)
+                            throw std::runtime_error("failed");
+                    }), std::runtime_error);
+
+                    // the other calls aren't cancelled
+                    ASSERT_EQ(calls, 100);
+                }
+
+                TEST_F(TestTaskPool, nestedParallelFor) {
+                    std::atomic<size_t> calls(0);
+
+                    TaskPool::instance().parallelFor(8, [&calls](size_t) {
+                        TaskPool::instance().parallelFor(8, [&calls](size_t) {
+                            ++calls;
+                        });
+                    });
+
+                    ASSERT_EQ(calls, 64);
+                }
+
+                TEST_F(TestTaskPool, runInOrderTasksMayWaitForEarlierOnes) {
+                    const size_t count = 16;
+
+                    std::mutex mutex;
+                    std::condition_variable condition;
+                    size_t turn = 0;
+                    std::vector<size_t> order;
+
+                    std::vector<std::function<void()>> tasks;
+
+                    for (size_t i = 0; i < count; ++i) {
+                        tasks.emplace_back([&, i]() {
+                            // work which doesn't depend on the others first
+                            std::this_thread::sleep_for(std::chrono::milliseconds((count - i) % 3));
+
+                            std::unique_lock<std::mutex> lock(mutex);
+                            condition.wait(lock, [&turn, i]() { return turn == i; });
+
+                            order.push_back(i);
+                            ++turn;
+                            condition.notify_all();
+                        });
+                    }
+
+                    TaskPool::instance().runInOrder(tasks);
+
+                    ASSERT_EQ(order.size(), count);
+
+                    for (size_t i = 0; i < count; ++i)
+                        ASSERT_EQ(order[i], i);
+                }
+
+                TEST_F(TestTaskPool, runInOrderRethrows) {
+                    std::atomic<size_t> calls(0);
+                    std::vector<std::function<void()>> tasks;
+
+                    for (size_t i = 0; i < 10; ++i) {
+                        tasks.emplace_back([&calls, i]() {
+                            ++calls;
+
+                            if (i == 3)
+                                throw std::runtime_error("failed");
+                        });
+                    }
+
+                    ASSERT_THROW(TaskPool::instance().runInOrder(tasks), std::runtime_error);
+                    ASSERT_EQ(calls, 10);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,123 @@
+// system includes
+#include <fstream>
+#include <sys/stat.h>
+
+// library includes
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/process.h"
+#include "../src/util.h"
+
+namespace bf = boost::filesystem;
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                class TestUtil : public testing::Test {
+                public:
+                    bf::path tempDir;
+                    std::string originalPath;
+
+                    void SetUp() override {
+                        char tmpl[] = "/tmp/linuxdeploy-plugin-qt-unit-tests-util-XXXXXX";
+                        tempDir = mkdtemp(tmpl);
+
+                        for (const auto& dir : {"a", "b"})
+                            bf::create_directories(tempDir / dir);
+
+                        originalPath = getenv("PATH");
+                    }
+
+                    void TearDown() override {
+                        setenv("PATH", originalPath.c_str(), true);
+                        bf::remove_all(tempDir);
+                    }
+
+                    static void createFile(const bf::path& path, mode_t mode) {
+                        std::ofstream ofs(path.string());
+                        ofs.close();
+                        chmod(path.c_str(), mode);
+                    }
+                };
+
+                TEST_F(TestUtil, which) {
+                    createFile(tempDir / "a" / "tool", 0644);
+                    createFile(tempDir / "b" / "tool", 0755);
+
+                    // non-executable files are skipped
+                    setenv("PATH", ((tempDir / "a").string() + ":" + (tempDir / "b").string()).c_str(), true);
+                    ASSERT_EQ(which("tool"), tempDir / "b" / "tool");
+                    ASSERT_TRUE(which("missing-tool").empty());
+
+                    // results depend on the current $PATH
+                    setenv("PATH", (tempDir / "a").string().c_str(), true);
+                    ASSERT_TRUE(which("tool").empty());
+                }
+
+                TEST_F(TestUtil, which_trailing_colon) {
+                    createFile(tempDir / "a" / "tool", 0755);
+
+                    const auto previousWorkingDirectory = bf::current_path();
+                    bf::current_path(tempDir / "a");
+
+                    // a trailing empty entry refers to the current working directory, like a leading or doubled one
+                    setenv("PATH", ((tempDir / "b").string() + ":").c_str(), true);
+                    const auto result = which("tool");
+
+                    bf::current_path(previousWorkingDirectory);
+
+                    ASSERT_EQ(result, bf::path("./tool"));
+                }
+
+                TEST_F(TestUtil, which_path) {
+                    createFile(tempDir / "a" / "tool", 0755);
+
+                    ASSERT_EQ(which((tempDir / "a" / "tool").string()), tempDir / "a" / "tool");
+                    ASSERT_TRUE(which((tempDir / "b" / "tool").string()).empty());
+                }
+
+                TEST_F(TestUtil, runProcess) {
+                    // arguments are passed as they are, without a shell
+                    std::string out;
+                    std::vector<std::string> errLines;
+
+                    const auto returnCode = runProcess(
+                        {"sh", "-c", "printf '%s' \"$1\"; printf 'a\\nb' >&2; exit 3", "sh", "with space; 'quotes'"},
+                        [&out](const char* data, size_t size) { out.append(data, size); },
+                        forEachLine([&errLines](const std::string& line) { errLines.push_back(line); })
+                    );
+
+                    ASSERT_EQ(returnCode, 3);
+                    ASSERT_EQ(out, "with space; 'quotes'");
+                    ASSERT_EQ(errLines, (std::vector<std::string>{"a", "b"}));
+                }
+
+                TEST_F(TestUtil, runProcess_large_output) {
+                    // more than fits into the pipes, on both streams
+                    size_t outSize = 0;
+                    size_t errSize = 0;
+
+                    const auto returnCode = runProcess(
+                        {"sh", "-c", "head -c 4000000 /dev/zero; head -c 3000000 /dev/zero >&2"},
+                        [&outSize](const char*, size_t size) { outSize += size; },
+                        [&errSize](const char*, size_t size) { errSize += size; }
+                    );
+
+                    ASSERT_EQ(returnCode, 0);
+                    ASSERT_EQ(outSize, 4000000);
+                    ASSERT_EQ(errSize, 3000000);
+                }
+
+                TEST_F(TestUtil, check_command_missing_executable) {
+                    const auto output = check_command({(tempDir / "missing").string()});
+
+                    ASSERT_FALSE(output.success);
+                    ASSERT_FALSE(output.stderrOutput.empty());
+                }
+            }
+        }
+    }
+}
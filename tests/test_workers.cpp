@@ -0,0 +1,89 @@
+// system includes
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// library includes
+#include <gtest/gtest.h>
+
+// local includes
+#include "../src/workers.h"
+
+namespace linuxdeploy {
+    namespace plugin {
+        namespace qt {
+            namespace test {
+                TEST(TestWorkers, planWorkerJobsSpreadsDeployersRoundRobin) {
+                    const std::vector<WorkerDeployer> deployers{
+                        {"gui", 0, false}, {"gui", 1, false}, {"network", 0, false}, {"sql", 0, false},
+                    };
+
+                    const auto jobs = planWorkerJobs(deployers, 2);
+
+                    ASSERT_EQ(jobs.size(), 2);
+                    ASSERT_EQ(jobs[0].deployers, (std::vector<std::pair<std::string, size_t>>{{"gui", 0}, {"network", 0}}));
+                    ASSERT_EQ(jobs[1].deployers, (std::vector<std::pair<std::string, size_t>>{{"gui", 1}, {"sql", 0}}));
+                }
+
+                TEST(TestWorkers, planWorkerJobsRunsShardedDeployersInEveryJob) {
+                    const std::vector<WorkerDeployer> deployers{{"network", 0, false}, {"qml", 0, true}};
+
+                    std::vector<QmlModuleImport> qmlImports(4);
+
+                    for (size_t i = 0; i < qmlImports.size(); ++i)
+                        qmlImports[i].name = "Module" + std::to_string(i);
+
+                    const auto jobs = planWorkerJobs(deployers, 3, qmlImports);
+
+                    ASSERT_EQ(jobs.size(), 3);
+
+                    for (const auto& job : jobs)
+                        ASSERT_EQ(job.deployers.back(), std::make_pair(std::string("qml"), size_t(0)));
+
+                    ASSERT_EQ(jobs[0].deployers.size(), 2);
+                    ASSERT_EQ(jobs[1].deployers.size(), 1);
+
+                    // the imports are split between the jobs
+                    ASSERT_EQ(jobs[0].qmlImports.size(), 2);
+                    ASSERT_EQ(jobs[0].qmlImports[0].name, "Module0");
+                    ASSERT_EQ(jobs[0].qmlImports[1].name, "Module3");
+                    ASSERT_EQ(jobs[1].qmlImports.size(), 1);
+                    ASSERT_EQ(jobs[1].qmlImports[0].name, "Module1");
+                    ASSERT_EQ(jobs[2].qmlImports.size(), 1);
+                }
+
+                TEST(TestWorkers, planWorkerJobsStartsNoIdleWorkers) {
+                    const auto jobs = planWorkerJobs({{"network", 0, false}, {"sql", 0, false}}, 8);
+                    ASSERT_EQ(jobs.size(), 2);
+                }
+
+                TEST(TestWorkers, workerJobJsonRoundTrip) {
+                    WorkerJob job;
+                    job.stagingAppDir = "/tmp/staging/worker-1";
+                    job.qtPaths = {{"QT_INSTALL_PLUGINS", "/usr/lib/qt5/plugins"}};
+                    job.deployers = {{"gui", 1}, {"qml", 0}};
+                    job.qmlImports = {{"QtQuick", "/usr/lib/qt5/qml/QtQuick.2", "QtQuick.2", "2.12"}};
+
+                    const auto parsed = workerJobFromJson(workerJobToJson(job));
+
+                    ASSERT_EQ(parsed.stagingAppDir, job.stagingAppDir);
+                    ASSERT_EQ(parsed.qtPaths, job.qtPaths);
+                    ASSERT_EQ(parsed.deployers, job.deployers);
+                    ASSERT_EQ(parsed.qmlImports.size(), 1);
+                    ASSERT_EQ(parsed.qmlImports[0].name, "QtQuick");
+                    ASSERT_EQ(parsed.qmlImports[0].path, "/usr/lib/qt5/qml/QtQuick.2");
+                    ASSERT_EQ(parsed.qmlImports[0].relativePath, "QtQuick.2");
+                    ASSERT_EQ(parsed.qmlImports[0].version, "2.12");
+                }
+
+                TEST(TestWorkers, workerJobFromJsonRejectsMalformedJobs) {
+                    auto json = workerJobToJson(WorkerJob());
+                    json.erase("qmlImports");
+
+                    ASSERT_THROW(workerJobFromJson(json), std::exception);
+                }
+            }
+        }
+    }
+}